@@ -30,6 +30,8 @@
 // Framework libraries
 #include <compression/compression.h>
 #include <compression/compressor.h>
+#include <compression/scratchbuffer.h>
+#include <compression/sparse.h>
 #include <interface/fstdefines.h>
 #include <interface/openmphelper.h>
 
@@ -48,6 +50,7 @@
 #endif
 
 #define COL_META_SIZE 8
+#define COL_CONSTANT 0xffffffff  // column meta flag for a constant column, followed by a single element
 #define BLOCK_ALGO_MASK 0xffff000000000000
 #define BLOCK_POS_MASK 0x0000ffffffffffff
 #define MAX_COMPRESSBOUND_PLUS_META_SIZE 17044
@@ -232,6 +235,23 @@ void fdsStreamcompressed_v2(ofstream& myfile, char* colVec, unsigned long long n
   // nothing to write
   if (nrOfRows == 0) return;
 
+  // A constant column (such as an all-NA column) is stored as a single element
+  if (IsConstantBlock(colVec, nrOfRows * elementSize, elementSize))
+  {
+    unsigned int compress[2] = { 0, COL_CONSTANT };
+    myfile.write(reinterpret_cast<char*>(compress), COL_META_SIZE);
+    myfile.write(colVec, elementSize);
+
+    return;
+  }
+
+  // constant and sparse blocks are stored without the block compressor
+  StreamSparseCompressor sparseCompressor(streamCompressor, elementSize);
+  streamCompressor = &sparseCompressor;
+
+  // worst case size of a compressed block, aligned at 16 bytes
+  unsigned long long compBufSize = (streamCompressor->CompressBufferSize(static_cast<unsigned int>(blockSize)) + 15) & ~15ULL;
+
   unsigned long long curPos = myfile.tellp();
 
   // Blocks meta information
@@ -267,10 +287,11 @@ void fdsStreamcompressed_v2(ofstream& myfile, char* colVec, unsigned long long n
   // last block might be smaller than blockSize
 
   int nrOfThreads = max(1, min(GetFstThreads(), nrOfBlocks));
-  int batchSize = min(BATCH_SIZE_WRITE, nrOfBlocks / nrOfThreads); // keep thread buffer small
+  int maxBatchSize = max(1, min(BATCH_SIZE_WRITE, BATCH_SIZE_WRITE * MAX_SIZE_COMPRESS_BLOCK / blockSize)); // fewer large blocks per batch
+  int batchSize = min(maxBatchSize, nrOfBlocks / nrOfThreads); // keep thread buffer small
   batchSize = max(1, batchSize);
 
-  std::unique_ptr<char[]> threadBufferP(new char[nrOfThreads * MAX_COMPRESSBOUND * batchSize]);
+  std::unique_ptr<char[]> threadBufferP(new char[nrOfThreads * compBufSize * batchSize]);
   char* threadBuffer = threadBufferP.get();
 
   // TODO: possibly memset to zero to avoid valgrind warnings
@@ -298,7 +319,7 @@ void fdsStreamcompressed_v2(ofstream& myfile, char* colVec, unsigned long long n
         {
           int block = batch * batchSize + offset;
           CompAlgo compAlgo;
-          char* compBuf = &threadBuffer[threadNr * MAX_COMPRESSBOUND * batchSize + totSize];
+          char* compBuf = &threadBuffer[threadNr * compBufSize * batchSize + totSize];
           unsigned long long vecOffset = static_cast<unsigned long long>(block) * static_cast<unsigned long long>(blockSize);
           compSize[offset] = static_cast<unsigned int>(streamCompressor->Compress(&colVec[vecOffset], blockSize, compBuf, compAlgo, block));
           totSize += static_cast<unsigned long long>(compSize[offset]);
@@ -316,7 +337,7 @@ void fdsStreamcompressed_v2(ofstream& myfile, char* colVec, unsigned long long n
             blockIndexPos += compSize[offset]; // compressed block length
           }
 
-          char* compBuf = &threadBuffer[threadNr * MAX_COMPRESSBOUND * batchSize];
+          char* compBuf = &threadBuffer[threadNr * compBufSize * batchSize];
           if (localMax > maxCompressionSize) maxCompressionSize = localMax;
           myfile.write(compBuf, totSize);
         }
@@ -379,6 +400,54 @@ void fdsStreamcompressed_v2(ofstream& myfile, char* colVec, unsigned long long n
 }
 
 
+// Method for writing column data with a single codec family for all blocks.
+// Blocks of 4 and 8 byte elements are byte shuffled before compression.
+void fdsStreamCodec_v2(ofstream& myfile, char* colVec, unsigned long long nrOfRows, int elementSize, FstColumnCodec codec,
+  int compression, int blockSizeElems, std::string annotation, bool hasAnnotation)
+{
+  if (codec == FstColumnCodec::NONE || codec == FstColumnCodec::DEFAULT)
+  {
+    return fdsStreamUncompressed_v2(myfile, colVec, nrOfRows, elementSize, blockSizeElems, nullptr, annotation, hasAnnotation);
+  }
+
+  CompAlgo algo;
+  switch (elementSize)
+  {
+    case 4:
+      algo = codec == FstColumnCodec::LZ4 ? CompAlgo::LZ4_SHUF4 : CompAlgo::ZSTD_SHUF4;
+      break;
+
+    case 8:
+      algo = codec == FstColumnCodec::LZ4 ? CompAlgo::LZ4_SHUF8 : CompAlgo::ZSTD_SHUF8;
+      break;
+
+    default:
+      algo = codec == FstColumnCodec::LZ4 ? CompAlgo::LZ4 : CompAlgo::ZSTD;
+  }
+
+  SingleCompressor compressor(algo, compression);
+  StreamSingleCompressor streamCompressor(&compressor);
+  streamCompressor.CompressBufferSize(blockSizeElems * elementSize);
+
+  fdsStreamcompressed_v2(myfile, colVec, nrOfRows, elementSize, &streamCompressor, blockSizeElems, annotation, hasAnnotation);
+}
+
+
+// Method for writing column data with the candidate compressor that best meets the throughput targets.
+// The candidates are measured on the first blocks of the column.
+void fdsStreamAutotune_v2(ofstream& myfile, char* colVec, unsigned long long nrOfRows, int elementSize, Compressor** candidates,
+  int nrOfCandidates, const FstAutotune& autotune, int blockSizeElems, std::string annotation, bool hasAnnotation)
+{
+  int blockSize = blockSizeElems * elementSize;
+
+  StreamAutotuneCompressor streamCompressor(candidates, nrOfCandidates, autotune.writeSpeed, autotune.readSpeed);
+  streamCompressor.Calibrate(colVec, nrOfRows * elementSize, blockSize);
+  streamCompressor.CompressBufferSize(blockSize);
+
+  fdsStreamcompressed_v2(myfile, colVec, nrOfRows, elementSize, &streamCompressor, blockSizeElems, annotation, hasAnnotation);
+}
+
+
 // Read data compressed with a fixed ratio compressor from a stream
 // Note that repSize is assumed to be a multiple of elementSize
 inline void fdsReadFixedCompStream_v2(istream& myfile, char* outVec, unsigned long long blockPos,
@@ -503,7 +572,7 @@ inline void fdsReadFixedCompStream_v2(istream& myfile, char* outVec, unsigned lo
 
 #define UNCOMPRESSED_BLOCKSIZE 262144  // reading in small block is more efficient (probably more efficient L3 caching)
 
-void ProcessBatch(char* outVec, char* blockIndex, unsigned long long blockSize, Decompressor decompressor, unsigned long long outOffset, bool isAlligned,
+void ProcessBatch(char* outVec, char* blockIndex, unsigned long long blockSize, Decompressor decompressor, unsigned long long outOffset,
   unsigned long long blockStart, unsigned long long blockEnd, unsigned long long*& bStart, unsigned long long*& bEnd, char* threadBuf)
 {
   unsigned long long totSize = 0;
@@ -519,16 +588,10 @@ void ProcessBatch(char* outVec, char* blockIndex, unsigned long long blockSize,
     {
       memcpy(&outVec[outOffset + (blockCount - 1) * blockSize], &threadBuf[totSize], blockSize); // copy to misaligned pointer
     }
-    else if (isAlligned) // compressed and output vector alligned
+    else // decompress directly into the (possibly misaligned) output vector
     {
       decompressor.Decompress(threadAlgo, &outVec[outOffset + (blockCount - 1) * blockSize], blockSize, &threadBuf[totSize], curCompBlockSize);
     }
-    else // misaligned output vector, memcpy to avoid inefficient decompression
-    {
-      char allignBuf[MAX_SIZE_COMPRESS_BLOCK];
-      decompressor.Decompress(threadAlgo, allignBuf, blockSize, &threadBuf[totSize], curCompBlockSize);
-      memcpy(&outVec[outOffset + (blockCount - 1) * blockSize], allignBuf, blockSize); // copy to misaligned pointer
-    }
 
     totSize += curCompBlockSize;
   }
@@ -571,6 +634,15 @@ void fdsReadColumn_v2(istream& myfile, char* outVec, unsigned long long blockPos
   // Data is uncompressed or uses a fixed-ratio compressor (logical)
   if (compress[0] == 0)
   {
+    if (compress[1] == COL_CONSTANT) // single element
+    {
+      char value[8];
+      myfile.read(value, elementSize);
+      FillRepeat(outVec, static_cast<uint64_t>(length) * elementSize, value, elementSize);
+
+      return;
+    }
+
     if (compress[1] == 0) // uncompressed data
     {
       // Jump to startRow position
@@ -643,8 +715,8 @@ void fdsReadColumn_v2(istream& myfile, char* outVec, unsigned long long blockPos
   // Process single block and return
   if (startBlock == endBlock) // Read single block and subset result
   {
-    char compBuf[MAX_COMPRESSBOUND]; // maximum size needed in worst case scenario compression
-    char tmpBuf[MAX_SIZE_COMPRESS_BLOCK]; // temporary buffer
+    ScratchBuffer scratch(SCRATCH_STREAM_COMP, compSize); // compressed block
+    char* compBuf = scratch.Data();
 
     if (algo == 0) // no compression on this block
     {
@@ -664,15 +736,9 @@ void fdsReadColumn_v2(istream& myfile, char* outVec, unsigned long long blockPos
     myfile.seekg(blockPos + blockPosStart); // move to block data position, not always necessary!
     myfile.read(compBuf, compSize);
 
-    if (length == curSize)
-    {
-      decompressor.Decompress(algo, outVec, elementSize * length, compBuf, compSize); // direct decompress
-    }
-    else
-    {
-      decompressor.Decompress(algo, tmpBuf, elementSize * curSize, compBuf, compSize); // decompress in tmp buffer
-      memcpy(outVec, &tmpBuf[elementSize * startOffset], elementSize * length); // data range
-    }
+    // decompress data range only
+    decompressor.DecompressRange(algo, outVec, elementSize * curSize, compBuf, compSize, elementSize * startOffset,
+      elementSize * length);
 
     return;
   }
@@ -689,21 +755,15 @@ void fdsReadColumn_v2(istream& myfile, char* outVec, unsigned long long blockPos
   }
   else
   {
-    char compBuf[MAX_COMPRESSBOUND]; // maximum size needed in worst case scenario compression
-    char tmpBuf[MAX_SIZE_COMPRESS_BLOCK]; // temporary buffer
+    ScratchBuffer scratch(SCRATCH_STREAM_COMP, compSize); // compressed block
+    char* compBuf = scratch.Data();
 
     myfile.seekg(blockPos + blockPosStart); // move to block data position
     myfile.read(compBuf, compSize);
 
-    if (startOffset == 0) // full block
-    {
-      decompressor.Decompress(algo, outVec, blockSize, compBuf, compSize);
-    }
-    else
-    {
-      decompressor.Decompress(algo, tmpBuf, blockSize, compBuf, compSize);
-      memcpy(outVec, &tmpBuf[elementSize * startOffset], elementSize * subBlockSize);
-    }
+    // decompress tail of the block
+    decompressor.DecompressRange(algo, outVec, blockSize, compBuf, compSize, elementSize * startOffset,
+      elementSize * subBlockSize);
   }
 
   int remain = (startRow + length) % blockSizeElements; // remaining required items in last block
@@ -714,16 +774,20 @@ void fdsReadColumn_v2(istream& myfile, char* outVec, unsigned long long blockPos
 
   // Process middle blocks (if any)
 
-  bool isAlligned = (outOffset % 8) == 0; // test for 8 byte alligned output vector
-
   maxBlock--; // decrement to get number of full blocks
 
+  // fewer large blocks per batch
+  maxbatchSize = max(1, min(maxbatchSize, maxbatchSize * MAX_SIZE_COMPRESS_BLOCK / blockSize));
+
   const int nrOfThreads = max(1ULL, min(static_cast<unsigned long long>(GetFstThreads()), maxBlock));
   int batchSize = min(static_cast<unsigned long long>(maxbatchSize), maxBlock / nrOfThreads); // keep thread buffer small
   batchSize = max(1, batchSize);
 
+  // the header holds the largest compressed block size, files with default blocks never exceed MAX_COMPRESSBOUND
+  unsigned long long compBufSize = (max(static_cast<unsigned long long>(MAX_COMPRESSBOUND), static_cast<unsigned long long>(compress[0])) + 15) & ~15ULL;
+
   // TODO: localize threadBuffer in small area
-  std::unique_ptr<char[]> threadBufferP(new char[nrOfThreads * MAX_COMPRESSBOUND * batchSize]);
+  std::unique_ptr<char[]> threadBufferP(new char[nrOfThreads * compBufSize * batchSize]);
   char* threadBuffer = threadBufferP.get();
 
   long long nrOfBatches = (maxBlock + batchSize - 1) / batchSize; // number of batches (last one may be smaller)
@@ -733,7 +797,7 @@ void fdsReadColumn_v2(istream& myfile, char* outVec, unsigned long long blockPos
   // Parallel logic starts here
   //////////////////////////////////////////////////////////
 
-#pragma omp parallel num_threads(nrOfThreads) shared(isAlligned,nrOfBatches,batchSize,blockCount)
+#pragma omp parallel num_threads(nrOfThreads) shared(nrOfBatches,batchSize,blockCount)
   {
 #pragma omp for schedule(static, 1)
     for (long long blockJob = 0; blockJob < nrOfBatches; blockJob++) // a blockJob is a single unit of work
@@ -743,7 +807,7 @@ void fdsReadColumn_v2(istream& myfile, char* outVec, unsigned long long blockPos
       unsigned long long blockStart;
       unsigned long long blockEnd;
       unsigned long long *bStart, *bEnd;
-      char* threadBuf = &threadBuffer[threadNr * MAX_COMPRESSBOUND * batchSize]; // MAX_COMPRESSBOUND is adjusted to 16-byte allignment
+      char* threadBuf = &threadBuffer[threadNr * compBufSize * batchSize]; // compBufSize is adjusted to 16-byte allignment
       int curBatchSize = batchSize;
 
 #pragma omp critical
@@ -769,7 +833,7 @@ void fdsReadColumn_v2(istream& myfile, char* outVec, unsigned long long blockPos
 
       // Decompress all blocks into output vector
 
-      ProcessBatch(outVec, blockIndex, blockSize, decompressor, outOffset, isAlligned, blockStart, blockEnd, bStart, bEnd, threadBuf);
+      ProcessBatch(outVec, blockIndex, blockSize, decompressor, outOffset, blockStart, blockEnd, bStart, bEnd, threadBuf);
     }
   }
 
@@ -806,8 +870,8 @@ void fdsReadColumn_v2(istream& myfile, char* outVec, unsigned long long blockPos
   }
   else
   {
-    char compBuf[MAX_COMPRESSBOUND]; // maximum size needed in worst case scenario compression
-    char tmpBuf[MAX_SIZE_COMPRESS_BLOCK]; // temporary buffer
+    ScratchBuffer scratch(SCRATCH_STREAM_COMP, compSize); // compressed block
+    char* compBuf = scratch.Data();
 
     myfile.read(compBuf, compSize);
 
@@ -816,23 +880,9 @@ void fdsReadColumn_v2(istream& myfile, char* outVec, unsigned long long blockPos
       curSize = 1 + (size + blockSizeElements - 1) % blockSizeElements; // smaller last block size
     }
 
-    if (remain == curSize) // full last block
-    {
-      if ((outOffset % 8) == 0) // outVec pointer is 8-byte aligned
-      {
-        decompressor.Decompress(algo, &outVec[outOffset], curSize * elementSize, compBuf, compSize);
-      }
-      else
-      {
-        decompressor.Decompress(algo, tmpBuf, curSize * elementSize, compBuf, compSize);
-        memcpy(&outVec[outOffset], tmpBuf, curSize * elementSize);
-      }
-    }
-    else
-    {
-      decompressor.Decompress(algo, tmpBuf, curSize * elementSize, compBuf, compSize); // define tmpBuf locally for speed ?
-      memcpy(static_cast<char*>(&outVec[outOffset]), tmpBuf, elementSize * remain);
-    }
+    // decompress head of the block
+    decompressor.DecompressRange(algo, &outVec[outOffset], curSize * elementSize, compBuf, compSize, 0,
+      elementSize * remain);
   }
 }
 
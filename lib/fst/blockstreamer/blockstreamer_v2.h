@@ -27,6 +27,8 @@
 #include <fstream>
 
 #include <compression/compressor.h>
+#include <interface/fstautotune.h>
+#include <interface/fstwriteoptions.h>
 
 // Method for writing column data of any type to a ofstream.
 void fdsStreamUncompressed_v2(std::ofstream& myfile, char* vec, unsigned long long vecLength, int elementSize, int blockSizeElems,
@@ -38,6 +40,16 @@ void fdsStreamcompressed_v2(std::ofstream& myfile, char* colVec, unsigned long l
                             StreamCompressor* streamCompressor, int blockSizeElems, std::string annotation, bool hasAnnotation);
 
 
+// Method for writing column data with a single codec family for all blocks.
+void fdsStreamCodec_v2(std::ofstream& myfile, char* colVec, unsigned long long nrOfRows, int elementSize, FstColumnCodec codec,
+                       int compression, int blockSizeElems, std::string annotation, bool hasAnnotation);
+
+
+// Method for writing column data with the candidate compressor that best meets the throughput targets.
+void fdsStreamAutotune_v2(std::ofstream& myfile, char* colVec, unsigned long long nrOfRows, int elementSize, Compressor** candidates,
+                          int nrOfCandidates, const FstAutotune& autotune, int blockSizeElems, std::string annotation, bool hasAnnotation);
+
+
 void fdsReadColumn_v2(std::istream& myfile, char* outVec, unsigned long long blockPos, unsigned long long startRow, unsigned long long length,
                       unsigned long long size, int elementSize, std::string& annotation, int maxbatchSize, bool& hasAnnotation);
 
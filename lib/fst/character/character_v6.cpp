@@ -22,17 +22,25 @@
 */
 
 #include "character/character_v6.h"
+#include "character/chardict_v6.h"
 #include "interface/istringwriter.h"
 #include "interface/fstdefines.h"
+#include "interface/openmphelper.h"
 #include <compression/compressor.h>
+#include <compression/compression.h>
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
 #include <cstring>  // memset
+#include <exception>
+#include <vector>
 
 
 // #include <boost/unordered_map.hpp>
 
+#define BATCH_SIZE_WRITE_CHAR 4  // number of character blocks per thread in a single write batch
+
 using namespace std;
 
 
@@ -54,63 +62,469 @@ inline unsigned int StoreCharBlock_v6(ofstream& myfile, IStringWriter* blockRunn
 }
 
 
-inline unsigned int storeCharBlockCompressed_v6(ofstream& myfile, IStringWriter* blockRunner, unsigned int startCount,
-  unsigned int endCount, StreamCompressor* intCompressor, StreamCompressor* charCompressor, unsigned short int& algoInt,
-  unsigned short int& algoChar, int& intBufSize, int blockNr)
+// Staged character block. When writing, a copy of the string writer data is compressed by a worker thread while the
+// (single threaded) string writer fills the next blocks. When reading, a worker thread decompresses the block while
+// the calling thread materialises previous blocks.
+struct CharBlock_v6
 {
-  // Determine string lengths
-  unsigned int nrOfElements = endCount - startCount; // the string at position endCount is not included
-  unsigned int nrOfNAInts = 1 + nrOfElements / 32; // add 1 bit for NA present flag
+  std::vector<unsigned int> strSizes;  // cumulative string sizes followed by the NA bits
+  std::vector<char> strBuf;  // string data
+  std::vector<const char*> elements;  // string views of the host vector (writer only)
+  std::vector<char> compBuf;  // compressed string sizes, uncompressed NA bits and compressed string data
+  std::vector<unsigned int> frontSizes;  // string lengths followed by shared prefix lengths (front coded blocks)
+  std::vector<char> suffixBuf;  // string data without shared prefixes (front coded blocks)
+  unsigned int nrOfElements = 0;
+  unsigned int bufSize = 0;
+  unsigned int compSize = 0;
+  unsigned short int algoInt = 0;
+  unsigned short int algoChar = 0;
+  int intBufSize = 0;
+  unsigned long long startElem = 0;  // first element to materialise (reader only)
+  unsigned long long endElem = 0;  // last element to materialise (reader only)
+  unsigned long long vecOffset = 0;  // position of startElem in the result vector (reader only)
+};
+
+
+// Integer and character compressors of a single writer thread. Stream compressors keep the buffer size of the
+// active block and ZSTD dictionary compressors keep a context, so each thread uses its own set.
+class CharCompressors_v6
+{
+  Compressor* compressInt = nullptr;
+  Compressor* compressInt2 = nullptr;
+  Compressor* compressChar = nullptr;
+  Compressor* compressChar2 = nullptr;
+
+public:
+  StreamCompressor* streamCompressInt = nullptr;
+  StreamCompressor* streamCompressChar = nullptr;
+
+  CharCompressors_v6(FstColumnCodec codec, int compression, const char* dict, unsigned int dictSize)
+  {
+    if (codec == FstColumnCodec::LZ4)  // all blocks LZ4
+    {
+      compressInt = new SingleCompressor(LZ4_FOR_INT, compression);
+      streamCompressInt = new StreamSingleCompressor(compressInt);
+
+      compressChar = new SingleCompressor(LZ4, compression);
+      streamCompressChar = new StreamSingleCompressor(compressChar);
+    }
+    else if (codec == FstColumnCodec::ZSTD)  // all blocks ZSTD
+    {
+      compressInt = new SingleCompressor(ZSTD_FOR_INT, compression);
+      streamCompressInt = new StreamSingleCompressor(compressInt);
+
+      if (dictSize > 0)
+      {
+        compressChar = new ZstdDictCompressor(dict, dictSize, compression);
+      }
+      else
+      {
+        compressChar = new SingleCompressor(ZSTD, compression);
+      }
+
+      streamCompressChar = new StreamSingleCompressor(compressChar);
+    }
+    else if (compression <= 50)
+    {
+      // String lengths are bit-packed
+      compressInt = new SingleCompressor(FOR_INT, 0);
+      streamCompressInt = new StreamSingleCompressor(compressInt);
+
+      // Character vector compressor
+      compressChar = new SingleCompressor(LZ4, 20);
+      streamCompressChar = new StreamLinearCompressor(compressChar, 2 * compression); // unknown blockSize
+    }
+    else // 51 - 100
+    {
+      // String lengths are bit-packed
+      compressInt = new SingleCompressor(FOR_INT, 0);
+      compressInt2 = new SingleCompressor(ZSTD_FOR_INT, 0);
+      streamCompressInt = new StreamCompositeCompressor(compressInt, compressInt2, 2 * (compression - 50));
+
+      // Character vector compressor
+      compressChar = new SingleCompressor(LZ4, 20);
+      if (dictSize > 0)
+      {
+        compressChar2 = new ZstdDictCompressor(dict, dictSize, 20);
+      }
+      else
+      {
+        compressChar2 = new SingleCompressor(ZSTD, 20);
+      }
+
+      streamCompressChar = new StreamCompositeCompressor(compressChar, compressChar2, 2 * (compression - 50));
+    }
+  }
+
+  ~CharCompressors_v6()
+  {
+    delete streamCompressInt;
+    delete streamCompressChar;
+    delete compressInt;
+    delete compressInt2;
+    delete compressChar;
+    delete compressChar2;
+  }
+};
+
+
+// Set the first row of each block and the vector length in blockRows. When the string writer exposes element views,
+// blocks close when the next string would exceed CHAR_BLOCK_BYTE_BUDGET bytes or at CHAR_BLOCK_MAX_ELEMENTS
+// strings. Otherwise blocks hold BLOCKSIZE_CHAR strings and false is returned.
+inline bool CharBlockRows_v6(IStringWriter* stringWriter, std::vector<uint64_t>& blockRows)
+{
+  uint64_t vecLength = stringWriter->vecLength;
+  std::vector<const char*> elements(BLOCKSIZE_CHAR);
+  std::vector<unsigned int> sizes(BLOCKSIZE_CHAR + 1 + BLOCKSIZE_CHAR / 32);  // string sizes and NA bits
+
+  blockRows.assign(1, 0);
+  uint64_t blockStart = 0;
+  uint64_t blockBytes = 0;
+
+  for (uint64_t startCount = 0; startCount < vecLength; startCount += BLOCKSIZE_CHAR)
+  {
+    uint64_t endCount = std::min<uint64_t>(startCount + BLOCKSIZE_CHAR, vecLength);
+    unsigned int nrOfElements = static_cast<unsigned int>(endCount - startCount);
+
+    if (!stringWriter->SetElementViews(startCount, endCount, elements.data(), sizes.data(), &sizes[nrOfElements]))
+    {
+      blockRows.clear();
+      for (uint64_t row = 0; row < vecLength; row += BLOCKSIZE_CHAR) blockRows.push_back(row);
+      blockRows.push_back(vecLength);
+
+      return false;
+    }
+
+    for (unsigned int elem = 0; elem < nrOfElements; ++elem)
+    {
+      uint64_t row = startCount + elem;
+
+      // a block holds at least a single string
+      if (row != blockStart && (blockBytes + sizes[elem] > CHAR_BLOCK_BYTE_BUDGET ||
+        row - blockStart == CHAR_BLOCK_MAX_ELEMENTS))
+      {
+        blockRows.push_back(row);
+        blockStart = row;
+        blockBytes = 0;
+      }
+
+      blockBytes += sizes[elem];
+    }
+  }
+
+  blockRows.push_back(vecLength);
+
+  return true;
+}
+
+
+// Copy nrOfBlocks blocks starting at rows blockRows from the string writer. The string writer is not thread safe
+// and should only be called from the calling (host) thread.
+inline void FillCharBlocks_v6(IStringWriter* stringWriter, CharBlock_v6* charBlocks, const uint64_t* blockRows,
+  unsigned int nrOfBlocks)
+{
+  for (unsigned int blockNr = 0; blockNr < nrOfBlocks; ++blockNr)
+  {
+    CharBlock_v6& charBlock = charBlocks[blockNr];
+    uint64_t startCount = blockRows[blockNr];
+    uint64_t endCount = blockRows[blockNr + 1];
+
+    unsigned int nrOfElements = static_cast<unsigned int>(endCount - startCount);
+    unsigned int nrOfNAInts = 1 + nrOfElements / 32; // add 1 bit for NA present flag
+
+    charBlock.nrOfElements = nrOfElements;
+    charBlock.strSizes.resize(nrOfElements + nrOfNAInts);
+    charBlock.elements.resize(nrOfElements);
+
+    unsigned int* strSizes = charBlock.strSizes.data();
+
+    // copy strings directly from the host vector
+    if (stringWriter->SetElementViews(startCount, endCount, charBlock.elements.data(), strSizes, &strSizes[nrOfElements]))
+    {
+      unsigned int totSize = 0;
+      for (unsigned int elem = 0; elem < nrOfElements; ++elem)
+      {
+        totSize += strSizes[elem];
+        strSizes[elem] = totSize; // cumulative sizes
+      }
+
+      // buffers only grow, so data is not initialized before copying
+      if (charBlock.strBuf.size() <= totSize) charBlock.strBuf.resize(totSize + 1);  // never empty
+
+      char* strBuf = charBlock.strBuf.data();
+      unsigned int pos = 0;
+      for (unsigned int elem = 0; elem < nrOfElements; ++elem)
+      {
+        memcpy(&strBuf[pos], charBlock.elements[elem], strSizes[elem] - pos);
+        pos = strSizes[elem];
+      }
+
+      charBlock.bufSize = totSize;
+      continue;
+    }
+
+    stringWriter->SetBuffersFromVec(startCount, endCount);
+
+    memcpy(strSizes, stringWriter->strSizes, nrOfElements * 4);
+    memcpy(&strSizes[nrOfElements], stringWriter->naInts, nrOfNAInts * 4);
 
+    if (charBlock.strBuf.size() <= stringWriter->bufSize) charBlock.strBuf.resize(stringWriter->bufSize + 1);  // never empty
+    if (stringWriter->bufSize > 0) memcpy(charBlock.strBuf.data(), stringWriter->activeBuf, stringWriter->bufSize);
 
-  // Compress string size vector
+    charBlock.bufSize = stringWriter->bufSize;
+  }
+}
+
+
+// Set the lengths of the prefixes shared with the previous string and copy the remaining suffixes to the suffix
+// buffer. The first string of every CHAR_FRONT_RESTART strings is stored in full, so a string can be decoded from
+// the nearest restart point. Returns the total size of the suffixes.
+inline unsigned int FrontCodeCharBlock_v6(CharBlock_v6& charBlock)
+{
+  unsigned int nrOfElements = charBlock.nrOfElements;
+  const unsigned int* strSizes = charBlock.strSizes.data();  // cumulative sizes
+  const char* strBuf = charBlock.strBuf.data();
+
+  charBlock.frontSizes.resize(2 * nrOfElements);
+  if (charBlock.suffixBuf.size() <= charBlock.bufSize) charBlock.suffixBuf.resize(charBlock.bufSize + 1);  // never empty
+
+  unsigned int* prefixSizes = &charBlock.frontSizes[nrOfElements];
+  char* suffixBuf = charBlock.suffixBuf.data();
+  unsigned int suffixSize = 0;
+  unsigned int prevStart = 0;
+  unsigned int prevSize = 0;
+
+  for (unsigned int elem = 0; elem < nrOfElements; ++elem)
+  {
+    unsigned int strStart = elem == 0 ? 0 : strSizes[elem - 1];
+    unsigned int strSize = strSizes[elem] - strStart;
+    unsigned int prefix = 0;
+
+    if (elem % CHAR_FRONT_RESTART != 0)
+    {
+      unsigned int maxPrefix = std::min(strSize, prevSize);
+
+      // compare 8 bytes at a time
+      uint64_t prevWord, strWord;
+      while (prefix + 8 <= maxPrefix)
+      {
+        memcpy(&prevWord, &strBuf[prevStart + prefix], 8);
+        memcpy(&strWord, &strBuf[strStart + prefix], 8);
+        if (prevWord != strWord) break;
+        prefix += 8;
+      }
+
+      while (prefix < maxPrefix && strBuf[prevStart + prefix] == strBuf[strStart + prefix]) ++prefix;
+    }
+
+    prefixSizes[elem] = prefix;
+    memcpy(&suffixBuf[suffixSize], &strBuf[strStart + prefix], strSize - prefix);
+    suffixSize += strSize - prefix;
+
+    prevStart = strStart;
+    prevSize = strSize;
+  }
+
+  return suffixSize;
+}
+
+
+// Compress string sizes and string data of a block, NA bits are stored uncompressed. With front coding, blocks with
+// long shared prefixes store the prefix lengths after the string lengths and only compress the string suffixes.
+inline void CompressCharBlock_v6(CharBlock_v6& charBlock, CharCompressors_v6& compressors, int blockNr, bool frontCoding)
+{
+  unsigned int nrOfElements = charBlock.nrOfElements;
+  unsigned int nrOfNAInts = 1 + nrOfElements / 32; // add 1 bit for NA present flag
   unsigned int strSizesBufLength = nrOfElements * 4;
+  unsigned int* strSizes = charBlock.strSizes.data();
+  char* strBuf = charBlock.strBuf.data();
+  unsigned int strBufSize = charBlock.bufSize;
+
+  // NA bits are only stored for blocks with NA's
+  bool hasNA = (strSizes[nrOfElements + nrOfNAInts - 1] & (1u << (nrOfElements % 32))) != 0;
+  unsigned int naSize = hasNA ? nrOfNAInts * 4 : 0;
+
+  if (frontCoding)
+  {
+    unsigned int suffixSize = FrontCodeCharBlock_v6(charBlock);
+
+    // prefix lengths are only stored when they pay off
+    frontCoding = (charBlock.bufSize - suffixSize) * CHAR_FRONT_MIN_RATIO >= charBlock.bufSize &&
+      charBlock.bufSize > 0;
+
+    if (frontCoding)
+    {
+      strSizesBufLength *= 2;  // 1 string length and 1 prefix length per string
+      strBuf = charBlock.suffixBuf.data();
+      strBufSize = suffixSize;
+    }
+  }
+
+  int intBufCapacity = compressors.streamCompressInt->CompressBufferSize(strSizesBufLength);
+  int charBufCapacity = compressors.streamCompressChar->CompressBufferSize(strBufSize);
+
+  if (charBlock.compBuf.size() < static_cast<size_t>(intBufCapacity + naSize + charBufCapacity))
+  {
+    charBlock.compBuf.resize(intBufCapacity + naSize + charBufCapacity);
+  }
 
-  // 1) Use stack buffer here !!!!!!
-  // 2) compress to 1 or 2 bytes if possible with strSizesBufLength
-  int bufSize = intCompressor->CompressBufferSize(strSizesBufLength); // 1 integer per string
+  char* compBuf = charBlock.compBuf.data();
 
-  std::unique_ptr<char[]> intBufP(new char[bufSize]);
-  char* intBuf = intBufP.get();
+  // string lengths from cumulative sizes
+  for (unsigned int elem = nrOfElements - 1; elem > 0; --elem)
+  {
+    strSizes[elem] -= strSizes[elem - 1];
+  }
+
+  unsigned int* intBuf = strSizes;
+
+  if (frontCoding)
+  {
+    memcpy(charBlock.frontSizes.data(), strSizes, nrOfElements * 4);
+    intBuf = charBlock.frontSizes.data();
+  }
 
+  // Compress string lengths
   CompAlgo compAlgorithm;
-  intBufSize = intCompressor->Compress(reinterpret_cast<char*>(blockRunner->strSizes), strSizesBufLength, intBuf, compAlgorithm, blockNr);
-  myfile.write(intBuf, intBufSize);
+  charBlock.intBufSize = compressors.streamCompressInt->Compress(reinterpret_cast<char*>(intBuf),
+    strSizesBufLength, compBuf, compAlgorithm, blockNr);
+  charBlock.algoInt = static_cast<unsigned short int>(compAlgorithm); // store selected algorithm
 
-  //intCompressor->WriteBlock(myfile, (char*)(stringWriter->strSizes), intBuf);
-  algoInt = static_cast<unsigned short int>(compAlgorithm); // store selected algorithm
+  if (frontCoding) charBlock.algoInt |= CHAR_INDEX_FLAG_FRONT_CODED;
 
-  // Write NA bits uncompressed (add compression later ?)
-  myfile.write(reinterpret_cast<char*>(blockRunner->naInts), nrOfNAInts * 4); // write string lengths
+  // NA bits uncompressed
+  if (hasNA)
+  {
+    memcpy(&compBuf[charBlock.intBufSize], &strSizes[nrOfElements], naSize);
+    charBlock.algoInt |= CHAR_INDEX_FLAG_NA;
+  }
 
-  unsigned int totSize = blockRunner->bufSize;
+  // Compress string data
+  int resSize = compressors.streamCompressChar->Compress(strBuf, strBufSize,
+    &compBuf[charBlock.intBufSize + naSize], compAlgorithm, blockNr);
+  charBlock.algoChar = static_cast<unsigned short int>(compAlgorithm); // store selected algorithm
 
-  int compBufSize = charCompressor->CompressBufferSize(totSize);
+  charBlock.compSize = charBlock.intBufSize + naSize + resSize;
+}
+
+
+// Write compressed blocks in order and fill their block index entries
+inline void WriteCharBlocks_v6(ofstream& myfile, CharBlock_v6* charBlocks, unsigned int nrOfBlocks, char*& blockP,
+  unsigned long long& fullSize)
+{
+  for (unsigned int blockNr = 0; blockNr < nrOfBlocks; ++blockNr)
+  {
+    CharBlock_v6& charBlock = charBlocks[blockNr];
 
+    myfile.write(charBlock.compBuf.data(), charBlock.compSize);
+    fullSize += charBlock.compSize;
+
+    unsigned long long* blockPos = reinterpret_cast<unsigned long long*>(blockP);
+    unsigned short int* algoInt = reinterpret_cast<unsigned short int*>(blockP + 8);
+    unsigned short int* algoChar = reinterpret_cast<unsigned short int*>(blockP + 10);
+    int* intBufSize = reinterpret_cast<int*>(blockP + 12);
+
+    *blockPos = fullSize;
+    *algoInt = charBlock.algoInt;
+    *algoChar = charBlock.algoChar;
+    *intBufSize = charBlock.intBufSize;
+
+    blockP += CHAR_INDEX_SIZE; // advance one block index entry
+  }
+}
+
+
+// Train a ZSTD dictionary (blocks are only ZSTD compressed above compression level 50) on samples of complete strings
+// from evenly spread blocks, each at least CHAR_ZSTD_DICT_SAMPLE_SIZE bytes. Returns the dictionary size, or zero
+// when training failed or the dictionary doesn't pay for its own storage.
+unsigned int TrainCharDictionary_v6(IStringWriter* stringWriter, uint64_t nrOfBlocks, int compression, char* dict)
+{
+  uint64_t vecLength = stringWriter->vecLength;
+  uint64_t blockStep = 1 + nrOfBlocks / CHAR_ZSTD_DICT_SAMPLE_BLOCKS;
+
+  std::vector<char> samples;
+  std::vector<size_t> sampleSizes;
+  std::vector<unsigned int> blockSizes;
+
+  for (uint64_t block = 0; block <= nrOfBlocks; block += blockStep)
+  {
+    uint64_t endCount = std::min<uint64_t>((block + 1) * BLOCKSIZE_CHAR, vecLength);
+    unsigned int nrOfElements = static_cast<unsigned int>(endCount - block * BLOCKSIZE_CHAR);
+
+    stringWriter->SetBuffersFromVec(block * BLOCKSIZE_CHAR, endCount);
+    samples.insert(samples.end(), stringWriter->activeBuf, stringWriter->activeBuf + stringWriter->bufSize);
+    blockSizes.push_back(stringWriter->bufSize);
+
+    // split block at string boundaries, string sizes are cumulative
+    unsigned int sampleStart = 0;
+    for (unsigned int elem = 0; elem < nrOfElements; ++elem)
+    {
+      if (stringWriter->strSizes[elem] - sampleStart < CHAR_ZSTD_DICT_SAMPLE_SIZE) continue;
+
+      sampleSizes.push_back(stringWriter->strSizes[elem] - sampleStart);
+      sampleStart = stringWriter->strSizes[elem];
+    }
+
+    if (stringWriter->bufSize > sampleStart) sampleSizes.push_back(stringWriter->bufSize - sampleStart);
+  }
+
+  if (sampleSizes.size() < CHAR_ZSTD_DICT_SAMPLE_BLOCKS) return 0;  // too little data for a useful dictionary
+
+  // dictionary size scales with the estimated size of the column
+  unsigned long long columnSize = samples.size() * (nrOfBlocks + 1) / blockSizes.size();
+  unsigned int dictCapacity = static_cast<unsigned int>(std::min<unsigned long long>(CHAR_ZSTD_DICT_CAPACITY,
+    columnSize / CHAR_ZSTD_DICT_RATIO));
+
+  unsigned int dictSize = ZSTD_TrainDictionary(dict, dictCapacity, samples.data(), sampleSizes.data(),
+    static_cast<unsigned int>(sampleSizes.size()));
+
+  if (dictSize == 0) return 0;
+
+  // Compress the sampled blocks with and without the dictionary
+  SingleCompressor compressor(CompAlgo::ZSTD, 20);
+  ZstdDictCompressor dictCompressor(dict, dictSize, 20);
+
+  unsigned int maxBlockSize = *std::max_element(blockSizes.begin(), blockSizes.end());
+  unsigned int compBufSize = compressor.CompressBufferSize(maxBlockSize);
   std::unique_ptr<char[]> compBufP(new char[compBufSize]);
   char* compBuf = compBufP.get();
 
-  // Compress buffer
-  int resSize = charCompressor->Compress(blockRunner->activeBuf, totSize, compBuf, compAlgorithm, blockNr);
-  myfile.write(compBuf, resSize);
+  unsigned long long savedSize = 0;
+  const char* blockBuf = samples.data();
+  CompAlgo compAlgorithm;
 
-  algoChar = static_cast<unsigned short int>(compAlgorithm); // store selected algorithm
+  for (unsigned int blockSize : blockSizes)
+  {
+    unsigned long long compSize = compressor.Compress(compBuf, compBufSize, blockBuf, blockSize, compAlgorithm);
+    unsigned long long dictCompSize = dictCompressor.Compress(compBuf, compBufSize, blockBuf, blockSize, compAlgorithm);
 
-  return nrOfNAInts * 4 + resSize + intBufSize;
+    if (compSize > dictCompSize) savedSize += compSize - dictCompSize;
+    blockBuf += blockSize;
+  }
+
+  // extrapolate savings to the ZSTD compressed blocks of the complete column
+  unsigned long long nrOfZstdBlocks = (nrOfBlocks + 1) * (compression - 50) / 50;
+  if (savedSize * nrOfZstdBlocks / blockSizes.size() <= dictSize + CHAR_ZSTD_DICT_HEADER_SIZE) return 0;
+
+  return dictSize;
 }
 
 
-void fdsWriteCharVec_v6(ofstream& myfile, IStringWriter* stringWriter, int compression, StringEncoding stringEncoding)
+void fdsWriteCharVec_v6(ofstream& myfile, IStringWriter* stringWriter, int compression, FstColumnCodec codec,
+  StringEncoding stringEncoding, bool frontCoding)
 {
   uint64_t vecLength = stringWriter->vecLength; // expected to be larger than zero
 
   // nothing to write
   if (vecLength == 0) return;
 
+  // low cardinality vectors are stored as a level vector and integer codes
+  if (fdsWriteCharDictVec_v6(myfile, stringWriter, compression, codec, stringEncoding)) return;
+
   uint64_t curPos = myfile.tellp();
   uint64_t nrOfBlocks = (vecLength - 1) / BLOCKSIZE_CHAR; // number of blocks minus 1
 
-  if (compression == 0)
+  if (codec == FstColumnCodec::NONE || (codec == FstColumnCodec::DEFAULT && compression == 0))
   {
     uint32_t metaSize = CHAR_HEADER_SIZE + (nrOfBlocks + 1) * 8;
 
@@ -153,7 +567,30 @@ void fdsWriteCharVec_v6(ofstream& myfile, IStringWriter* stringWriter, int compr
 
   // Use compression
 
-  uint32_t metaSize = CHAR_HEADER_SIZE + (nrOfBlocks + 1) * CHAR_INDEX_SIZE; // 1 long and 2 unsigned int per block
+  // blocks close on a byte budget when possible
+  std::vector<uint64_t> blockRows;
+  bool byteBlocks = CharBlockRows_v6(stringWriter, blockRows);
+  uint64_t totNrOfBlocks = blockRows.size() - 1;
+  uint32_t rowIndexSize = byteBlocks ? static_cast<uint32_t>(totNrOfBlocks * 8) : 0;
+
+  // 1 long and 2 unsigned int per block, followed by the end row of each block for byte budgeted blocks
+  uint32_t metaSize = CHAR_HEADER_SIZE + totNrOfBlocks * CHAR_INDEX_SIZE + rowIndexSize;
+
+  // At higher compression settings, ZSTD blocks use a dictionary trained on a sample of the column
+  std::unique_ptr<char[]> dictP;
+  char* dict = nullptr;
+  unsigned int dictSize = 0;
+
+  bool useZstd = codec == FstColumnCodec::ZSTD || (codec == FstColumnCodec::DEFAULT && compression > 50);
+
+  if (useZstd && nrOfBlocks + 1 >= CHAR_ZSTD_DICT_MIN_BLOCKS)
+  {
+    dictP = std::unique_ptr<char[]>(new char[CHAR_ZSTD_DICT_CAPACITY]);
+    dict = dictP.get();
+
+    // with the ZSTD codec, all blocks are ZSTD compressed
+    dictSize = TrainCharDictionary_v6(stringWriter, nrOfBlocks, codec == FstColumnCodec::ZSTD ? 100 : compression, dict);
+  }
 
   std::unique_ptr<char[]> metaP(new char[metaSize]);
   char* meta = metaP.get();
@@ -165,7 +602,18 @@ void fdsWriteCharVec_v6(ofstream& myfile, IStringWriter* stringWriter, int compr
   uint32_t* isCompressed = reinterpret_cast<uint32_t*>(meta);
   uint32_t* blockSizeChar = reinterpret_cast<uint32_t*>(&meta[4]);
   *blockSizeChar = BLOCKSIZE_CHAR;
-  *isCompressed = (stringEncoding << 1) | 1; // set compression flag
+  *isCompressed = (stringEncoding << 1) | 1 | CHAR_FLAG_COMPACT_META; // set compression flag
+
+  if (dictSize > 0) *isCompressed |= CHAR_FLAG_ZSTD_DICT;
+
+  if (byteBlocks)
+  {
+    *blockSizeChar = static_cast<uint32_t>(totNrOfBlocks);
+    *isCompressed |= CHAR_FLAG_BYTE_BLOCKS;
+
+    uint64_t* rowEnds = reinterpret_cast<uint64_t*>(&meta[CHAR_HEADER_SIZE + totNrOfBlocks * CHAR_INDEX_SIZE]);
+    std::copy(blockRows.begin() + 1, blockRows.end(), rowEnds);
+  }
 
   myfile.write(meta, metaSize); // write block offset and algorithm index
 
@@ -173,75 +621,75 @@ void fdsWriteCharVec_v6(ofstream& myfile, IStringWriter* stringWriter, int compr
 
   unsigned long long fullSize = metaSize;
 
-  // Compressors
-  Compressor* compressInt;
-  Compressor* compressInt2 = nullptr;
-  StreamCompressor* streamCompressInt;
-  Compressor* compressChar;
-  Compressor* compressChar2 = nullptr;
-  StreamCompressor* streamCompressChar;
-
-  // Compression settings
-  if (compression <= 50)
+  // Trained dictionary is stored once, directly after the block index
+  if (dictSize > 0)
   {
-    // Integer vector compressor
-    compressInt = new SingleCompressor(LZ4_SHUF4, 0);
-    streamCompressInt = new StreamLinearCompressor(compressInt, 2 * compression);
-
-    // Character vector compressor
-    compressChar = new SingleCompressor(LZ4, 20);
-    streamCompressChar = new StreamLinearCompressor(compressChar, 2 * compression); // unknown blockSize
+    unsigned int dictHeader[2] = { dictSize, 0 };
+    myfile.write(reinterpret_cast<char*>(dictHeader), CHAR_ZSTD_DICT_HEADER_SIZE);
+    myfile.write(dict, dictSize);
+    fullSize += CHAR_ZSTD_DICT_HEADER_SIZE + dictSize;
   }
-  else // 51 - 100
-  {
-    // Integer vector compressor
-    compressInt = new SingleCompressor(LZ4_SHUF4, 0);
-    compressInt2 = new SingleCompressor(ZSTD_SHUF4, 0);
-    streamCompressInt = new StreamCompositeCompressor(compressInt, compressInt2, 2 * (compression - 50));
 
-    // Character vector compressor
-    compressChar = new SingleCompressor(LZ4, 20);
-    compressChar2 = new SingleCompressor(ZSTD, 20);
-    streamCompressChar = new StreamCompositeCompressor(compressChar, compressChar2, 2 * (compression - 50));
+  // Blocks are processed in batches. The calling thread fills a batch from the string writer between parallel
+  // regions: string writer callbacks can throw (or jump back to the host) and should not leave a parallel region.
+  // Within a region, the calling thread writes the previous batch while the other threads compress the current batch.
+  int nrOfThreads = static_cast<int>(std::min<uint64_t>(std::max(1, GetFstThreads()), totNrOfBlocks));
+  unsigned int batchSize = nrOfThreads * BATCH_SIZE_WRITE_CHAR;
+  long long nrOfBatches = static_cast<long long>((totNrOfBlocks + batchSize - 1) / batchSize);
+
+  // two batches of blocks are active: one is filled and compressed while the other is written
+  std::vector<CharBlock_v6> charBlocks(2 * batchSize);
+
+  std::vector<std::unique_ptr<CharCompressors_v6>> compressors(nrOfThreads);
+  for (int threadNr = 0; threadNr < nrOfThreads; ++threadNr)
+  {
+    compressors[threadNr] = std::unique_ptr<CharCompressors_v6>(new CharCompressors_v6(codec, compression, dict, dictSize));
   }
 
-  for (unsigned long long block = 0; block < nrOfBlocks; ++block)
+  for (long long batch = 0; batch < nrOfBatches; ++batch)
   {
-    unsigned long long* blockPos = reinterpret_cast<unsigned long long*>(blockP);
-    unsigned short int* algoInt = reinterpret_cast<unsigned short int*>(blockP + 8);
-    unsigned short int* algoChar = reinterpret_cast<unsigned short int*>(blockP + 10);
-    int* intBufSize = reinterpret_cast<int*>(blockP + 12);
+    CharBlock_v6* batchBlocks = &charBlocks[(batch % 2) * batchSize];
+    CharBlock_v6* prevBlocks = &charBlocks[((batch + 1) % 2) * batchSize];
 
-    stringWriter->SetBuffersFromVec(block * BLOCKSIZE_CHAR, (block + 1) * BLOCKSIZE_CHAR);
-    unsigned long long totSize = storeCharBlockCompressed_v6(myfile, stringWriter, block * BLOCKSIZE_CHAR,
-      (block + 1) * BLOCKSIZE_CHAR, streamCompressInt, streamCompressChar, *algoInt, *algoChar, *intBufSize, block);
+    uint64_t firstBlock = batch * batchSize;
+    long long batchLength = static_cast<long long>(std::min<uint64_t>(batchSize, totNrOfBlocks - firstBlock));
 
-    fullSize += totSize;
-    *blockPos = fullSize;
-    blockP += CHAR_INDEX_SIZE; // advance one block index entry
-  }
+    FillCharBlocks_v6(stringWriter, batchBlocks, &blockRows[firstBlock], static_cast<unsigned int>(batchLength));
+    std::exception_ptr blockError;  // first (allocation) error of the region, rethrown by the calling thread
 
-  unsigned long long* blockPos = reinterpret_cast<unsigned long long*>(blockP);
-  unsigned short int* algoInt = reinterpret_cast<unsigned short int*>(blockP + 8);
-  unsigned short int* algoChar = reinterpret_cast<unsigned short int*>(blockP + 10);
-  int* intBufSize = reinterpret_cast<int*>(blockP + 12);
+#pragma omp parallel num_threads(nrOfThreads)
+    {
+      // previous batch is always complete, the calling thread joins the compression after writing it
+#pragma omp master
+      {
+        if (batch > 0) WriteCharBlocks_v6(myfile, prevBlocks, batchSize, blockP, fullSize);
+      }
 
-  stringWriter->SetBuffersFromVec(nrOfBlocks * BLOCKSIZE_CHAR, vecLength);
-  unsigned long long totSize = storeCharBlockCompressed_v6(myfile, stringWriter, nrOfBlocks * BLOCKSIZE_CHAR,
-    vecLength, streamCompressInt, streamCompressChar, *algoInt, *algoChar, *intBufSize, nrOfBlocks);
+#pragma omp for schedule(dynamic, 1)
+      for (long long blockNr = 0; blockNr < batchLength; ++blockNr)
+      {
+        try
+        {
+          CompressCharBlock_v6(batchBlocks[blockNr], *compressors[CurrentFstThread()], static_cast<int>(firstBlock + blockNr),
+            frontCoding);
+        }
+        catch (...)
+        {
+#pragma omp critical
+          if (!blockError) blockError = std::current_exception();
+        }
+      }
+    }
 
-  fullSize += totSize;
-  *blockPos = fullSize;
+    if (blockError) std::rethrow_exception(blockError);
+  }
 
-  delete streamCompressInt;
-  delete streamCompressChar;
-  delete compressInt;
-  delete compressInt2;
-  delete compressChar;
-  delete compressChar2;
+  // Write last batch
+  WriteCharBlocks_v6(myfile, &charBlocks[((nrOfBatches - 1) % 2) * batchSize],
+    static_cast<unsigned int>(totNrOfBlocks - (nrOfBatches - 1) * batchSize), blockP, fullSize);
 
   myfile.seekp(curPos + CHAR_HEADER_SIZE);
-  myfile.write(static_cast<char*>(&meta[CHAR_HEADER_SIZE]), (nrOfBlocks + 1) * CHAR_INDEX_SIZE); // additional zero for index convenience
+  myfile.write(static_cast<char*>(&meta[CHAR_HEADER_SIZE]), totNrOfBlocks * CHAR_INDEX_SIZE); // additional zero for index convenience
   myfile.seekp(0, ios_base::end);
 }
 
@@ -268,58 +716,196 @@ inline void ReadDataBlock_v6(istream& myfile, IStringColumn* blockReader, unsign
 }
 
 
-inline void ReadDataBlockCompressed_v6(istream& myfile, IStringColumn* blockReader, unsigned long long blockSize, unsigned long long nrOfElements,
-  unsigned long long startElem, unsigned long long endElem, unsigned long long vecOffset,
-  unsigned int intBlockSize, Decompressor& decompressor, unsigned short int& algoInt, unsigned short int& algoChar)
+// Read the compressed data of a block. Blocks are stored consecutively, so reads are sequential.
+inline void ReadCharBlock_v6(istream& myfile, CharBlock_v6& charBlock, unsigned long long blockSize)
 {
-  unsigned long long nrOfNAInts = 1 + nrOfElements / 32; // NA metadata including overall NA bit
-  unsigned long long totElements = nrOfElements + nrOfNAInts;
+  if (charBlock.compBuf.size() < blockSize) charBlock.compBuf.resize(blockSize);
 
-  std::unique_ptr<unsigned int[]> sizeMetaP(new unsigned int[totElements]);
-  unsigned int* sizeMeta = sizeMetaP.get();
+  myfile.read(charBlock.compBuf.data(), blockSize);
+  charBlock.compSize = static_cast<unsigned int>(blockSize);
+}
+
+
+// Decode the front coded strings of a block from the suffix buffer. Only the strings from the restart point before
+// startElem up to endElem are decoded, other strings are not materialised.
+inline void FrontDecodeCharBlock_v6(CharBlock_v6& charBlock)
+{
+  unsigned int nrOfElements = charBlock.nrOfElements;
+  const unsigned int* strSizes = charBlock.strSizes.data();  // cumulative sizes
+  const unsigned int* prefixSizes = &charBlock.frontSizes[nrOfElements];
+  const char* suffixBuf = charBlock.suffixBuf.data();
+  char* strBuf = charBlock.strBuf.data();
+
+  unsigned int restart = static_cast<unsigned int>(charBlock.startElem - charBlock.startElem % CHAR_FRONT_RESTART);
+  unsigned int endElem = static_cast<unsigned int>(charBlock.endElem);
+
+  // suffix position of the restart string
+  unsigned int suffixPos = restart == 0 ? 0 : strSizes[restart - 1];
+  for (unsigned int elem = 0; elem < restart; ++elem)
+  {
+    suffixPos -= prefixSizes[elem];
+  }
+
+  unsigned int prevStart = 0;
+
+  for (unsigned int elem = restart; elem <= endElem; ++elem)
+  {
+    unsigned int strStart = elem == 0 ? 0 : strSizes[elem - 1];
+    unsigned int prefix = prefixSizes[elem];  // zero at restart points
+    unsigned int suffix = strSizes[elem] - strStart - prefix;
+
+    memcpy(&strBuf[strStart], &strBuf[prevStart], prefix);
+    memcpy(&strBuf[strStart + prefix], &suffixBuf[suffixPos], suffix);
+
+    suffixPos += suffix;
+    prevStart = strStart;
+  }
+}
+
+
+// Decompress string sizes and string data of a block, NA bits are stored uncompressed
+inline void DecompressCharBlock_v6(CharBlock_v6& charBlock, ZstdDictDecompressor* dictDecompressor, bool compactMeta)
+{
+  unsigned int nrOfElements = charBlock.nrOfElements;
+  unsigned int nrOfNAInts = 1 + nrOfElements / 32; // NA metadata including overall NA bit
+  unsigned int naSize = nrOfNAInts * 4;
+  unsigned short int algoInt = charBlock.algoInt;
+  const char* compBuf = charBlock.compBuf.data();
+  bool frontCoded = false;
+
+  charBlock.strSizes.resize(nrOfElements + nrOfNAInts);
+  unsigned int* sizeMeta = charBlock.strSizes.data();
+
+  // compact blocks store string lengths and only store NA bits when present
+  if (compactMeta)
+  {
+    if ((algoInt & CHAR_INDEX_FLAG_NA) == 0) naSize = 0;
+    frontCoded = (algoInt & CHAR_INDEX_FLAG_FRONT_CODED) != 0;
+    algoInt &= ~(CHAR_INDEX_FLAG_NA | CHAR_INDEX_FLAG_FRONT_CODED);
+  }
+
+  // front coded blocks store the prefix lengths after the string lengths
+  unsigned int* intBuf = sizeMeta;
+  unsigned int intBufLength = nrOfElements * 4;
+
+  if (frontCoded)
+  {
+    charBlock.frontSizes.resize(2 * nrOfElements);
+    intBuf = charBlock.frontSizes.data();
+    intBufLength *= 2;
+  }
 
-  // Read and uncompress str sizes data
   if (algoInt == 0) // uncompressed
   {
-    myfile.read(reinterpret_cast<char*>(sizeMeta), totElements * 4); // read cumulative string lengths
+    memcpy(intBuf, compBuf, intBufLength);
   }
   else
   {
-    unsigned int intBufSize = intBlockSize;
-
-    std::unique_ptr<char[]> strSizeBufP(new char[intBufSize]);
-    char* strSizeBuf = strSizeBufP.get();
+    Decompressor::Decompress(algoInt, reinterpret_cast<char*>(intBuf), intBufLength, compBuf,
+      charBlock.intBufSize);
+  }
 
-    myfile.read(strSizeBuf, intBufSize);
-    myfile.read(reinterpret_cast<char*>(&sizeMeta[nrOfElements]), nrOfNAInts * 4); // read cumulative string lengths
+  if (frontCoded) memcpy(sizeMeta, intBuf, nrOfElements * 4);
 
-    // Decompress size but not NA metadata (which is currently uncompressed)
+  // NA metadata is stored uncompressed
+  if (naSize == 0)
+  {
+    memset(&sizeMeta[nrOfElements], 0, nrOfNAInts * 4);
+  }
+  else
+  {
+    memcpy(&sizeMeta[nrOfElements], &compBuf[charBlock.intBufSize], naSize);
+  }
 
-    decompressor.Decompress(algoInt, reinterpret_cast<char*>(sizeMeta), nrOfElements * 4, strSizeBuf, intBlockSize);
+  if (compactMeta)
+  {
+    for (unsigned int elem = 1; elem < nrOfElements; ++elem)
+    {
+      sizeMeta[elem] += sizeMeta[elem - 1];  // cumulative sizes
+    }
   }
 
   unsigned int charDataSizeUncompressed = sizeMeta[nrOfElements - 1];
+  unsigned int charDataOffset = charBlock.intBufSize + naSize;
+  unsigned int charDataSize = charBlock.compSize - charDataOffset;
+  const char* charData = &compBuf[charDataOffset];
 
-  // Read and uncompress string vector data, use stack if possible here !!!!!
-  unsigned int charDataSize = blockSize - intBlockSize - nrOfNAInts * 4;
+  charBlock.strBuf.resize(charDataSizeUncompressed + 1);  // never empty
+  char* buf = charBlock.strBuf.data();
 
-  std::unique_ptr<char[]> bufP(new char[charDataSizeUncompressed]);
-  char* buf = bufP.get();
+  // string data of front coded blocks holds the suffixes only
+  if (frontCoded)
+  {
+    for (unsigned int elem = 0; elem < nrOfElements; ++elem)
+    {
+      charDataSizeUncompressed -= intBuf[nrOfElements + elem];
+    }
 
-  if (algoChar == 0)
+    if (charBlock.suffixBuf.size() <= charDataSizeUncompressed) charBlock.suffixBuf.resize(charDataSizeUncompressed + 1);
+    buf = charBlock.suffixBuf.data();
+  }
+
+  if (charBlock.algoChar == 0)
+  {
+    memcpy(buf, charData, charDataSize);
+  }
+  else if (dictDecompressor != nullptr && charBlock.algoChar == static_cast<unsigned short int>(CompAlgo::ZSTD))
   {
-    myfile.read(buf, charDataSize); // read string lengths
+    // ZSTD blocks of a column with a trained dictionary
+    dictDecompressor->Decompress(buf, charDataSizeUncompressed, charData, charDataSize);
   }
   else
   {
-    std::unique_ptr<char[]> bufCompressedP(new char[charDataSize]);
-    char* bufCompressed = bufCompressedP.get();
+    Decompressor::Decompress(charBlock.algoChar, buf, charDataSizeUncompressed, charData, charDataSize);
+  }
+
+  if (frontCoded) FrontDecodeCharBlock_v6(charBlock);
+}
+
+
+// Read blocks [firstBlock, firstBlock + nrOfBlocks) of the selection and set the range of elements to materialise.
+// Array blockRows holds the first row of each selected block and the end row of the last one. The stream should be
+// positioned at the start of firstBlock.
+inline void ReadCharBlocks_v6(istream& myfile, CharBlock_v6* charBlocks, unsigned long long firstBlock, unsigned int nrOfBlocks,
+  const char* blockInfo, const unsigned long long* blockRows, unsigned long long startRow, unsigned long long lastRow)
+{
+  for (unsigned int blockNr = 0; blockNr < nrOfBlocks; ++blockNr)
+  {
+    CharBlock_v6& charBlock = charBlocks[blockNr];
+    unsigned long long block = firstBlock + blockNr;  // block in selection
+
+    // index entry of the previous block holds the start position of this block
+    const char* blockP = &blockInfo[(block + 1) * CHAR_INDEX_SIZE];
+    unsigned long long offset = *reinterpret_cast<const unsigned long long*>(blockP - CHAR_INDEX_SIZE);
+    unsigned long long curBlockPos = *reinterpret_cast<const unsigned long long*>(blockP);
+
+    charBlock.algoInt = *reinterpret_cast<const unsigned short int*>(blockP + 8);
+    charBlock.algoChar = *reinterpret_cast<const unsigned short int*>(blockP + 10);
+    charBlock.intBufSize = *reinterpret_cast<const int*>(blockP + 12);
 
-    myfile.read(bufCompressed, charDataSize); // read string lengths
-    decompressor.Decompress(algoChar, buf, charDataSizeUncompressed, bufCompressed, charDataSize);
+    unsigned long long blockStart = blockRows[block];
+    unsigned long long blockEnd = blockRows[block + 1];
+
+    charBlock.nrOfElements = static_cast<unsigned int>(blockEnd - blockStart);
+    charBlock.startElem = std::max(startRow, blockStart) - blockStart;
+    charBlock.endElem = std::min(lastRow, blockEnd - 1) - blockStart;
+    charBlock.vecOffset = blockStart + charBlock.startElem - startRow;
+
+    ReadCharBlock_v6(myfile, charBlock, curBlockPos - offset);
   }
+}
 
-  blockReader->BufferToVec(nrOfElements, startElem, endElem, vecOffset, sizeMeta, buf);
+
+// Copy decompressed blocks to the result vector in block order
+inline void MaterialiseCharBlocks_v6(IStringColumn* blockReader, CharBlock_v6* charBlocks, unsigned int nrOfBlocks)
+{
+  for (unsigned int blockNr = 0; blockNr < nrOfBlocks; ++blockNr)
+  {
+    CharBlock_v6& charBlock = charBlocks[blockNr];
+
+    blockReader->BufferToVec(charBlock.nrOfElements, charBlock.startElem, charBlock.endElem, charBlock.vecOffset,
+      charBlock.strSizes.data(), charBlock.strBuf.data());
+  }
 }
 
 
@@ -351,6 +937,11 @@ void fdsReadCharVec_v6(istream& myfile, IStringColumn* blockReader, unsigned lon
   // blockReader->AllocateVec(vecLength);
   blockReader->SetEncoding(stringEncoding);
 
+  if ((meta[0] & CHAR_FLAG_DICTIONARY) != 0)
+  {
+    return fdsReadCharDictVec_v6(myfile, blockReader, blockPos, startRow, vecLength, size);
+  }
+
   // Vector data is uncompressed
   if (compression == 0)
   {
@@ -423,6 +1014,35 @@ void fdsReadCharVec_v6(istream& myfile, IStringColumn* blockReader, unsigned lon
 
   // Vector data is compressed
 
+  std::vector<unsigned long long> blockRows;  // first row of each selected block and end row of the last one
+  unsigned long long rowIndexSize = 0;
+
+  // Byte budgeted blocks have a variable number of elements, the header holds the number of blocks
+  if ((meta[0] & CHAR_FLAG_BYTE_BLOCKS) != 0)
+  {
+    totNrOfBlocks = meta[1] - 1;
+    rowIndexSize = meta[1] * 8ULL;
+
+    // end row of each block
+    std::vector<unsigned long long> rowEnds(meta[1]);
+    myfile.seekg(blockPos + CHAR_HEADER_SIZE + meta[1] * static_cast<unsigned long long>(CHAR_INDEX_SIZE));
+    myfile.read(reinterpret_cast<char*>(rowEnds.data()), rowIndexSize);
+
+    startBlock = std::upper_bound(rowEnds.begin(), rowEnds.end(), startRow) - rowEnds.begin();
+    endBlock = std::upper_bound(rowEnds.begin(), rowEnds.end(), startRow + vecLength - 1) - rowEnds.begin();
+    nrOfBlocks = 1 + endBlock - startBlock;
+
+    blockRows.push_back(startBlock == 0 ? 0 : rowEnds[startBlock - 1]);
+    blockRows.insert(blockRows.end(), rowEnds.begin() + startBlock, rowEnds.begin() + endBlock + 1);
+  }
+  else
+  {
+    for (unsigned long long block = startBlock; block <= endBlock + 1; ++block)
+    {
+      blockRows.push_back(std::min(block * blockSizeChar, size));
+    }
+  }
+
   unsigned int bufLength = (nrOfBlocks + 1) * CHAR_INDEX_SIZE; // 1 long and 2 unsigned int per block
 
   // add extra first element for convenience
@@ -437,81 +1057,109 @@ void fdsReadCharVec_v6(istream& myfile, IStringColumn* blockReader, unsigned lon
   else
   {
     unsigned long long* firstBlock = reinterpret_cast<unsigned long long*>(blockInfo);
-    *firstBlock = CHAR_HEADER_SIZE + (totNrOfBlocks + 1) * CHAR_INDEX_SIZE; // offset of first data block
+    *firstBlock = CHAR_HEADER_SIZE + (totNrOfBlocks + 1) * CHAR_INDEX_SIZE + rowIndexSize; // offset of first data block
+    myfile.seekg(blockPos + CHAR_HEADER_SIZE);
     myfile.read(&blockInfo[CHAR_INDEX_SIZE], nrOfBlocks * CHAR_INDEX_SIZE);
   }
 
-  // Get block meta data
-  unsigned long long* offset = reinterpret_cast<unsigned long long*>(blockInfo);
-  char* blockP = &blockInfo[CHAR_INDEX_SIZE];
-  unsigned long long* curBlockPos = reinterpret_cast<unsigned long long*>(blockP);
-  unsigned short int* algoInt = reinterpret_cast<unsigned short int*>(blockP + 8);
-  unsigned short int* algoChar = reinterpret_cast<unsigned short int*>(blockP + 10);
-  int* intBufSize = reinterpret_cast<int*>(blockP + 12);
-
-  // move to first data block
+  // Read trained dictionary stored after the block index
+  std::unique_ptr<char[]> dictBufP;
+  unsigned int dictBufSize = 0;
 
-  myfile.seekg(blockPos + *offset);
+  if ((meta[0] & CHAR_FLAG_ZSTD_DICT) != 0)
+  {
+    unsigned long long dictPos = CHAR_HEADER_SIZE + (totNrOfBlocks + 1) * CHAR_INDEX_SIZE + rowIndexSize;
+    unsigned int dictHeader[2];
 
-  unsigned long long endElem = blockSizeChar - 1;
-  unsigned long long nrOfElements = blockSizeChar;
+    myfile.seekg(blockPos + dictPos);
+    myfile.read(reinterpret_cast<char*>(dictHeader), CHAR_ZSTD_DICT_HEADER_SIZE);
 
-  Decompressor decompressor; // uncompresses all available algorithms
+    dictBufSize = dictHeader[0];
+    dictBufP = std::unique_ptr<char[]>(new char[dictBufSize]);
+    myfile.read(dictBufP.get(), dictBufSize);
 
-  if (startBlock == endBlock) // subset start and end of block
-  {
-    endElem = endOffset;
-    if (endBlock == totNrOfBlocks)
+    if (startBlock == 0)
     {
-      nrOfElements = size - totNrOfBlocks * blockSizeChar; // last block can have less elements
+      unsigned long long* firstBlock = reinterpret_cast<unsigned long long*>(blockInfo);
+      *firstBlock = dictPos + CHAR_ZSTD_DICT_HEADER_SIZE + dictHeader[0];
     }
   }
 
-  // Read first block with offset
-  unsigned long long blockSize = *curBlockPos - *offset; // size of data block
-
-  ReadDataBlockCompressed_v6(myfile, blockReader, blockSize, nrOfElements, startOffset, endElem, 0, *intBufSize,
-    decompressor, *algoInt, *algoChar);
-
-
-  if (startBlock == endBlock) // subset start and end of block
+  // Blocks are processed in batches. Within a parallel region, the calling thread reads the compressed data of the
+  // next batch while the other threads decompress the current batch. The calling thread materialises the batch in
+  // block order between regions: host string constructors are not thread safe and can throw (or jump back to the
+  // host), which should not leave a parallel region.
+  int nrOfThreads = static_cast<int>(std::min<unsigned long long>(std::max(1, GetFstThreads()), nrOfBlocks));
+  unsigned int batchSize = nrOfThreads * BATCH_SIZE_READ_CHAR;
+  bool compactMeta = (meta[0] & CHAR_FLAG_COMPACT_META) != 0;
+  long long nrOfBatches = static_cast<long long>((nrOfBlocks + batchSize - 1) / batchSize);
+
+  // two batches of blocks are active: one is decompressed and materialised while the other is read
+  std::vector<CharBlock_v6> charBlocks(2 * batchSize);
+
+  // ZSTD dictionary decompressors hold a context, so each thread uses its own
+  std::vector<std::unique_ptr<ZstdDictDecompressor>> dictDecompressors(nrOfThreads);
+  for (int threadNr = 0; dictBufSize > 0 && threadNr < nrOfThreads; ++threadNr)
   {
-    return;
+    dictDecompressors[threadNr] = std::unique_ptr<ZstdDictDecompressor>(
+      new ZstdDictDecompressor(dictBufP.get(), dictBufSize));
   }
 
-  // more than 1 block
+  unsigned long long* blockOffset = reinterpret_cast<unsigned long long*>(blockInfo);
 
-  offset = curBlockPos;
+  // move to first data block
+  myfile.seekg(blockPos + *blockOffset);
 
-  unsigned long long vecPos = blockSizeChar - startOffset;
+  ReadCharBlocks_v6(myfile, charBlocks.data(), 0, static_cast<unsigned int>(std::min<unsigned long long>(batchSize, nrOfBlocks)),
+    blockInfo, blockRows.data(), startRow, startRow + vecLength - 1);
 
-  if (endBlock == totNrOfBlocks)
+  for (long long batch = 0; batch < nrOfBatches; ++batch)
   {
-    nrOfElements = size - totNrOfBlocks * blockSizeChar; // last block can have less elements
-  }
+    CharBlock_v6* batchBlocks = &charBlocks[(batch % 2) * batchSize];
+    CharBlock_v6* nextBlocks = &charBlocks[((batch + 1) % 2) * batchSize];
 
-  --nrOfBlocks; // iterate all but last block
-  blockP += CHAR_INDEX_SIZE; // move to next index element
-  for (unsigned int block = 1; block < nrOfBlocks; ++block)
-  {
-    curBlockPos = reinterpret_cast<unsigned long long*>(blockP);
-    algoInt = reinterpret_cast<unsigned short int*>(blockP + 8);
-    algoChar = reinterpret_cast<unsigned short int*>(blockP + 10);
-    intBufSize = reinterpret_cast<int*>(blockP + 12);
+    long long batchLength = static_cast<long long>(std::min<unsigned long long>(batchSize, nrOfBlocks - batch * batchSize));
+    std::exception_ptr blockError;  // first (allocation) error of the region, rethrown by the calling thread
 
-    ReadDataBlockCompressed_v6(myfile, blockReader, *curBlockPos - *offset, blockSizeChar, 0, blockSizeChar - 1, vecPos, *intBufSize,
-      decompressor, *algoInt, *algoChar);
+#pragma omp parallel num_threads(nrOfThreads)
+    {
+#pragma omp master
+      {
+        if (batch + 1 < nrOfBatches)
+        {
+          unsigned long long firstBlock = (batch + 1) * batchSize;
+
+          try
+          {
+            ReadCharBlocks_v6(myfile, nextBlocks, firstBlock,
+              static_cast<unsigned int>(std::min<unsigned long long>(batchSize, nrOfBlocks - firstBlock)),
+              blockInfo, blockRows.data(), startRow, startRow + vecLength - 1);
+          }
+          catch (...)
+          {
+#pragma omp critical
+            if (!blockError) blockError = std::current_exception();
+          }
+        }
+      }
 
-    vecPos += blockSizeChar;
-    offset = curBlockPos;
-    blockP += CHAR_INDEX_SIZE; // move to next index element
-  }
+#pragma omp for schedule(dynamic, 1)
+      for (long long blockNr = 0; blockNr < batchLength; ++blockNr)
+      {
+        try
+        {
+          DecompressCharBlock_v6(batchBlocks[blockNr], dictDecompressors[CurrentFstThread()].get(), compactMeta);
+        }
+        catch (...)
+        {
+#pragma omp critical
+          if (!blockError) blockError = std::current_exception();
+        }
+      }
+    }
 
-  curBlockPos = reinterpret_cast<unsigned long long*>(blockP);
-  algoInt = reinterpret_cast<unsigned short int*>(blockP + 8);
-  algoChar = reinterpret_cast<unsigned short int*>(blockP + 10);
-  intBufSize = reinterpret_cast<int*>(blockP + 12);
+    if (blockError) std::rethrow_exception(blockError);
 
-  ReadDataBlockCompressed_v6(myfile, blockReader, *curBlockPos - *offset, nrOfElements, 0, endOffset, vecPos, *intBufSize,
-    decompressor, *algoInt, *algoChar);
+    MaterialiseCharBlocks_v6(blockReader, batchBlocks, static_cast<unsigned int>(batchLength));
+  }
 }
@@ -30,9 +30,14 @@
 
 #include "interface/istringwriter.h"
 #include "interface/ifstcolumn.h"
+#include "interface/fstwriteoptions.h"
 
 
-void fdsWriteCharVec_v6(std::ofstream &myfile, IStringWriter* blockRunner, int compression, StringEncoding stringEncoding);
+// Write a character vector. With frontCoding, blocks in which strings share long prefixes with their predecessor
+// store only the prefix lengths and suffixes (flag CHAR_INDEX_FLAG_FRONT_CODED in the block index), use for sorted
+// (key) columns.
+void fdsWriteCharVec_v6(std::ofstream &myfile, IStringWriter* blockRunner, int compression, FstColumnCodec codec,
+  StringEncoding stringEncoding, bool frontCoding = false);
 
 
 void fdsReadCharVec_v6(std::istream &myfile, IStringColumn* blockReader, unsigned long long blockPos, unsigned long long startRow,
@@ -0,0 +1,451 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <stdexcept>
+
+#include "character/chardict_v6.h"
+#include "character/character_v6.h"
+#include "interface/fstdefines.h"
+#include <blockstreamer/blockstreamer_v2.h>
+#include <compression/compressor.h>
+
+#include "xxhash.h"
+
+
+using namespace std;
+
+
+// Distinct strings of a character vector, stored in a single buffer and indexed with an open addressing hash table
+class CharDictionary
+{
+  std::vector<char> levelData;
+  std::vector<unsigned long long> levelEnds;  // cumulative level sizes
+  std::vector<unsigned long long> levelHashes;
+  std::vector<unsigned int> table;  // 1-based level code or zero for an empty slot
+  unsigned long long mask;
+
+  void Grow()
+  {
+    table.assign(2 * table.size(), 0);
+    mask = table.size() - 1;
+
+    for (unsigned int level = 0; level < levelHashes.size(); ++level)
+    {
+      unsigned long long slot = levelHashes[level] & mask;
+      while (table[slot] != 0) slot = (slot + 1) & mask;
+      table[slot] = level + 1;
+    }
+  }
+
+public:
+  CharDictionary() : table(1024, 0), mask(1023) { }
+
+  unsigned int NrOfLevels() const { return static_cast<unsigned int>(levelEnds.size()); }
+
+  char* LevelData() { return levelData.data(); }
+
+  const unsigned long long* LevelEnds() const { return levelEnds.data(); }
+
+  // Returns the 1-based code of the string, the string is added to the dictionary if required
+  int Code(const char* str, unsigned int strLength)
+  {
+    unsigned long long hash = XXH64(str, strLength, FST_HASH_SEED);
+    unsigned long long slot = hash & mask;
+
+    for (unsigned int code = table[slot]; code != 0; code = table[slot])
+    {
+      if (levelHashes[code - 1] == hash)
+      {
+        unsigned long long start = code == 1 ? 0 : levelEnds[code - 2];
+
+        if (levelEnds[code - 1] - start == strLength && memcmp(&levelData[start], str, strLength) == 0)
+        {
+          return static_cast<int>(code);
+        }
+      }
+
+      slot = (slot + 1) & mask;
+    }
+
+    // new level
+    levelData.insert(levelData.end(), str, str + strLength);
+    levelEnds.push_back(levelData.size());
+    levelHashes.push_back(hash);
+    table[slot] = NrOfLevels();
+
+    if (2 * levelEnds.size() > table.size()) Grow();  // load factor of at most 0.5
+
+    return static_cast<int>(NrOfLevels());
+  }
+};
+
+
+// Provides the levels of a dictionary to the character column writer
+class DictionaryLevelWriter : public IStringWriter
+{
+  CharDictionary* dict;
+  StringEncoding stringEncoding;
+
+  unsigned int naIntsBuf[1 + BLOCKSIZE_CHAR / 32];
+  unsigned int strSizesBuf[BLOCKSIZE_CHAR];
+
+public:
+  DictionaryLevelWriter(CharDictionary* dict, StringEncoding stringEncoding)
+  {
+    this->dict = dict;
+    this->stringEncoding = stringEncoding;
+    this->naInts = naIntsBuf;
+    this->strSizes = strSizesBuf;
+    this->vecLength = dict->NrOfLevels();
+  }
+
+  StringEncoding Encoding() { return stringEncoding; }
+
+  void SetBuffersFromVec(uint64_t startCount, uint64_t endCount)
+  {
+    const unsigned long long* levelEnds = dict->LevelEnds();
+    unsigned long long offset = startCount == 0 ? 0 : levelEnds[startCount - 1];
+    unsigned int nrOfElements = static_cast<unsigned int>(endCount - startCount);
+
+    memset(naInts, 0, (1 + nrOfElements / 32) * 4);  // levels are never NA
+
+    for (unsigned int elem = 0; elem < nrOfElements; ++elem)
+    {
+      strSizes[elem] = static_cast<unsigned int>(levelEnds[startCount + elem] - offset);
+    }
+
+    activeBuf = dict->LevelData() + offset;
+    bufSize = strSizes[nrOfElements - 1];
+  }
+};
+
+
+// Collects the levels of a dictionary encoded column into a single buffer
+class DictionaryLevelReader : public IStringColumn
+{
+  std::vector<char> levelData;  // zero terminated levels
+  std::vector<unsigned long long> levelStarts;
+  std::vector<unsigned int> levelSizes;
+  StringEncoding stringEncoding = StringEncoding::NATIVE;
+
+public:
+
+  void AllocateVec(uint64_t vecLength)
+  {
+    levelStarts.reserve(vecLength);
+    levelSizes.reserve(vecLength);
+  }
+
+  void SetEncoding(StringEncoding stringEncoding) { this->stringEncoding = stringEncoding; }
+
+  StringEncoding GetEncoding() { return stringEncoding; }
+
+  // The level vector is read as a whole, so blocks arrive in order
+  void BufferToVec(uint64_t nrOfElements, uint64_t startElem, uint64_t endElem, uint64_t vecOffset, unsigned int* sizeMeta, char* buf)
+  {
+    unsigned int pos = startElem == 0 ? 0 : sizeMeta[startElem - 1];
+
+    for (uint64_t blockElem = startElem; blockElem <= endElem; ++blockElem)
+    {
+      unsigned int newPos = sizeMeta[blockElem];
+
+      levelStarts.push_back(levelData.size());
+      levelSizes.push_back(newPos - pos);
+      levelData.insert(levelData.end(), buf + pos, buf + newPos);
+      levelData.push_back(0);
+
+      pos = newPos;
+    }
+  }
+
+  const char* GetElement(uint64_t elementNr) { return &levelData[levelStarts[elementNr]]; }
+
+  unsigned int LevelSize(uint64_t elementNr) const { return levelSizes[elementNr]; }
+
+  uint64_t NrOfLevels() const { return levelStarts.size(); }
+};
+
+
+// Add the strings of a block to the dictionary, returns false when the number of levels exceeds maxLevels
+inline bool EncodeCharBlock(IStringWriter* stringWriter, CharDictionary& dict, int* codes, unsigned long long startCount,
+  unsigned long long endCount, unsigned long long maxLevels)
+{
+  stringWriter->SetBuffersFromVec(startCount, endCount);
+
+  unsigned int nrOfElements = static_cast<unsigned int>(endCount - startCount);
+  unsigned int nrOfNAInts = 1 + nrOfElements / 32;
+  const unsigned int* naInts = stringWriter->naInts;
+  const unsigned int* strSizes = stringWriter->strSizes;
+  const char* buf = stringWriter->activeBuf;
+
+  bool hasNA = (naInts[nrOfNAInts - 1] & (1u << (nrOfElements % 32))) != 0;
+  unsigned int pos = 0;
+
+  for (unsigned int elem = 0; elem < nrOfElements; ++elem)
+  {
+    unsigned int newPos = strSizes[elem];
+
+    if (hasNA && (naInts[elem / 32] & (1u << (elem % 32))) != 0)
+    {
+      codes[elem] = static_cast<int>(FST_NA_INT);
+    }
+    else
+    {
+      codes[elem] = dict.Code(&buf[pos], newPos - pos);
+      if (dict.NrOfLevels() > maxLevels) return false;
+    }
+
+    pos = newPos;
+  }
+
+  return true;
+}
+
+
+bool fdsWriteCharDictVec_v6(ofstream& myfile, IStringWriter* stringWriter, int compression, FstColumnCodec codec,
+  StringEncoding stringEncoding)
+{
+  unsigned long long vecLength = stringWriter->vecLength;
+
+  // small vectors and uncompressed columns are not dictionary encoded
+  if (compression == 0 || vecLength <= BLOCKSIZE_CHAR) return false;
+
+  // estimate the cardinality from the first block
+  CharDictionary dict;
+  int sampleCodes[BLOCKSIZE_CHAR];
+
+  if (!EncodeCharBlock(stringWriter, dict, sampleCodes, 0, BLOCKSIZE_CHAR, BLOCKSIZE_CHAR / CHAR_DICT_MAX_RATIO))
+  {
+    return false;
+  }
+
+  std::unique_ptr<int[]> codesP(new int[vecLength]);
+  int* codes = codesP.get();
+  memcpy(codes, sampleCodes, BLOCKSIZE_CHAR * 4);
+
+  unsigned long long maxLevels = vecLength / CHAR_DICT_MAX_RATIO;
+
+  for (unsigned long long startCount = BLOCKSIZE_CHAR; startCount < vecLength; startCount += BLOCKSIZE_CHAR)
+  {
+    unsigned long long endCount = std::min(startCount + BLOCKSIZE_CHAR, vecLength);
+
+    if (!EncodeCharBlock(stringWriter, dict, &codes[startCount], startCount, endCount, maxLevels))
+    {
+      return false;
+    }
+  }
+
+  // Set column header
+
+  unsigned long long curPos = myfile.tellp();
+
+  unsigned int meta[2];
+  meta[0] = (stringEncoding << 1) | CHAR_FLAG_DICTIONARY | 1;  // compressed dictionary
+  meta[1] = BLOCKSIZE_CHAR;
+
+  char dictHeader[CHAR_DICT_HEADER_SIZE];
+  memset(dictHeader, 0, CHAR_DICT_HEADER_SIZE);
+  unsigned int* nrOfLevels = reinterpret_cast<unsigned int*>(dictHeader);
+  unsigned long long* codeVecOffset = reinterpret_cast<unsigned long long*>(&dictHeader[8]);
+
+  *nrOfLevels = dict.NrOfLevels();
+
+  myfile.write(reinterpret_cast<char*>(meta), CHAR_HEADER_SIZE);
+  myfile.write(dictHeader, CHAR_DICT_HEADER_SIZE);
+
+  // level vector
+  DictionaryLevelWriter levelWriter(&dict, stringEncoding);
+  fdsWriteCharVec_v6(myfile, &levelWriter, compression, codec, stringEncoding);
+
+  // code vector, bit-packed with the frame-of-reference codec
+  *codeVecOffset = static_cast<unsigned long long>(myfile.tellp()) - curPos;
+
+  Compressor* compress1;
+  Compressor* compress2 = nullptr;
+  StreamCompressor* streamCompressor;
+
+  if (codec == FstColumnCodec::LZ4)  // all blocks LZ4
+  {
+    compress1 = new SingleCompressor(CompAlgo::LZ4_FOR_INT, compression);
+    streamCompressor = new StreamSingleCompressor(compress1);
+  }
+  else if (codec == FstColumnCodec::ZSTD)  // all blocks ZSTD
+  {
+    compress1 = new SingleCompressor(CompAlgo::ZSTD_FOR_INT, compression);
+    streamCompressor = new StreamSingleCompressor(compress1);
+  }
+  else if (compression <= 50)
+  {
+    compress1 = new SingleCompressor(CompAlgo::FOR_INT, 0);
+    streamCompressor = new StreamSingleCompressor(compress1);
+  }
+  else
+  {
+    compress1 = new SingleCompressor(CompAlgo::FOR_INT, 0);
+    compress2 = new SingleCompressor(CompAlgo::ZSTD_FOR_INT, compression - 50);
+    streamCompressor = new StreamCompositeCompressor(compress1, compress2, 2 * (compression - 50));
+  }
+
+  streamCompressor->CompressBufferSize(4 * BLOCKSIZE_INT);
+  fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(codes), vecLength, 4, streamCompressor, BLOCKSIZE_INT, "", false);
+
+  delete streamCompressor;
+  delete compress1;
+  delete compress2;
+
+  // rewrite dictionary header
+  myfile.seekp(curPos + CHAR_HEADER_SIZE);
+  myfile.write(dictHeader, CHAR_DICT_HEADER_SIZE);
+  myfile.seekp(0, ios_base::end);
+
+  return true;
+}
+
+
+inline void ReadCharDictHeader(istream& myfile, unsigned long long blockPos, unsigned int& nrOfLevels,
+  unsigned long long& codeVecOffset)
+{
+  char dictHeader[CHAR_DICT_HEADER_SIZE];
+
+  myfile.seekg(blockPos + CHAR_HEADER_SIZE);
+  myfile.read(dictHeader, CHAR_DICT_HEADER_SIZE);
+
+  nrOfLevels = *reinterpret_cast<unsigned int*>(dictHeader);
+  codeVecOffset = *reinterpret_cast<unsigned long long*>(&dictHeader[8]);
+}
+
+
+bool fdsCharVecIsDictionary_v6(istream& myfile, unsigned long long blockPos, unsigned int& nrOfLevels)
+{
+  unsigned int meta[2];
+
+  myfile.seekg(blockPos);
+  myfile.read(reinterpret_cast<char*>(meta), CHAR_HEADER_SIZE);
+
+  if ((meta[0] & CHAR_FLAG_DICTIONARY) == 0) return false;
+
+  unsigned long long codeVecOffset;
+  ReadCharDictHeader(myfile, blockPos, nrOfLevels, codeVecOffset);
+
+  return true;
+}
+
+
+void fdsReadCharDictVec_v6(istream& myfile, IStringColumn* blockReader, unsigned long long blockPos, unsigned long long startRow,
+  unsigned long long vecLength, unsigned long long size)
+{
+  unsigned int nrOfLevels;
+  unsigned long long codeVecOffset;
+  ReadCharDictHeader(myfile, blockPos, nrOfLevels, codeVecOffset);
+
+  // levels
+  DictionaryLevelReader levels;
+  levels.AllocateVec(nrOfLevels);
+  fdsReadCharVec_v6(myfile, &levels, blockPos + CHAR_HEADER_SIZE + CHAR_DICT_HEADER_SIZE, 0, nrOfLevels, nrOfLevels);
+
+  if (levels.NrOfLevels() != nrOfLevels)
+  {
+    throw runtime_error(FSTERROR_DAMAGED_METADATA);
+  }
+
+  // codes
+  std::unique_ptr<int[]> codesP(new int[vecLength]);
+  int* codes = codesP.get();
+
+  std::string annotation;
+  bool hasAnnotation;
+  fdsReadColumn_v2(myfile, reinterpret_cast<char*>(codes), blockPos + codeVecOffset, startRow, vecLength, size, 4, annotation,
+    BATCH_SIZE_READ_FACTOR, hasAnnotation);
+
+  // expand codes to strings in blocks of BLOCKSIZE_CHAR elements
+  unsigned int sizeMeta[BLOCKSIZE_CHAR + 1 + BLOCKSIZE_CHAR / 32];
+  std::vector<char> buf(1);
+
+  for (unsigned long long vecPos = 0; vecPos < vecLength; vecPos += BLOCKSIZE_CHAR)
+  {
+    unsigned int nrOfElements = static_cast<unsigned int>(std::min(static_cast<unsigned long long>(BLOCKSIZE_CHAR), vecLength - vecPos));
+    unsigned int nrOfNAInts = 1 + nrOfElements / 32;
+    unsigned int* naInts = &sizeMeta[nrOfElements];
+    const int* blockCodes = &codes[vecPos];
+
+    memset(naInts, 0, nrOfNAInts * 4);
+
+    unsigned int totSize = 0;
+    bool hasNA = false;
+
+    for (unsigned int elem = 0; elem < nrOfElements; ++elem)
+    {
+      int code = blockCodes[elem];
+
+      if (code == static_cast<int>(FST_NA_INT))
+      {
+        hasNA = true;
+        naInts[elem / 32] |= 1u << (elem % 32);
+      }
+      else if (code < 1 || static_cast<unsigned int>(code) > nrOfLevels)
+      {
+        throw runtime_error(FSTERROR_DAMAGED_METADATA);
+      }
+      else
+      {
+        totSize += levels.LevelSize(code - 1);
+      }
+
+      sizeMeta[elem] = totSize;
+    }
+
+    if (hasNA) naInts[nrOfNAInts - 1] |= 1u << (nrOfElements % 32);  // NA flag
+
+    if (totSize > buf.size()) buf.resize(totSize);
+
+    unsigned int pos = 0;
+    for (unsigned int elem = 0; elem < nrOfElements; ++elem)
+    {
+      unsigned int newPos = sizeMeta[elem];
+      if (newPos != pos) memcpy(&buf[pos], levels.GetElement(blockCodes[elem] - 1), newPos - pos);
+      pos = newPos;
+    }
+
+    blockReader->BufferToVec(nrOfElements, 0, nrOfElements - 1, vecPos, sizeMeta, buf.data());
+  }
+}
+
+
+void fdsReadCharDictFactor_v6(istream& myfile, IFactorColumn* factorColumn, unsigned long long blockPos, unsigned long long startRow,
+  unsigned long long vecLength, unsigned long long size)
+{
+  unsigned int nrOfLevels;
+  unsigned long long codeVecOffset;
+  ReadCharDictHeader(myfile, blockPos, nrOfLevels, codeVecOffset);
+
+  // levels are read directly into the factor column
+  fdsReadCharVec_v6(myfile, factorColumn->Levels(), blockPos + CHAR_HEADER_SIZE + CHAR_DICT_HEADER_SIZE, 0, nrOfLevels, nrOfLevels);
+
+  std::string annotation;
+  bool hasAnnotation;
+  fdsReadColumn_v2(myfile, reinterpret_cast<char*>(factorColumn->LevelData()), blockPos + codeVecOffset, startRow, vecLength, size, 4,
+    annotation, BATCH_SIZE_READ_FACTOR, hasAnnotation);
+}
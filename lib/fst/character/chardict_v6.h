@@ -0,0 +1,65 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+#ifndef CHARDICT_V6_H
+#define CHARDICT_V6_H
+
+
+#include <iostream>
+#include <fstream>
+
+#include "interface/istringwriter.h"
+#include "interface/ifstcolumn.h"
+#include "interface/fstwriteoptions.h"
+
+
+// Dictionary encoded character column (flag CHAR_FLAG_DICTIONARY in the character column header):
+//
+//  CHAR_HEADER_SIZE      | flags and block size (identical to a regular character column)
+//  CHAR_DICT_HEADER_SIZE | number of levels (4 bytes), reserved (4 bytes), offset of the code vector (8 bytes)
+//  level vector          | regular character column with the distinct strings
+//  code vector           | integer column with 1-based level codes (NA's are stored as FST_NA_INT)
+
+
+// Write the character vector as a dictionary encoded column when the number of distinct strings is small compared to
+// the vector length. Returns false (and writes nothing) if the vector is not suitable for dictionary encoding. With an
+// explicit codec, the level vector and the codes use that codec only.
+bool fdsWriteCharDictVec_v6(std::ofstream &myfile, IStringWriter* stringWriter, int compression, FstColumnCodec codec,
+  StringEncoding stringEncoding);
+
+
+// Read a dictionary encoded column and expand the codes to strings. The string encoding of blockReader should be set.
+void fdsReadCharDictVec_v6(std::istream &myfile, IStringColumn* blockReader, unsigned long long blockPos, unsigned long long startRow,
+  unsigned long long vecLength, unsigned long long size);
+
+
+// Returns true if the character column at blockPos is dictionary encoded and sets the number of levels
+bool fdsCharVecIsDictionary_v6(std::istream &myfile, unsigned long long blockPos, unsigned int &nrOfLevels);
+
+
+// Read the codes and levels of a dictionary encoded column into a factor column, without creating the strings per row
+void fdsReadCharDictFactor_v6(std::istream &myfile, IFactorColumn* factorColumn, unsigned long long blockPos, unsigned long long startRow,
+  unsigned long long vecLength, unsigned long long size);
+
+
+#endif  // CHARDICT_V6_H
@@ -0,0 +1,566 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+#include <cstring>
+#include <climits>
+
+#include <compression/simd.h>
+#include <compression/bitpacking.h>
+#include <interface/fstdefines.h>
+
+#ifdef FST_SSE2
+  #include <emmintrin.h>
+#endif
+
+
+#define FOR_FLAG_NA 1
+
+
+unsigned int BitWidth(uint32_t value)
+{
+  unsigned int bitWidth = 0;
+
+  while (value != 0)
+  {
+    ++bitWidth;
+    value >>= 1;
+  }
+
+  return bitWidth;
+}
+
+
+unsigned int BitPackedSize(unsigned int nrOfElements, unsigned int bitWidth)
+{
+  unsigned int nrOfChunks = (nrOfElements + BITPACK_CHUNK - 1) / BITPACK_CHUNK;
+  return nrOfChunks * 16 * bitWidth;  // each chunk uses bitWidth 128-bit words
+}
+
+
+// Code of the bitWidth lowest bits set
+template<unsigned int W>
+inline uint32_t CodeMask()
+{
+  return W == 32 ? 0xffffffffu : (1u << (W & 31)) - 1;
+}
+
+
+// Reference kernels, the 4 lanes are processed in a plain loop
+
+template<unsigned int W>
+void PackScalar(const uint32_t* codes, uint32_t* packed)
+{
+  uint32_t acc[4] = { 0, 0, 0, 0 };
+
+  for (unsigned int k = 0; k < 32; ++k)
+  {
+    const unsigned int bitPos = (k * W) & 31;
+    const uint32_t* in = &codes[4 * k];
+
+    for (int lane = 0; lane < 4; ++lane)
+    {
+      acc[lane] |= in[lane] << bitPos;
+    }
+
+    if (bitPos + W >= 32)
+    {
+      for (int lane = 0; lane < 4; ++lane)
+      {
+        packed[lane] = acc[lane];
+        acc[lane] = (bitPos + W > 32) ? in[lane] >> ((32 - bitPos) & 31) : 0;
+      }
+
+      packed += 4;
+    }
+  }
+}
+
+
+template<unsigned int W, bool NA>
+void UnpackScalar(const uint32_t* packed, int* intVec, int frame)
+{
+  const uint32_t mask = CodeMask<W>();
+  uint32_t cur[4] = { 0, 0, 0, 0 };
+
+  if (W != 0) memcpy(cur, packed, 16);
+
+  for (unsigned int k = 0; k < 32; ++k)
+  {
+    const unsigned int bitPos = (k * W) & 31;
+    uint32_t codes[4];
+
+    for (int lane = 0; lane < 4; ++lane)
+    {
+      codes[lane] = cur[lane] >> bitPos;
+    }
+
+    if (bitPos + W > 32)
+    {
+      packed += 4;
+      for (int lane = 0; lane < 4; ++lane)
+      {
+        cur[lane] = packed[lane];
+        codes[lane] |= cur[lane] << ((32 - bitPos) & 31);
+      }
+    }
+    else if (bitPos + W == 32 && k != 31)
+    {
+      packed += 4;
+      memcpy(cur, packed, 16);
+    }
+
+    int* out = &intVec[4 * k];
+    for (int lane = 0; lane < 4; ++lane)
+    {
+      uint32_t code = codes[lane] & mask;
+      out[lane] = (NA && code == mask) ? static_cast<int>(FST_NA_INT) : static_cast<int>(code + static_cast<uint32_t>(frame));
+    }
+  }
+}
+
+
+#ifdef FST_SSE2
+
+template<unsigned int W>
+void PackSSE2(const uint32_t* codes, uint32_t* packed)
+{
+  const __m128i* in = reinterpret_cast<const __m128i*>(codes);
+  __m128i* out = reinterpret_cast<__m128i*>(packed);
+  __m128i acc = _mm_setzero_si128();
+
+  for (unsigned int k = 0; k < 32; ++k)
+  {
+    const unsigned int bitPos = (k * W) & 31;
+    const __m128i val = _mm_loadu_si128(&in[k]);
+
+    acc = _mm_or_si128(acc, _mm_sll_epi32(val, _mm_cvtsi32_si128(bitPos)));
+
+    if (bitPos + W >= 32)
+    {
+      _mm_storeu_si128(out++, acc);
+      acc = (bitPos + W > 32) ? _mm_srl_epi32(val, _mm_cvtsi32_si128(32 - bitPos)) : _mm_setzero_si128();
+    }
+  }
+}
+
+
+template<unsigned int W, bool NA>
+void UnpackSSE2(const uint32_t* packed, int* intVec, int frame)
+{
+  const __m128i* in = reinterpret_cast<const __m128i*>(packed);
+  __m128i* out = reinterpret_cast<__m128i*>(intVec);
+
+  const __m128i mask = _mm_set1_epi32(static_cast<int>(CodeMask<W>()));
+  const __m128i frameVec = _mm_set1_epi32(frame);
+  const __m128i naVec = _mm_set1_epi32(static_cast<int>(FST_NA_INT));
+
+  __m128i cur = W != 0 ? _mm_loadu_si128(in) : _mm_setzero_si128();
+
+  for (unsigned int k = 0; k < 32; ++k)
+  {
+    const unsigned int bitPos = (k * W) & 31;
+    __m128i codes = _mm_srl_epi32(cur, _mm_cvtsi32_si128(bitPos));
+
+    if (bitPos + W > 32)
+    {
+      cur = _mm_loadu_si128(++in);
+      codes = _mm_or_si128(codes, _mm_sll_epi32(cur, _mm_cvtsi32_si128(32 - bitPos)));
+    }
+    else if (bitPos + W == 32 && k != 31)
+    {
+      cur = _mm_loadu_si128(++in);
+    }
+
+    codes = _mm_and_si128(codes, mask);
+    __m128i res = _mm_add_epi32(codes, frameVec);
+
+    if (NA)
+    {
+      const __m128i isNA = _mm_cmpeq_epi32(codes, mask);
+      res = _mm_or_si128(_mm_andnot_si128(isNA, res), _mm_and_si128(isNA, naVec));
+    }
+
+    _mm_storeu_si128(&out[k], res);
+  }
+}
+
+#endif  // FST_SSE2
+
+
+typedef void (*PackKernel)(const uint32_t* codes, uint32_t* packed);
+typedef void (*UnpackKernel)(const uint32_t* packed, int* intVec, int frame);
+
+
+template<unsigned int W>
+void UnpackScalarPlain(const uint32_t* packed, int* intVec, int frame) { UnpackScalar<W, false>(packed, intVec, frame); }
+
+template<unsigned int W>
+void UnpackScalarNA(const uint32_t* packed, int* intVec, int frame) { UnpackScalar<W, true>(packed, intVec, frame); }
+
+#ifdef FST_SSE2
+template<unsigned int W>
+void UnpackSSE2Plain(const uint32_t* packed, int* intVec, int frame) { UnpackSSE2<W, false>(packed, intVec, frame); }
+
+template<unsigned int W>
+void UnpackSSE2NA(const uint32_t* packed, int* intVec, int frame) { UnpackSSE2<W, true>(packed, intVec, frame); }
+#endif
+
+
+// Kernel tables indexed by bit width
+#define BITPACK_KERNELS(KERNEL) { \
+  KERNEL<0 >, KERNEL<1 >, KERNEL<2 >, KERNEL<3 >, KERNEL<4 >, KERNEL<5 >, KERNEL<6 >, KERNEL<7 >, \
+  KERNEL<8 >, KERNEL<9 >, KERNEL<10>, KERNEL<11>, KERNEL<12>, KERNEL<13>, KERNEL<14>, KERNEL<15>, \
+  KERNEL<16>, KERNEL<17>, KERNEL<18>, KERNEL<19>, KERNEL<20>, KERNEL<21>, KERNEL<22>, KERNEL<23>, \
+  KERNEL<24>, KERNEL<25>, KERNEL<26>, KERNEL<27>, KERNEL<28>, KERNEL<29>, KERNEL<30>, KERNEL<31>, \
+  KERNEL<32> }
+
+static const PackKernel packScalar[33] = BITPACK_KERNELS(PackScalar);
+static const UnpackKernel unpackScalar[33] = BITPACK_KERNELS(UnpackScalarPlain);
+static const UnpackKernel unpackScalarNA[33] = BITPACK_KERNELS(UnpackScalarNA);
+
+#ifdef FST_SSE2
+static const PackKernel packKernels[33] = BITPACK_KERNELS(PackSSE2);
+static const UnpackKernel unpackKernels[33] = BITPACK_KERNELS(UnpackSSE2Plain);
+static const UnpackKernel unpackKernelsNA[33] = BITPACK_KERNELS(UnpackSSE2NA);
+#else
+static const PackKernel* packKernels = packScalar;
+static const UnpackKernel* unpackKernels = unpackScalar;
+static const UnpackKernel* unpackKernelsNA = unpackScalarNA;
+#endif
+
+
+void BitPack128(const uint32_t* codes, uint32_t* packed, unsigned int bitWidth)
+{
+  packKernels[bitWidth](codes, packed);
+}
+
+
+void BitUnpack128(const uint32_t* packed, int* intVec, unsigned int bitWidth, int frame, bool hasNA)
+{
+  if (hasNA)
+  {
+    unpackKernelsNA[bitWidth](packed, intVec, frame);
+    return;
+  }
+
+  unpackKernels[bitWidth](packed, intVec, frame);
+}
+
+
+void BitPack128Scalar(const uint32_t* codes, uint32_t* packed, unsigned int bitWidth)
+{
+  packScalar[bitWidth](codes, packed);
+}
+
+
+void BitUnpack128Scalar(const uint32_t* packed, int* intVec, unsigned int bitWidth, int frame, bool hasNA)
+{
+  if (hasNA)
+  {
+    unpackScalarNA[bitWidth](packed, intVec, frame);
+    return;
+  }
+
+  unpackScalar[bitWidth](packed, intVec, frame);
+}
+
+
+unsigned int ForPackInt(char* header, char* packed, const int* intVec, unsigned int nrOfInts)
+{
+  const int naInt = static_cast<int>(FST_NA_INT);
+  int minVal = INT_MAX;
+  int maxVal = INT_MIN;
+  unsigned int nrOfNA = 0;
+
+  for (unsigned int pos = 0; pos < nrOfInts; ++pos)
+  {
+    int val = intVec[pos];
+
+    if (val == naInt)
+    {
+      ++nrOfNA;
+      continue;
+    }
+
+    if (val < minVal) minVal = val;
+    if (val > maxVal) maxVal = val;
+  }
+
+  bool hasNA = nrOfNA != 0;
+  unsigned int bitWidth = 0;
+  uint32_t naCode = 0;
+
+  if (nrOfNA == nrOfInts)  // all NA, zero bit codes
+  {
+    minVal = 0;
+  }
+  else
+  {
+    uint32_t range = static_cast<uint32_t>(maxVal) - static_cast<uint32_t>(minVal);
+
+    // the all-ones code is reserved for NA, range + 1 can't overflow as FST_NA_INT is not part of the range
+    bitWidth = BitWidth(hasNA ? range + 1 : range);
+    naCode = bitWidth == 32 ? 0xffffffffu : (1u << bitWidth) - 1;
+  }
+
+  // Header
+  memcpy(header, &minVal, 4);
+  header[4] = static_cast<char>(bitWidth);
+  header[5] = static_cast<char>(hasNA ? FOR_FLAG_NA : 0);
+  header[6] = 0;
+  header[7] = 0;
+
+  if (bitWidth == 0) return 0;
+
+  // Codes relative to frame
+  uint32_t codes[BITPACK_CHUNK];
+  unsigned int nrOfChunks = (nrOfInts + BITPACK_CHUNK - 1) / BITPACK_CHUNK;
+  uint32_t* out = reinterpret_cast<uint32_t*>(packed);
+  const uint32_t frame = static_cast<uint32_t>(minVal);
+
+  for (unsigned int chunk = 0; chunk < nrOfChunks; ++chunk)
+  {
+    const int* in = &intVec[chunk * BITPACK_CHUNK];
+    unsigned int chunkSize = nrOfInts - chunk * BITPACK_CHUNK;
+    if (chunkSize > BITPACK_CHUNK) chunkSize = BITPACK_CHUNK;
+
+    for (unsigned int pos = 0; pos < chunkSize; ++pos)
+    {
+      codes[pos] = in[pos] == naInt ? naCode : static_cast<uint32_t>(in[pos]) - frame;
+    }
+
+    for (unsigned int pos = chunkSize; pos < BITPACK_CHUNK; ++pos) codes[pos] = 0;
+
+    BitPack128(codes, &out[chunk * 4 * bitWidth], bitWidth);
+  }
+
+  return BitPackedSize(nrOfInts, bitWidth);
+}
+
+
+unsigned int ForPackedSizeInt(const char* header, unsigned int nrOfInts)
+{
+  return BitPackedSize(nrOfInts, static_cast<unsigned char>(header[4]));
+}
+
+
+void ForUnpackInt(int* intVec, const char* header, const char* packed, unsigned int nrOfInts)
+{
+  int frame;
+  memcpy(&frame, header, 4);
+  unsigned int bitWidth = static_cast<unsigned char>(header[4]);
+  bool hasNA = (header[5] & FOR_FLAG_NA) != 0;
+
+  const uint32_t* in = reinterpret_cast<const uint32_t*>(packed);
+  unsigned int nrOfChunks = nrOfInts / BITPACK_CHUNK;
+
+  for (unsigned int chunk = 0; chunk < nrOfChunks; ++chunk)
+  {
+    BitUnpack128(&in[chunk * 4 * bitWidth], &intVec[chunk * BITPACK_CHUNK], bitWidth, frame, hasNA);
+  }
+
+  unsigned int remain = nrOfInts - nrOfChunks * BITPACK_CHUNK;
+  if (remain == 0) return;
+
+  int chunkBuf[BITPACK_CHUNK];
+  BitUnpack128(&in[nrOfChunks * 4 * bitWidth], chunkBuf, bitWidth, frame, hasNA);
+  memcpy(&intVec[nrOfChunks * BITPACK_CHUNK], chunkBuf, remain * 4);
+}
+
+
+void ForUnpackIntRange(int* intVec, const char* header, const char* packed, unsigned int rangeStart,
+  unsigned int rangeLength)
+{
+  int frame;
+  memcpy(&frame, header, 4);
+  unsigned int bitWidth = static_cast<unsigned char>(header[4]);
+  bool hasNA = (header[5] & FOR_FLAG_NA) != 0;
+
+  const uint32_t* in = reinterpret_cast<const uint32_t*>(packed);
+  unsigned int rangeEnd = rangeStart + rangeLength;
+  unsigned int pos = rangeStart;
+  int chunkBuf[BITPACK_CHUNK];
+
+  while (pos < rangeEnd)
+  {
+    unsigned int chunk = pos / BITPACK_CHUNK;
+    unsigned int chunkStart = chunk * BITPACK_CHUNK;
+
+    if (pos == chunkStart && rangeEnd >= chunkStart + BITPACK_CHUNK)  // full chunk
+    {
+      BitUnpack128(&in[chunk * 4 * bitWidth], &intVec[pos - rangeStart], bitWidth, frame, hasNA);
+      pos += BITPACK_CHUNK;
+      continue;
+    }
+
+    // partial chunk at the range boundaries
+    unsigned int chunkEnd = rangeEnd < chunkStart + BITPACK_CHUNK ? rangeEnd : chunkStart + BITPACK_CHUNK;
+    unsigned int count = chunkEnd - pos;
+    BitUnpack128(&in[chunk * 4 * bitWidth], chunkBuf, bitWidth, frame, hasNA);
+    memcpy(&intVec[pos - rangeStart], &chunkBuf[pos - chunkStart], count * 4);
+    pos += count;
+  }
+}
+
+
+unsigned int ForPackInt64(char* header, char* packed, const long long* int64Vec, unsigned int nrOfInts)
+{
+  const long long naInt64 = static_cast<long long>(FST_NA_INT64);
+  long long minVal = LLONG_MAX;
+  long long maxVal = LLONG_MIN;
+  unsigned int nrOfNA = 0;
+
+  for (unsigned int pos = 0; pos < nrOfInts; ++pos)
+  {
+    long long val = int64Vec[pos];
+
+    if (val == naInt64)
+    {
+      ++nrOfNA;
+      continue;
+    }
+
+    if (val < minVal) minVal = val;
+    if (val > maxVal) maxVal = val;
+  }
+
+  bool hasNA = nrOfNA != 0;
+  unsigned int bitWidth = 0;
+  uint32_t naCode = 0;
+
+  if (nrOfNA == nrOfInts)  // all NA, zero bit codes
+  {
+    minVal = 0;
+  }
+  else
+  {
+    unsigned long long range = static_cast<unsigned long long>(maxVal) - static_cast<unsigned long long>(minVal);
+
+    if (range >= 0xffffffffULL)  // codes don't fit in 32 bits (including the NA code)
+    {
+      bitWidth = FOR_RAW_INT64;
+      hasNA = false;  // NA's are stored as-is
+    }
+    else
+    {
+      bitWidth = BitWidth(static_cast<uint32_t>(hasNA ? range + 1 : range));
+      naCode = bitWidth == 32 ? 0xffffffffu : (1u << bitWidth) - 1;
+    }
+  }
+
+  // Header
+  memset(header, 0, FOR_HEADER_SIZE_INT64);
+  memcpy(header, &minVal, 8);
+  header[8] = static_cast<char>(bitWidth);
+  header[9] = static_cast<char>(hasNA ? FOR_FLAG_NA : 0);
+
+  if (bitWidth == 0) return 0;
+
+  if (bitWidth == FOR_RAW_INT64)
+  {
+    memcpy(packed, int64Vec, 8 * nrOfInts);
+    return 8 * nrOfInts;
+  }
+
+  // Codes relative to frame
+  uint32_t codes[BITPACK_CHUNK];
+  unsigned int nrOfChunks = (nrOfInts + BITPACK_CHUNK - 1) / BITPACK_CHUNK;
+  uint32_t* out = reinterpret_cast<uint32_t*>(packed);
+  const unsigned long long frame = static_cast<unsigned long long>(minVal);
+
+  for (unsigned int chunk = 0; chunk < nrOfChunks; ++chunk)
+  {
+    const long long* in = &int64Vec[chunk * BITPACK_CHUNK];
+    unsigned int chunkSize = nrOfInts - chunk * BITPACK_CHUNK;
+    if (chunkSize > BITPACK_CHUNK) chunkSize = BITPACK_CHUNK;
+
+    for (unsigned int pos = 0; pos < chunkSize; ++pos)
+    {
+      codes[pos] = in[pos] == naInt64 ? naCode : static_cast<uint32_t>(static_cast<unsigned long long>(in[pos]) - frame);
+    }
+
+    for (unsigned int pos = chunkSize; pos < BITPACK_CHUNK; ++pos) codes[pos] = 0;
+
+    BitPack128(codes, &out[chunk * 4 * bitWidth], bitWidth);
+  }
+
+  return BitPackedSize(nrOfInts, bitWidth);
+}
+
+
+unsigned int ForPackedSizeInt64(const char* header, unsigned int nrOfInts)
+{
+  unsigned int bitWidth = static_cast<unsigned char>(header[8]);
+
+  if (bitWidth == FOR_RAW_INT64) return 8 * nrOfInts;
+
+  return BitPackedSize(nrOfInts, bitWidth);
+}
+
+
+void ForUnpackInt64(long long* int64Vec, const char* header, const char* packed, unsigned int nrOfInts)
+{
+  long long frame;
+  memcpy(&frame, header, 8);
+  unsigned int bitWidth = static_cast<unsigned char>(header[8]);
+  bool hasNA = (header[9] & FOR_FLAG_NA) != 0;
+
+  if (bitWidth == FOR_RAW_INT64)
+  {
+    memcpy(int64Vec, packed, 8 * nrOfInts);
+    return;
+  }
+
+  const uint32_t* in = reinterpret_cast<const uint32_t*>(packed);
+  const uint32_t naCode = bitWidth == 32 ? 0xffffffffu : (1u << bitWidth) - 1;
+  const long long naInt64 = static_cast<long long>(FST_NA_INT64);
+  const unsigned long long frameU = static_cast<unsigned long long>(frame);
+
+  unsigned int nrOfChunks = (nrOfInts + BITPACK_CHUNK - 1) / BITPACK_CHUNK;
+  uint32_t codes[BITPACK_CHUNK];
+
+  for (unsigned int chunk = 0; chunk < nrOfChunks; ++chunk)
+  {
+    BitUnpack128(&in[chunk * 4 * bitWidth], reinterpret_cast<int*>(codes), bitWidth, 0, false);
+
+    long long* out = &int64Vec[chunk * BITPACK_CHUNK];
+    unsigned int chunkSize = nrOfInts - chunk * BITPACK_CHUNK;
+    if (chunkSize > BITPACK_CHUNK) chunkSize = BITPACK_CHUNK;
+
+    if (hasNA)
+    {
+      for (unsigned int pos = 0; pos < chunkSize; ++pos)
+      {
+        out[pos] = codes[pos] == naCode ? naInt64 : static_cast<long long>(frameU + codes[pos]);
+      }
+
+      continue;
+    }
+
+    for (unsigned int pos = 0; pos < chunkSize; ++pos)
+    {
+      out[pos] = static_cast<long long>(frameU + codes[pos]);
+    }
+  }
+}
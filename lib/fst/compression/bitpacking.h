@@ -0,0 +1,116 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+#ifndef BITPACKING_H
+#define BITPACKING_H
+
+#include <stdint.h>
+
+
+#define BITPACK_CHUNK          128  // number of integers in a single bit-packed chunk
+#define FOR_HEADER_SIZE_INT    8    // frame-of-reference header size for integer blocks
+#define FOR_HEADER_SIZE_INT64  16   // frame-of-reference header size for integer64 blocks
+#define FOR_RAW_INT64          64   // bit width marker for integer64 blocks that are stored unpacked
+
+
+// Frame-of-reference header layout
+//
+//  integer blocks:
+//  4 | int       | frame (minimum of all non-NA values)
+//  1 | uint8     | bit width of packed codes (0 - 32)
+//  1 | uint8     | flags, bit 0 set when the NA code is in use
+//  2 | uint16    | reserved
+//
+//  integer64 blocks:
+//  8 | long long | frame (minimum of all non-NA values)
+//  1 | uint8     | bit width of packed codes (0 - 32 or FOR_RAW_INT64)
+//  1 | uint8     | flags, bit 0 set when the NA code is in use
+//  6 |           | reserved
+//
+// Codes are stored relative to the frame. When NA's are present, the all-ones code of the block's bit width is
+// reserved for NA.
+
+
+// Number of significant bits in value
+unsigned int BitWidth(uint32_t value);
+
+
+// Pack BITPACK_CHUNK codes of bitWidth bits each into 4 * bitWidth words. Codes are interleaved in 4 lanes so
+// that packing and unpacking can use 128-bit registers.
+void BitPack128(const uint32_t* codes, uint32_t* packed, unsigned int bitWidth);
+
+
+// Unpack BITPACK_CHUNK codes and add frame. If hasNA is set, the all-ones code is converted to FST_NA_INT.
+void BitUnpack128(const uint32_t* packed, int* intVec, unsigned int bitWidth, int frame, bool hasNA);
+
+
+// Portable implementations with identical output, used as reference
+void BitPack128Scalar(const uint32_t* codes, uint32_t* packed, unsigned int bitWidth);
+
+void BitUnpack128Scalar(const uint32_t* packed, int* intVec, unsigned int bitWidth, int frame, bool hasNA);
+
+
+// Size in bytes of the packed data for nrOfElements codes of bitWidth bits
+unsigned int BitPackedSize(unsigned int nrOfElements, unsigned int bitWidth);
+
+
+// Write a frame-of-reference header for intVec to header and the packed codes to packed.
+// Buffer packed should hold at least BitPackedSize(nrOfInts, 32) bytes. Returns the number of bytes in packed.
+unsigned int ForPackInt(char* header, char* packed, const int* intVec, unsigned int nrOfInts);
+
+
+// Number of packed bytes that follow a frame-of-reference integer header
+unsigned int ForPackedSizeInt(const char* header, unsigned int nrOfInts);
+
+
+void ForUnpackInt(int* intVec, const char* header, const char* packed, unsigned int nrOfInts);
+
+
+// Unpack only integers [rangeStart, rangeStart + rangeLength) of a frame-of-reference block into intVec. Only the
+// chunks that overlap the range are unpacked, so packed needs to hold BitPackedSize(rangeStart + rangeLength, bitWidth)
+// bytes at most.
+void ForUnpackIntRange(int* intVec, const char* header, const char* packed, unsigned int rangeStart,
+  unsigned int rangeLength);
+
+
+// Integer64 version of ForPackInt. Buffer packed should hold at least ForPackBufferSizeInt64(nrOfInts) bytes.
+unsigned int ForPackInt64(char* header, char* packed, const long long* int64Vec, unsigned int nrOfInts);
+
+
+// Size of a buffer that holds the packed data of nrOfInts integer64 values: blocks with a range of 2^32 or more are
+// stored unpacked (FOR_RAW_INT64)
+inline unsigned int ForPackBufferSizeInt64(unsigned int nrOfInts)
+{
+  unsigned int packedSize = BitPackedSize(nrOfInts, 32);
+  return packedSize > 8 * nrOfInts ? packedSize : 8 * nrOfInts;
+}
+
+
+unsigned int ForPackedSizeInt64(const char* header, unsigned int nrOfInts);
+
+
+void ForUnpackInt64(long long* int64Vec, const char* header, const char* packed, unsigned int nrOfInts);
+
+
+#endif  // BITPACKING_H
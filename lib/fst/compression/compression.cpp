@@ -30,12 +30,22 @@
 #include <fstream>
 
 #include <compression/compression.h>
+#include <compression/bitpacking.h>
+#include <compression/logicpack.h>
+#include <compression/intcompact.h>
+#include <compression/xordouble.h>
+#include <compression/runlength.h>
+#include <compression/sparse.h>
+#include <compression/decimaldouble.h>
+#include <compression/narrowint64.h>
+#include <compression/scratchbuffer.h>
 #include <interface/fstdefines.h>
 
 // #include <unordered_map>
 // #include <boost/unordered_map.hpp>
 
 #include <zstd.h>
+#include <zdict.h>
 
 #define LZ4_DISABLE_DEPRECATE_WARNINGS  // required for Clang++6.0 compiler error
 #include <lz4.h>
@@ -213,173 +223,119 @@ void ShuffleReal(double* inVec, double* outVec, int nrOfDoubles)
 }
 
 
-void DeshuffleReal(double* inVec, double* outVec, int nrOfDoubles)
+// Swap the bytes of a selected by (mask << shift) with the bytes of b selected by mask
+inline void TransposeBytes(unsigned long long& a, unsigned long long& b, int shift, unsigned long long mask)
 {
-  int blockLength = nrOfDoubles / 8;
-
-  unsigned long long* vecInReal  = (unsigned long long*) inVec;
-  unsigned long long* vecOutReal = (unsigned long long*) outVec;
-
-  // Bit masks for long ints
-  unsigned long long byte0 = 255;
-  unsigned long long byte1 = byte0 << 8;
-  unsigned long long byte2 = byte1 << 8;
-  unsigned long long byte3 = byte2 << 8;
-  unsigned long long byte4 = byte3 << 8;
-  unsigned long long byte5 = byte4 << 8;
-  unsigned long long byte6 = byte5 << 8;
-  unsigned long long byte7 = byte6 << 8;
-
-  int offset = -1;
-  int blockIndex = 0;
-  for (int i = 0; i < blockLength; ++i)
-  {
-    // Combine most significant byte
-    unsigned long long compVal = vecInReal[++offset];
-
-    vecOutReal[blockIndex + 7] = (compVal << 56) & byte7;
-    vecOutReal[blockIndex + 6] = (compVal << 48) & byte7;
-    vecOutReal[blockIndex + 5] = (compVal << 40) & byte7;
-    vecOutReal[blockIndex + 4] = (compVal << 32) & byte7;
-    vecOutReal[blockIndex + 3] = (compVal << 24) & byte7;
-    vecOutReal[blockIndex + 2] = (compVal << 16) & byte7;
-    vecOutReal[blockIndex + 1] = (compVal << 8 ) & byte7;
-    vecOutReal[blockIndex    ] = (compVal      ) & byte7;
-
-    blockIndex += 8;
-  }
-
-  blockIndex = 0;
-  for (int i = 0; i < blockLength; ++i)
-  {
-    // Combine 7th byte
-    unsigned long long compVal = vecInReal[++offset];
+  unsigned long long swap = ((a >> shift) ^ b) & mask;
+  b ^= swap;
+  a ^= swap << shift;
+}
 
-    vecOutReal[blockIndex + 7] |= (compVal << 48) & byte6;
-    vecOutReal[blockIndex + 6] |= (compVal << 40) & byte6;
-    vecOutReal[blockIndex + 5] |= (compVal << 32) & byte6;
-    vecOutReal[blockIndex + 4] |= (compVal << 24) & byte6;
-    vecOutReal[blockIndex + 3] |= (compVal << 16) & byte6;
-    vecOutReal[blockIndex + 2] |= (compVal << 8 ) & byte6;
-    vecOutReal[blockIndex + 1] |= (compVal      ) & byte6;
-    vecOutReal[blockIndex    ] |= (compVal >> 8 ) & byte6;
 
-    blockIndex += 8;
-  }
+// Transpose a single group of 8 shuffled doubles into 64 bytes of output with arbitrary alignment
+inline void DeshuffleRealGroup(const unsigned long long* vecInReal, int blockLength, int group, char* outVec)
+{
+  // Byte masks for a 8 x 8 transpose
+  const unsigned long long mask32 = 0x00000000ffffffffULL;
+  const unsigned long long mask16 = 0x0000ffff0000ffffULL;
+  const unsigned long long mask8  = 0x00ff00ff00ff00ffULL;
+
+  // Row r contains byte r of 8 doubles
+  unsigned long long r0 = vecInReal[7 * blockLength + group];
+  unsigned long long r1 = vecInReal[6 * blockLength + group];
+  unsigned long long r2 = vecInReal[5 * blockLength + group];
+  unsigned long long r3 = vecInReal[4 * blockLength + group];
+  unsigned long long r4 = vecInReal[3 * blockLength + group];
+  unsigned long long r5 = vecInReal[2 * blockLength + group];
+  unsigned long long r6 = vecInReal[blockLength + group];
+  unsigned long long r7 = vecInReal[group];
+
+  TransposeBytes(r0, r4, 32, mask32);
+  TransposeBytes(r1, r5, 32, mask32);
+  TransposeBytes(r2, r6, 32, mask32);
+  TransposeBytes(r3, r7, 32, mask32);
+
+  TransposeBytes(r0, r2, 16, mask16);
+  TransposeBytes(r1, r3, 16, mask16);
+  TransposeBytes(r4, r6, 16, mask16);
+  TransposeBytes(r5, r7, 16, mask16);
+
+  TransposeBytes(r0, r1, 8, mask8);
+  TransposeBytes(r2, r3, 8, mask8);
+  TransposeBytes(r4, r5, 8, mask8);
+  TransposeBytes(r6, r7, 8, mask8);
+
+  unsigned long long outBlock[8] = { r7, r6, r5, r4, r3, r2, r1, r0 };
+  memcpy(outVec, outBlock, 64);
+}
 
-  blockIndex = 0;
-  for (int i = 0; i < blockLength; ++i)
-  {
-    // Combine 6th byte
-    unsigned long long compVal = vecInReal[++offset];
 
-    vecOutReal[blockIndex + 7] |= (compVal << 40) & byte5;
-    vecOutReal[blockIndex + 6] |= (compVal << 32) & byte5;
-    vecOutReal[blockIndex + 5] |= (compVal << 24) & byte5;
-    vecOutReal[blockIndex + 4] |= (compVal << 16) & byte5;
-    vecOutReal[blockIndex + 3] |= (compVal << 8 ) & byte5;
-    vecOutReal[blockIndex + 2] |= (compVal      ) & byte5;
-    vecOutReal[blockIndex + 1] |= (compVal >> 8 ) & byte5;
-    vecOutReal[blockIndex    ] |= (compVal >> 16) & byte5;
+// Deshuffle into an output vector of arbitrary alignment, each output value is written exactly once
+void DeshuffleReal(const double* inVec, char* outVec, int nrOfDoubles)
+{
+  int blockLength = nrOfDoubles / 8;
 
-    blockIndex += 8;
-  }
+  const unsigned long long* vecInReal = reinterpret_cast<const unsigned long long*>(inVec);
 
-  blockIndex = 0;
   for (int i = 0; i < blockLength; ++i)
   {
-    // Combine 5th byte
-    unsigned long long compVal = vecInReal[++offset];
-
-    vecOutReal[blockIndex + 7] |= (compVal << 32) & byte4;
-    vecOutReal[blockIndex + 6] |= (compVal << 24) & byte4;
-    vecOutReal[blockIndex + 5] |= (compVal << 16) & byte4;
-    vecOutReal[blockIndex + 4] |= (compVal << 8 ) & byte4;
-    vecOutReal[blockIndex + 3] |= (compVal      ) & byte4;
-    vecOutReal[blockIndex + 2] |= (compVal >> 8 ) & byte4;
-    vecOutReal[blockIndex + 1] |= (compVal >> 16) & byte4;
-    vecOutReal[blockIndex    ] |= (compVal >> 24) & byte4;
-
-    blockIndex += 8;
+    DeshuffleRealGroup(vecInReal, blockLength, i, &outVec[64 * i]);
   }
 
-  blockIndex = 0;
-  for (int i = 0; i < blockLength; ++i)
-  {
-    // Combine 4th byte
-    unsigned long long compVal = vecInReal[++offset];
+  // Copy remaining doubles unmodified
+  int remain = nrOfDoubles % 8;
+  int pos = blockLength * 8;
 
-    vecOutReal[blockIndex + 7] |= (compVal << 24) & byte3;
-    vecOutReal[blockIndex + 6] |= (compVal << 16) & byte3;
-    vecOutReal[blockIndex + 5] |= (compVal << 8 ) & byte3;
-    vecOutReal[blockIndex + 4] |= (compVal      ) & byte3;
-    vecOutReal[blockIndex + 3] |= (compVal >> 8 ) & byte3;
-    vecOutReal[blockIndex + 2] |= (compVal >> 16) & byte3;
-    vecOutReal[blockIndex + 1] |= (compVal >> 24) & byte3;
-    vecOutReal[blockIndex    ] |= (compVal >> 32) & byte3;
+  memcpy(&outVec[8 * pos], &inVec[pos], remain * 8);
+}
 
-    blockIndex += 8;
-  }
 
-  blockIndex = 0;
-  for (int i = 0; i < blockLength; ++i)
-  {
-    // Combine 4th byte
-    unsigned long long compVal = vecInReal[++offset];
-
-    vecOutReal[blockIndex + 7] |= (compVal << 16) & byte2;
-    vecOutReal[blockIndex + 6] |= (compVal << 8 ) & byte2;
-    vecOutReal[blockIndex + 5] |= (compVal      ) & byte2;
-    vecOutReal[blockIndex + 4] |= (compVal >> 8 ) & byte2;
-    vecOutReal[blockIndex + 3] |= (compVal >> 16) & byte2;
-    vecOutReal[blockIndex + 2] |= (compVal >> 24) & byte2;
-    vecOutReal[blockIndex + 1] |= (compVal >> 32) & byte2;
-    vecOutReal[blockIndex    ] |= (compVal >> 40) & byte2;
+// Deshuffle elements [rangeStart, rangeStart + rangeLength) of a shuffled vector, only groups that overlap the
+// range are transposed. Groups of 8 elements are transposed by deshuffleGroup.
+inline void DeshuffleRange(void (*deshuffleGroup)(const unsigned long long*, int, int, char*), const char* inVec,
+  char* outVec, int nrOfElements, int elementSize, int rangeStart, int rangeLength)
+{
+  int blockLength = nrOfElements / 8;
+  int groupSize = 8 * elementSize;
+  int rangeEnd = rangeStart + rangeLength;
+  int pos = rangeStart;
 
-    blockIndex += 8;
-  }
+  const unsigned long long* vecIn = reinterpret_cast<const unsigned long long*>(inVec);
+  unsigned long long groupBuf[8];
 
-  blockIndex = 0;
-  for (int i = 0; i < blockLength; ++i)
+  while (pos < rangeEnd && pos < 8 * blockLength)
   {
-    // Combine 2nd byte
-    unsigned long long compVal = vecInReal[++offset];
+    int group = pos / 8;
+    int groupStart = 8 * group;
 
-    vecOutReal[blockIndex + 7] |= (compVal << 8 ) & byte1;
-    vecOutReal[blockIndex + 6] |= (compVal      ) & byte1;
-    vecOutReal[blockIndex + 5] |= (compVal >> 8 ) & byte1;
-    vecOutReal[blockIndex + 4] |= (compVal >> 16) & byte1;
-    vecOutReal[blockIndex + 3] |= (compVal >> 24) & byte1;
-    vecOutReal[blockIndex + 2] |= (compVal >> 32) & byte1;
-    vecOutReal[blockIndex + 1] |= (compVal >> 40) & byte1;
-    vecOutReal[blockIndex    ] |= (compVal >> 48) & byte1;
+    if (pos == groupStart && rangeEnd >= groupStart + 8)  // full group
+    {
+      deshuffleGroup(vecIn, blockLength, group, outVec);
+      outVec += groupSize;
+      pos += 8;
+      continue;
+    }
 
-    blockIndex += 8;
+    // partial group at the range boundaries
+    int count = min(groupStart + 8, rangeEnd) - pos;
+    deshuffleGroup(vecIn, blockLength, group, reinterpret_cast<char*>(groupBuf));
+    memcpy(outVec, &reinterpret_cast<char*>(groupBuf)[elementSize * (pos - groupStart)], elementSize * count);
+    outVec += elementSize * count;
+    pos += count;
   }
 
-  blockIndex = 0;
-  for (int i = 0; i < blockLength; ++i)
+  // remaining elements are stored unmodified
+  if (pos < rangeEnd)
   {
-    // Combine least significant byte
-    unsigned long long compVal = vecInReal[++offset];
-
-    vecOutReal[blockIndex + 7] |= (compVal      ) & byte0;
-    vecOutReal[blockIndex + 6] |= (compVal >> 8 ) & byte0;
-    vecOutReal[blockIndex + 5] |= (compVal >> 16) & byte0;
-    vecOutReal[blockIndex + 4] |= (compVal >> 24) & byte0;
-    vecOutReal[blockIndex + 3] |= (compVal >> 32) & byte0;
-    vecOutReal[blockIndex + 2] |= (compVal >> 40) & byte0;
-    vecOutReal[blockIndex + 1] |= (compVal >> 48) & byte0;
-    vecOutReal[blockIndex    ] |= (compVal >> 56) & byte0;
-
-    blockIndex += 8;
+    memcpy(outVec, &inVec[elementSize * pos], elementSize * (rangeEnd - pos));
   }
+}
 
-  // Copy remaining doubles unmodified
-  int remain = nrOfDoubles % 8;
-  int pos = blockLength * 8;
 
-  memcpy(&outVec[pos], &inVec[pos], remain * 8);
+void DeshuffleRealRange(const double* inVec, char* outVec, int nrOfDoubles, int rangeStart, int rangeLength)
+{
+  DeshuffleRange(DeshuffleRealGroup, reinterpret_cast<const char*>(inVec), outVec, nrOfDoubles, 8, rangeStart,
+    rangeLength);
 }
 
 
@@ -459,81 +415,53 @@ void ShuffleInt2(int* inVec, int* outVec, int nrOfInts)
 }
 
 
-void DeshuffleInt2(int* inVec, int* outVec, int nrOfInts)
+// Transpose a single group of 8 shuffled integers into 32 bytes of output with arbitrary alignment
+inline void DeshuffleInt2Group(const unsigned long long* vecInLong, int blockLength, int group, char* outVec)
 {
-  int blockLength = nrOfInts / 8;
-
-  unsigned long long* vecInLong  = (unsigned long long*) inVec;
-  unsigned long long* vecOutLong = (unsigned long long*) outVec;
-
-  // Bit masks for 2 integers
-  unsigned long long byte0 = (255LL << 32) | 255;
-  unsigned long long byte1 = byte0 << 8;
-  unsigned long long byte2 = byte0 << 16;
-  unsigned long long byte3 = byte0 << 24;
-
-  int offset = -1;
-  int blockIndex = 0;
-  for (int i = 0; i < blockLength; ++i)
-  {
-    // Combine most significant byte
-    unsigned long long compVal = vecInLong[++offset];
-
-    vecOutLong[blockIndex + 3] = (compVal << 24) & byte3;
-    vecOutLong[blockIndex + 2] = (compVal << 16) & byte3;
-    vecOutLong[blockIndex + 1] = (compVal << 8 ) & byte3;
-    vecOutLong[blockIndex    ] = (compVal      ) & byte3;
+  // Byte masks for 2 parallel 4 x 4 transposes
+  const unsigned long long mask16 = 0x0000ffff0000ffffULL;
+  const unsigned long long mask8  = 0x00ff00ff00ff00ffULL;
+
+  // Row r contains byte r of 8 integers
+  unsigned long long r0 = vecInLong[3 * blockLength + group];
+  unsigned long long r1 = vecInLong[2 * blockLength + group];
+  unsigned long long r2 = vecInLong[blockLength + group];
+  unsigned long long r3 = vecInLong[group];
+
+  TransposeBytes(r0, r2, 16, mask16);
+  TransposeBytes(r1, r3, 16, mask16);
+  TransposeBytes(r0, r1, 8, mask8);
+  TransposeBytes(r2, r3, 8, mask8);
+
+  unsigned long long outBlock[4] = { r3, r2, r1, r0 };
+  memcpy(outVec, outBlock, 32);
+}
 
-    blockIndex += 4;
-  }
 
-  blockIndex = 0;
-  for (int i = 0; i < blockLength; ++i)
-  {
-    // Combine 3th byte
-    unsigned long long compVal = vecInLong[++offset];
+// Deshuffle into an output vector of arbitrary alignment, each output value is written exactly once
+void DeshuffleInt2(const int* inVec, char* outVec, int nrOfInts)
+{
+  int blockLength = nrOfInts / 8;
 
-    vecOutLong[blockIndex + 3] |= (compVal << 16) & byte2;
-    vecOutLong[blockIndex + 2] |= (compVal << 8 ) & byte2;
-    vecOutLong[blockIndex + 1] |= (compVal      ) & byte2;
-    vecOutLong[blockIndex    ] |= (compVal >> 8 ) & byte2;
+  const unsigned long long* vecInLong = reinterpret_cast<const unsigned long long*>(inVec);
 
-    blockIndex += 4;
-  }
-
-  blockIndex = 0;
   for (int i = 0; i < blockLength; ++i)
   {
-    // Combine 2nd byte
-    unsigned long long compVal = vecInLong[++offset];
-
-    vecOutLong[blockIndex + 3] |= (compVal << 8 ) & byte1;
-    vecOutLong[blockIndex + 2] |= (compVal      ) & byte1;
-    vecOutLong[blockIndex + 1] |= (compVal >> 8 ) & byte1;
-    vecOutLong[blockIndex    ] |= (compVal >> 16) & byte1;
-
-    blockIndex += 4;
-  }
-
-  blockIndex = 0;
-  for (int i = 0; i < blockLength; ++i)
-  {
-    // Combine least significant byte
-    unsigned long long compVal = vecInLong[++offset];
-
-    vecOutLong[blockIndex + 3] |= (compVal      ) & byte0;
-    vecOutLong[blockIndex + 2] |= (compVal >> 8 ) & byte0;
-    vecOutLong[blockIndex + 1] |= (compVal >> 16) & byte0;
-    vecOutLong[blockIndex    ] |= (compVal >> 24) & byte0;
-
-    blockIndex += 4;
+    DeshuffleInt2Group(vecInLong, blockLength, i, &outVec[32 * i]);
   }
 
   // Copy remaining integers unmodified
   int remain = nrOfInts % 8;
   int pos = blockLength * 8;
 
-  memcpy(&outVec[pos], &inVec[pos], remain * 4);
+  memcpy(&outVec[4 * pos], &inVec[pos], remain * 4);
+}
+
+
+void DeshuffleInt2Range(const int* inVec, char* outVec, int nrOfInts, int rangeStart, int rangeLength)
+{
+  DeshuffleRange(DeshuffleInt2Group, reinterpret_cast<const char*>(inVec), outVec, nrOfInts, 4, rangeStart,
+    rangeLength);
 }
 
 
@@ -544,7 +472,6 @@ void LogicDecompr64(char* logicalVec, const unsigned long long* compBuf, int nrO
   // Define filters
   unsigned long long BIT0 = (1LL << 32) | 1LL;
   unsigned long long BIT31 = BIT0 << 31;
-  unsigned long long BIT = BIT0 | BIT31;
 
   // Determine logical offset
   if (nrOfDiscard > 0)
@@ -566,22 +493,7 @@ void LogicDecompr64(char* logicalVec, const unsigned long long* compBuf, int nrO
 
     // Decompress full value
     unsigned long long logics[16];
-    logics[15] = (compVal << 15 & BIT31) | (compVal >> 15 & BIT0);
-    logics[14] = (compVal << 14 & BIT31) | (compVal >> 14 & BIT0);
-    logics[13] = (compVal << 13 & BIT31) | (compVal >> 13 & BIT0);
-    logics[12] = (compVal << 12 & BIT31) | (compVal >> 12 & BIT0);
-    logics[11] = (compVal << 11 & BIT31) | (compVal >> 11 & BIT0);
-    logics[10] = (compVal << 10 & BIT31) | (compVal >> 10 & BIT0);
-    logics[9 ] = (compVal << 9  & BIT31) | (compVal >> 9  & BIT0);
-    logics[8 ] = (compVal << 8  & BIT31) | (compVal >> 8  & BIT0);
-    logics[7 ] = (compVal << 7  & BIT31) | (compVal >> 7  & BIT0);
-    logics[6 ] = (compVal << 6  & BIT31) | (compVal >> 6  & BIT0);
-    logics[5 ] = (compVal << 5  & BIT31) | (compVal >> 5  & BIT0);
-    logics[4 ] = (compVal << 4  & BIT31) | (compVal >> 4  & BIT0);
-    logics[3 ] = (compVal << 3  & BIT31) | (compVal >> 3  & BIT0);
-    logics[2 ] = (compVal << 2  & BIT31) | (compVal >> 2  & BIT0);
-    logics[1 ] = (compVal << 1  & BIT31) | (compVal >> 1  & BIT0);
-    logics[0 ] = compVal & BIT;
+    LogicUnpack64Scalar(reinterpret_cast<char*>(logics), &compVal, 1);
 
     int* logicsInt = (int*) logics;  // 32 logicals
     int logicalsLeft = nrOfLogicals - nrOfDiscard;
@@ -597,7 +509,7 @@ void LogicDecompr64(char* logicalVec, const unsigned long long* compBuf, int nrO
       return;
     }
 
-    LogicDecompr64(&logicalVec[partLogicalsLeft], &compBuf[skipLongs + 1], logicalsLeft, 0);
+    LogicDecompr64(&logicalVec[4 * partLogicalsLeft], &compBuf[skipLongs + 1], logicalsLeft, 0);
 
     return;
   }
@@ -605,32 +517,11 @@ void LogicDecompr64(char* logicalVec, const unsigned long long* compBuf, int nrO
   // No logicals are discarded
 
   unsigned long long* logicals = (unsigned long long*) logicalVec;
-  unsigned long long* compress = (unsigned long long*) compBuf;
+  const unsigned long long* compress = compBuf;
   int nrOfLongs = nrOfLogicals / 32;
 
-  // Compress in cycles of 32 logicals
-  for (int i = 0; i < nrOfLongs; ++i)
-  {
-    unsigned long long* logics = &logicals[16 * i];
-    unsigned long long compVal = compress[i];
-
-    logics[15] = (compVal << 15 & BIT31) | (compVal >> 15 & BIT0);
-    logics[14] = (compVal << 14 & BIT31) | (compVal >> 14 & BIT0);
-    logics[13] = (compVal << 13 & BIT31) | (compVal >> 13 & BIT0);
-    logics[12] = (compVal << 12 & BIT31) | (compVal >> 12 & BIT0);
-    logics[11] = (compVal << 11 & BIT31) | (compVal >> 11 & BIT0);
-    logics[10] = (compVal << 10 & BIT31) | (compVal >> 10 & BIT0);
-    logics[9 ] = (compVal << 9  & BIT31) | (compVal >> 9  & BIT0);
-    logics[8 ] = (compVal << 8  & BIT31) | (compVal >> 8  & BIT0);
-    logics[7 ] = (compVal << 7  & BIT31) | (compVal >> 7  & BIT0);
-    logics[6 ] = (compVal << 6  & BIT31) | (compVal >> 6  & BIT0);
-    logics[5 ] = (compVal << 5  & BIT31) | (compVal >> 5  & BIT0);
-    logics[4 ] = (compVal << 4  & BIT31) | (compVal >> 4  & BIT0);
-    logics[3 ] = (compVal << 3  & BIT31) | (compVal >> 3  & BIT0);
-    logics[2 ] = (compVal << 2  & BIT31) | (compVal >> 2  & BIT0);
-    logics[1 ] = (compVal << 1  & BIT31) | (compVal >> 1  & BIT0);
-    logics[0 ] = compVal & BIT;
-  }
+  // Decompress in cycles of 32 logicals
+  LogicUnpack64(logicalVec, compress, nrOfLongs);
 
   // Process remainder
   int remain = nrOfLogicals % 32;
@@ -663,52 +554,10 @@ void LogicCompr64(const char* logicalVec, unsigned long long* compress, int nrOf
   const unsigned long long* logicals = (const unsigned long long*) logicalVec;
   int nrOfLongs = nrOfLogicals / 32;  // number of full longs
 
-  // Define filters
-  // TODO: define these as constants
-  unsigned long long BIT = (1LL << 32) | 1LL;
-  unsigned long long BIT0  = (BIT << 16) | (BIT << 15);
-  unsigned long long BIT1  = (BIT << 17) | (BIT << 14);
-  unsigned long long BIT2  = (BIT << 18) | (BIT << 13);
-  unsigned long long BIT3  = (BIT << 19) | (BIT << 12);
-  unsigned long long BIT4  = (BIT << 20) | (BIT << 11);
-  unsigned long long BIT5  = (BIT << 21) | (BIT << 10);
-  unsigned long long BIT6  = (BIT << 22) | (BIT << 9 );
-  unsigned long long BIT7  = (BIT << 23) | (BIT << 8 );
-  unsigned long long BIT8  = (BIT << 24) | (BIT << 7 );
-  unsigned long long BIT9  = (BIT << 25) | (BIT << 6 );
-  unsigned long long BIT10 = (BIT << 26) | (BIT << 5 );
-  unsigned long long BIT11 = (BIT << 27) | (BIT << 4 );
-  unsigned long long BIT12 = (BIT << 28) | (BIT << 3 );
-  unsigned long long BIT13 = (BIT << 29) | (BIT << 2 );
-  unsigned long long BIT14 = (BIT << 30) | (BIT << 1 );
-  unsigned long long BIT15 = (BIT << 31) | BIT;
-
-  const unsigned long long* logics;
-
   // Compress in cycles of 32 logicals
-  for (int i = 0; i < nrOfLongs; ++i)
-  {
-    logics = &logicals[16 * i];
-
-    compress[i] =
-      (((logics[15] >> 15) | logics[15] << 15) & BIT0 ) |
-      (((logics[14] >> 14) | logics[14] << 14) & BIT1 ) |
-      (((logics[13] >> 13) | logics[13] << 13) & BIT2 ) |
-      (((logics[12] >> 12) | logics[12] << 12) & BIT3 ) |
-      (((logics[11] >> 11) | logics[11] << 11) & BIT4 ) |
-      (((logics[10] >> 10) | logics[10] << 10) & BIT5 ) |
-      (((logics[9 ] >> 9 ) | logics[9 ] << 9 ) & BIT6 ) |
-      (((logics[8 ] >> 8 ) | logics[8 ] << 8 ) & BIT7 ) |
-      (((logics[7 ] >> 7 ) | logics[7 ] << 7 ) & BIT8 ) |
-      (((logics[6 ] >> 6 ) | logics[6 ] << 6 ) & BIT9 ) |
-      (((logics[5 ] >> 5 ) | logics[5 ] << 5 ) & BIT10) |
-      (((logics[4 ] >> 4 ) | logics[4 ] << 4 ) & BIT11) |
-      (((logics[3 ] >> 3 ) | logics[3 ] << 3 ) & BIT12) |
-      (((logics[2 ] >> 2 ) | logics[2 ] << 2 ) & BIT13) |
-      (((logics[1 ] >> 1 ) | logics[1 ] << 1 ) & BIT14) |
-      (  logics[0 ] & BIT15);
-  }
+  LogicPack64(logicalVec, compress, nrOfLongs);
 
+  unsigned long long BIT = (1LL << 32) | 1LL;
 
   // Process remainder
   int remain = nrOfLogicals % 32;  // nr of logicals remaining
@@ -718,7 +567,7 @@ void LogicCompr64(const char* logicalVec, unsigned long long* compress, int nrOf
   int* remain_ints = reinterpret_cast<int*>(remainLongs);
                                        
   // Compress the remainder in identical manner as the blocks here (for random access) !!!!!!
-  logics = &logicals[16 * nrOfLongs];
+  const unsigned long long* logics = &logicals[16 * nrOfLongs];
 
   const int nrOfRemainLongs = 1 + (remain - 1) / 2;  // per 2 logicals
 
@@ -740,6 +589,14 @@ void LogicCompr64(const char* logicalVec, unsigned long long* compress, int nrOf
 // Compressor integers in the reange 0-127 and the NA-bit
 void CompactIntToByte(char* outVec, const char* intVec, unsigned int nrOfInts)
 {
+  // leading groups are processed by the SIMD kernels
+  unsigned int nrOfKernelInts = CompactIntToByteKernel(outVec, intVec, nrOfInts);
+  if (nrOfKernelInts == nrOfInts) return;
+
+  outVec += nrOfKernelInts;
+  intVec += 4 * nrOfKernelInts;
+  nrOfInts -= nrOfKernelInts;
+
   // Determine vector size in number of longs
   int nrOfLongs = (nrOfInts - 1) / 8;  // all but the last long
 
@@ -786,6 +643,14 @@ void CompactIntToByte(char* outVec, const char* intVec, unsigned int nrOfInts)
 
 void DecompactShortToInt(const char* compressedVec, char* intVec, unsigned int nrOfInts)
 {
+  // leading groups are processed by the SIMD kernels
+  unsigned int nrOfKernelInts = DecompactShortToIntKernel(compressedVec, intVec, nrOfInts);
+  if (nrOfKernelInts == nrOfInts) return;
+
+  intVec += 4 * nrOfKernelInts;
+  compressedVec += 2 * nrOfKernelInts;
+  nrOfInts -= nrOfKernelInts;
+
   // Determine vector size in number of longs
   int nrOfLongs = (nrOfInts - 1) / 4;  // all but the last long
 
@@ -829,6 +694,14 @@ void DecompactShortToInt(const char* compressedVec, char* intVec, unsigned int n
 // Still need code for endianess
 void CompactIntToShort(char* outVec, const char* intVec, unsigned int nrOfInts)
 {
+  // leading groups are processed by the SIMD kernels
+  unsigned int nrOfKernelInts = CompactIntToShortKernel(outVec, intVec, nrOfInts);
+  if (nrOfKernelInts == nrOfInts) return;
+
+  outVec += 2 * nrOfKernelInts;
+  intVec += 4 * nrOfKernelInts;
+  nrOfInts -= nrOfKernelInts;
+
   // Determine vector size in number of longs
   int nrOfLongs = (nrOfInts - 1) / 4;  // all but the last long
 
@@ -868,6 +741,14 @@ void CompactIntToShort(char* outVec, const char* intVec, unsigned int nrOfInts)
 
 void DecompactByteToInt(const char* compressedVec, char* intVec, unsigned int nrOfInts)
 {
+  // leading groups are processed by the SIMD kernels
+  unsigned int nrOfKernelInts = DecompactByteToIntKernel(compressedVec, intVec, nrOfInts);
+  if (nrOfKernelInts == nrOfInts) return;
+
+  intVec += 4 * nrOfKernelInts;
+  compressedVec += nrOfKernelInts;
+  nrOfInts -= nrOfKernelInts;
+
   // Determine vector size in number of longs
   int nrOfLongs = (nrOfInts - 1) / 8;  // all but the last long
 
@@ -940,12 +821,32 @@ unsigned int LZ4_D(char* dst, unsigned int dstCapacity, const char* src, unsigne
   return static_cast<unsigned int>(LZ4_decompress_fast(src, dst, dstCapacity)) != compressedSize;
 }
 
+unsigned int LZ4_D_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize)
+{
+  unsigned int prefixSize = rangeStart + rangeSize;
+
+  // decoding stops at the end of the range, a range at the start of the block is decoded in place
+  if (rangeStart == 0)
+  {
+    return static_cast<unsigned int>(LZ4_decompress_safe_partial(src, dst, compressedSize, prefixSize, prefixSize)) != prefixSize;
+  }
+
+  ScratchBuffer scratch(SCRATCH_CODEC, prefixSize);
+  char* buf = scratch.Data();
+  unsigned int errorCode = static_cast<unsigned int>(LZ4_decompress_safe_partial(src, buf, compressedSize, prefixSize, prefixSize)) != prefixSize;
+  memcpy(dst, &buf[rangeStart], rangeSize);
+
+  return errorCode;
+}
+
 unsigned int LZ4_INT_TO_BYTE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
 {
   int nrOfLongs = 1 + (srcSize - 1) / 32;  // srcSize is processed in blocks of 32 bytes
 
   // Compress buffer
-  char buf[MAX_SIZE_COMPRESS_BLOCK_QUARTER];
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  char* buf = scratch.Data();
   // char buf[nrOfLongs * 8];
 
   CompactIntToByte(buf, src, srcSize / 4);
@@ -958,7 +859,8 @@ unsigned int LZ4_INT_TO_BYTE_D(char* dst, unsigned int dstCapacity, const char*
   int nrOfDstInts = dstCapacity / 4;
 
   // Compress buffer
-  char buf[MAX_SIZE_COMPRESS_BLOCK_QUARTER];
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  char* buf = scratch.Data();
 
   // Decompress
   unsigned int errorCode = static_cast<unsigned int>(LZ4_decompress_fast(src, (char*) buf, nrOfLongs * 8)) != compressedSize;
@@ -973,7 +875,8 @@ unsigned int ZSTD_INT_TO_BYTE_C(char* dst, unsigned int dstCapacity, const char*
   int nrOfLongs = 1 + (srcSize - 1) / 32;  // srcSize is processed in blocks of 32 bytes
 
   // Compress buffer
-  char buf[MAX_SIZE_COMPRESS_BLOCK_QUARTER];
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  char* buf = scratch.Data();
 
   CompactIntToByte(buf, src, srcSize / 4);
 
@@ -987,7 +890,8 @@ unsigned int ZSTD_INT_TO_BYTE_D(char* dst, unsigned int dstCapacity, const char*
 
   // Compress buffer
   // char buf[nrOfLongs * 8];
-  char buf[MAX_SIZE_COMPRESS_BLOCK_QUARTER];
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  char* buf = scratch.Data();
 
   // Decompress
   unsigned int errorCode = static_cast<unsigned int>(ZSTD_decompress((char*) buf, 8 * nrOfLongs, src, compressedSize) != 8 * nrOfLongs);
@@ -1001,7 +905,8 @@ unsigned int LZ4_INT_TO_SHORT_SHUF2_C(char* dst, unsigned int dstCapacity, const
   int nrOfLongs = 1 + (srcSize - 1) / 16;  // srcSize is processed in blocks of 16 bytes
 
   // Compress buffer
-  char buf[MAX_SIZE_COMPRESS_BLOCK_HALF];
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  char* buf = scratch.Data();
 
   CompactIntToShort(buf, src, srcSize / 4);  // expecting a integer vector here
   return LZ4_compress_fast(buf, dst, nrOfLongs * 8, dstCapacity, 100 - compressionLevel);  // no acceleration at compress == 100
@@ -1013,7 +918,8 @@ unsigned int LZ4_INT_TO_SHORT_SHUF2_D(char* dst, unsigned int dstCapacity, const
   int nrOfDstInts = dstCapacity / 4;
 
   // Compress buffer
-  char buf[MAX_SIZE_COMPRESS_BLOCK_HALF];
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  char* buf = scratch.Data();
 
   // Decompress
   const unsigned int errorCode = static_cast<unsigned int>(LZ4_decompress_fast(src, static_cast<char*>(buf), nrOfLongs * 8)) != compressedSize;
@@ -1027,7 +933,8 @@ unsigned int ZSTD_INT_TO_SHORT_SHUF2_C(char* dst, unsigned int dstCapacity, cons
   int nrOfLongs = 1 + (srcSize - 1) / 16;  // srcSize is processed in blocks of 16 bytes
 
   // Compress buffer
-  char buf[MAX_SIZE_COMPRESS_BLOCK_HALF];
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  char* buf = scratch.Data();
 
   CompactIntToShort(buf, src, srcSize / 4);  // expecting a integer vector here
 
@@ -1040,7 +947,8 @@ unsigned int ZSTD_INT_TO_SHORT_SHUF2_D(char* dst, unsigned int dstCapacity, cons
   const unsigned int nrOfDstInts = dstCapacity / 4;
 
   // Compress buffer
-  char buf[MAX_SIZE_COMPRESS_BLOCK_HALF];
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  char* buf = scratch.Data();
 
   // Decompress
   const unsigned int errorCode = ZSTD_decompress(static_cast<char*>(buf), nrOfLongs * 8, src, compressedSize) != nrOfLongs * 8;
@@ -1105,6 +1013,14 @@ unsigned int LOGIC64_D(char* dst, unsigned int dstCapacity, const char* src, uns
   return 0;
 }
 
+unsigned int LOGIC64_D_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize)
+{
+  LogicDecompr64(dst, (unsigned long long*) src, (rangeStart + rangeSize) / 4, rangeStart / 4);
+
+  return 0;
+}
+
 
 // LZ4_LOGIC64
 
@@ -1118,7 +1034,8 @@ unsigned int LZ4_LOGIC64_C(char* dst, unsigned int dstCapacity, const char* src,
 
   // Compress buffer
   // unsigned long long buf[nrOfLongs];
-  unsigned long long buf[MAX_SIZE_COMPRESS_BLOCK_128];
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  unsigned long long* buf = reinterpret_cast<unsigned long long*>(scratch.Data());
 
   LogicCompr64(src, buf, nrOfLogicals);
   return LZ4_compress_fast((char*) buf, dst, nrOfLongs * 8, dstCapacity, 100 - compressionLevel);  // no acceleration at compress == 100
@@ -1131,7 +1048,8 @@ unsigned int LZ4_LOGIC64_D(char* dst, unsigned int dstCapacity, const char* src,
 
   // Compress buffer
   // unsigned long long buf[nrOfLongs];
-  unsigned long long buf[MAX_SIZE_COMPRESS_BLOCK_128];
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  unsigned long long* buf = reinterpret_cast<unsigned long long*>(scratch.Data());
 
   // Decompress
   unsigned int errorCode = static_cast<unsigned int>(LZ4_decompress_fast(src, (char*) buf, 8 * nrOfLongs)) != compressedSize;
@@ -1140,6 +1058,23 @@ unsigned int LZ4_LOGIC64_D(char* dst, unsigned int dstCapacity, const char* src,
   return errorCode;
 }
 
+unsigned int LZ4_LOGIC64_D_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize)
+{
+  int nrOfLogicals = (rangeStart + rangeSize) / 4;
+  int nrOfLongs = 1 + (nrOfLogicals - 1) / 32;
+
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  unsigned long long* buf = reinterpret_cast<unsigned long long*>(scratch.Data());
+
+  // only the compressed logicals up to the end of the range are decoded
+  unsigned int errorCode = static_cast<unsigned int>(LZ4_decompress_safe_partial(src, (char*) buf, compressedSize,
+    8 * nrOfLongs, 8 * nrOfLongs)) != 8 * static_cast<unsigned int>(nrOfLongs);
+  LogicDecompr64(dst, buf, nrOfLogicals, rangeStart / 4);
+
+  return errorCode;
+}
+
 
 // ZSTD_LOGIC64
 
@@ -1153,7 +1088,8 @@ unsigned int ZSTD_LOGIC64_C(char* dst, unsigned int dstCapacity, const char* src
 
   // Compress buffer
   // unsigned long long buf[nrOfLongs];
-  unsigned long long buf[MAX_SIZE_COMPRESS_BLOCK_128];
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  unsigned long long* buf = reinterpret_cast<unsigned long long*>(scratch.Data());
 
   LogicCompr64(src, buf, nrOfLogicals);
 
@@ -1167,7 +1103,8 @@ unsigned int ZSTD_LOGIC64_D(char* dst, unsigned int dstCapacity, const char* src
 
     // Compress buffer
   // unsigned long long buf[nrOfLongs];
-  unsigned long long buf[MAX_SIZE_COMPRESS_BLOCK_128];
+  ScratchBuffer scratch(SCRATCH_CODEC, nrOfLongs * 8);
+  unsigned long long* buf = reinterpret_cast<unsigned long long*>(scratch.Data());
 
   // Decompress
   unsigned int errorCode = static_cast<unsigned int>(ZSTD_decompress((char*) buf, 8 * nrOfLongs, src, compressedSize) != 8 * nrOfLongs);
@@ -1185,7 +1122,8 @@ unsigned int LZ4_C_SHUF4(char* dst, unsigned int dstCapacity, const char* src,
 {
   int intSize = srcSize / 4;
 
-  unsigned long long shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_8];
+  ScratchBuffer scratch(SCRATCH_CODEC, srcSize);
+  unsigned long long* shuffleBuf = reinterpret_cast<unsigned long long*>(scratch.Data());
 
   ShuffleInt2((int*) src, (int*) shuffleBuf, intSize);
   return LZ4_compress_fast((char*) shuffleBuf, dst, srcSize, dstCapacity, 100 - compressionLevel);  // large acceleration
@@ -1195,10 +1133,23 @@ unsigned int LZ4_D_SHUF4(char* dst, unsigned int dstCapacity, const char* src, u
 {
   int intSize = dstCapacity / 4;
 
-  unsigned long long shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_8];
+  ScratchBuffer scratch(SCRATCH_CODEC, dstCapacity);
+  unsigned long long* shuffleBuf = reinterpret_cast<unsigned long long*>(scratch.Data());
+
+  unsigned int errorCode = static_cast<unsigned int>(LZ4_decompress_fast(src, (char*) shuffleBuf, dstCapacity)) != compressedSize;
+  DeshuffleInt2(reinterpret_cast<int*>(shuffleBuf), dst, intSize);
+
+  return errorCode;
+}
+
+unsigned int LZ4_D_SHUF4_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize)
+{
+  ScratchBuffer scratch(SCRATCH_CODEC, dstCapacity);
+  unsigned long long* shuffleBuf = reinterpret_cast<unsigned long long*>(scratch.Data());
 
   unsigned int errorCode = static_cast<unsigned int>(LZ4_decompress_fast(src, (char*) shuffleBuf, dstCapacity)) != compressedSize;
-  DeshuffleInt2((int*) shuffleBuf, (int*) dst, intSize);
+  DeshuffleInt2Range(reinterpret_cast<int*>(shuffleBuf), dst, dstCapacity / 4, rangeStart / 4, rangeSize / 4);
 
   return errorCode;
 }
@@ -1212,8 +1163,8 @@ unsigned int LZ4_C_SHUF8(char* dst, unsigned int dstCapacity, const char* src,
 {
   int doubleSize = srcSize / 8;
 
-  // double shuffleBuf[doubleSize];
-  double shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_8];
+  ScratchBuffer scratch(SCRATCH_CODEC, srcSize);
+  double* shuffleBuf = reinterpret_cast<double*>(scratch.Data());
 
   ShuffleReal((double*) src, shuffleBuf, doubleSize);
   return LZ4_compress_fast(reinterpret_cast<char*>(shuffleBuf), dst, srcSize, dstCapacity, 100 - compressionLevel);  // large acceleration
@@ -1223,11 +1174,23 @@ unsigned int LZ4_D_SHUF8(char* dst, unsigned int dstCapacity, const char* src, u
 {
   int doubleSize = dstCapacity / 8;
 
-  // double shuffleBuf[doubleSize];
-  double shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_8];
+  ScratchBuffer scratch(SCRATCH_CODEC, dstCapacity);
+  double* shuffleBuf = reinterpret_cast<double*>(scratch.Data());
+
+  unsigned int errorCode = static_cast<unsigned int>(LZ4_decompress_fast(src, (char*) shuffleBuf, dstCapacity)) != compressedSize;
+  DeshuffleReal(shuffleBuf, dst, doubleSize);
+
+  return errorCode;
+}
+
+unsigned int LZ4_D_SHUF8_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize)
+{
+  ScratchBuffer scratch(SCRATCH_CODEC, dstCapacity);
+  double* shuffleBuf = reinterpret_cast<double*>(scratch.Data());
 
   unsigned int errorCode = static_cast<unsigned int>(LZ4_decompress_fast(src, (char*) shuffleBuf, dstCapacity)) != compressedSize;
-  DeshuffleReal(shuffleBuf, (double*) dst, doubleSize);
+  DeshuffleRealRange(shuffleBuf, dst, dstCapacity / 8, rangeStart / 8, rangeSize / 8);
 
   return errorCode;
 }
@@ -1239,8 +1202,8 @@ unsigned int ZSTD_C_SHUF8(char* dst, unsigned int dstCapacity, const char* src,
 {
   int doubleSize = srcSize / 8;
 
-  // double shuffleBuf[doubleSize];
-  double shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_8];
+  ScratchBuffer scratch(SCRATCH_CODEC, srcSize);
+  double* shuffleBuf = reinterpret_cast<double*>(scratch.Data());
 
   ShuffleReal((double*) src, shuffleBuf, doubleSize);
   return ZSTD_compress(dst, dstCapacity, (char*) shuffleBuf, srcSize, (compressionLevel * ZSTD_maxCLevel()) / 100);
@@ -1250,11 +1213,23 @@ unsigned int ZSTD_D_SHUF8(char* dst, unsigned int dstCapacity, const char* src,
 {
   int doubleSize = dstCapacity / 8;
 
-  // double shuffleBuf[doubleSize];
-  double shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_8];
+  ScratchBuffer scratch(SCRATCH_CODEC, dstCapacity);
+  double* shuffleBuf = reinterpret_cast<double*>(scratch.Data());
+
+  unsigned int errorCode = ZSTD_decompress((char*) shuffleBuf, dstCapacity, src, compressedSize) != dstCapacity;
+  DeshuffleReal(shuffleBuf, dst, doubleSize);
+
+  return errorCode;
+}
+
+unsigned int ZSTD_D_SHUF8_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize)
+{
+  ScratchBuffer scratch(SCRATCH_CODEC, dstCapacity);
+  double* shuffleBuf = reinterpret_cast<double*>(scratch.Data());
 
   unsigned int errorCode = ZSTD_decompress((char*) shuffleBuf, dstCapacity, src, compressedSize) != dstCapacity;
-  DeshuffleReal(shuffleBuf, (double*) dst, doubleSize);
+  DeshuffleRealRange(shuffleBuf, dst, dstCapacity / 8, rangeStart / 8, rangeSize / 8);
 
   return errorCode;
 }
@@ -1272,6 +1247,16 @@ unsigned int ZSTD_D(char* dst, unsigned int dstCapacity, const char* src, unsign
   return ZSTD_decompress(dst, dstCapacity, src, compressedSize) != dstCapacity;
 }
 
+unsigned int ZSTD_TrainDictionary(char* dict, unsigned int dictCapacity, const char* samples, const size_t* sampleSizes,
+  unsigned int nrOfSamples)
+{
+  size_t dictSize = ZDICT_trainFromBuffer(dict, dictCapacity, samples, sampleSizes, nrOfSamples);
+
+  if (ZDICT_isError(dictSize)) return 0;
+
+  return static_cast<unsigned int>(dictSize);
+}
+
 
 // ZSTD_SHUF4
 
@@ -1279,8 +1264,8 @@ unsigned int ZSTD_C_SHUF4(char* dst, unsigned int dstCapacity, const char* src,
 {
   const int int_size = src_size / 4;
 
-  unsigned long long shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_8];
-  // int shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_QUARTER];
+  ScratchBuffer scratch(SCRATCH_CODEC, src_size);
+  unsigned long long* shuffleBuf = reinterpret_cast<unsigned long long*>(scratch.Data());
 
   ShuffleInt2((int*) src, reinterpret_cast<int*>(shuffleBuf), int_size);
   return ZSTD_compress(dst, dstCapacity, reinterpret_cast<char*>(shuffleBuf), src_size, (compressionLevel * ZSTD_maxCLevel()) / 100);
@@ -1290,14 +1275,552 @@ unsigned int ZSTD_D_SHUF4(char* dst, unsigned int dstCapacity, const char* src,
 {
   int intSize = dstCapacity / 4;
 
-  unsigned long long shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_8];
+  ScratchBuffer scratch(SCRATCH_CODEC, dstCapacity);
+  unsigned long long* shuffleBuf = reinterpret_cast<unsigned long long*>(scratch.Data());
 
   unsigned int errorCode = ZSTD_decompress((char*) shuffleBuf, dstCapacity, src, compressedSize) != dstCapacity;
-  DeshuffleInt2((int*) shuffleBuf, (int*) dst, intSize);
+  DeshuffleInt2(reinterpret_cast<int*>(shuffleBuf), dst, intSize);
+
+  return errorCode;
+}
+
+unsigned int ZSTD_D_SHUF4_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize)
+{
+  ScratchBuffer scratch(SCRATCH_CODEC, dstCapacity);
+  unsigned long long* shuffleBuf = reinterpret_cast<unsigned long long*>(scratch.Data());
+
+  unsigned int errorCode = ZSTD_decompress((char*) shuffleBuf, dstCapacity, src, compressedSize) != dstCapacity;
+  DeshuffleInt2Range(reinterpret_cast<int*>(shuffleBuf), dst, dstCapacity / 4, rangeStart / 4, rangeSize / 4);
+
+  return errorCode;
+}
+
+
+// FOR_INT
+
+unsigned int FOR_INT_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  unsigned int packedSize = ForPackInt(dst, &dst[FOR_HEADER_SIZE_INT], reinterpret_cast<const int*>(src), srcSize / 4);
+
+  return FOR_HEADER_SIZE_INT + packedSize;
+}
+
+unsigned int FOR_INT_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  unsigned int nrOfInts = dstCapacity / 4;
+  unsigned int errorCode = FOR_HEADER_SIZE_INT + ForPackedSizeInt(src, nrOfInts) != compressedSize;
+
+  ForUnpackInt(reinterpret_cast<int*>(dst), src, &src[FOR_HEADER_SIZE_INT], nrOfInts);
 
   return errorCode;
 }
 
+unsigned int FOR_INT_D_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize)
+{
+  unsigned int errorCode = FOR_HEADER_SIZE_INT + ForPackedSizeInt(src, dstCapacity / 4) != compressedSize;
+
+  ForUnpackIntRange(reinterpret_cast<int*>(dst), src, &src[FOR_HEADER_SIZE_INT], rangeStart / 4, rangeSize / 4);
+
+  return errorCode;
+}
+
+
+// LZ4_FOR_INT
+
+unsigned int LZ4_FOR_INT_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  ScratchBuffer scratch(SCRATCH_CODEC, BitPackedSize(srcSize / 4, 32));
+  char* packBuf = scratch.Data();
+
+  // the header is stored uncompressed
+  unsigned int packedSize = ForPackInt(dst, packBuf, reinterpret_cast<const int*>(src), srcSize / 4);
+  if (packedSize == 0) return FOR_HEADER_SIZE_INT;
+
+  return FOR_HEADER_SIZE_INT + LZ4_compress_fast(packBuf, &dst[FOR_HEADER_SIZE_INT], packedSize,
+    dstCapacity - FOR_HEADER_SIZE_INT, 100 - compressionLevel);
+}
+
+unsigned int LZ4_FOR_INT_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  unsigned int nrOfInts = dstCapacity / 4;
+  unsigned int packedSize = ForPackedSizeInt(src, nrOfInts);
+  ScratchBuffer scratch(SCRATCH_CODEC, BitPackedSize(nrOfInts, 32));
+  char* packBuf = scratch.Data();
+  unsigned int errorCode = 0;
+
+  if (packedSize != 0)
+  {
+    errorCode = static_cast<unsigned int>(LZ4_decompress_fast(&src[FOR_HEADER_SIZE_INT], packBuf, packedSize))
+      != compressedSize - FOR_HEADER_SIZE_INT;
+  }
+
+  ForUnpackInt(reinterpret_cast<int*>(dst), src, packBuf, nrOfInts);
+
+  return errorCode;
+}
+
+unsigned int LZ4_FOR_INT_D_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize)
+{
+  // packed chunks up to the end of the range
+  unsigned int prefixSize = ForPackedSizeInt(src, (rangeStart + rangeSize) / 4);
+  ScratchBuffer scratch(SCRATCH_CODEC, prefixSize);
+  char* packBuf = scratch.Data();
+  unsigned int errorCode = 0;
+
+  if (prefixSize != 0)
+  {
+    errorCode = static_cast<unsigned int>(LZ4_decompress_safe_partial(&src[FOR_HEADER_SIZE_INT], packBuf,
+      compressedSize - FOR_HEADER_SIZE_INT, prefixSize, prefixSize)) != prefixSize;
+  }
+
+  ForUnpackIntRange(reinterpret_cast<int*>(dst), src, packBuf, rangeStart / 4, rangeSize / 4);
+
+  return errorCode;
+}
+
+
+// ZSTD_FOR_INT
+
+unsigned int ZSTD_FOR_INT_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  ScratchBuffer scratch(SCRATCH_CODEC, BitPackedSize(srcSize / 4, 32));
+  char* packBuf = scratch.Data();
+
+  // the header is stored uncompressed
+  unsigned int packedSize = ForPackInt(dst, packBuf, reinterpret_cast<const int*>(src), srcSize / 4);
+  if (packedSize == 0) return FOR_HEADER_SIZE_INT;
+
+  return FOR_HEADER_SIZE_INT + ZSTD_compress(&dst[FOR_HEADER_SIZE_INT], dstCapacity - FOR_HEADER_SIZE_INT,
+    packBuf, packedSize, (compressionLevel * ZSTD_maxCLevel()) / 100);
+}
+
+unsigned int ZSTD_FOR_INT_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  unsigned int nrOfInts = dstCapacity / 4;
+  unsigned int packedSize = ForPackedSizeInt(src, nrOfInts);
+  ScratchBuffer scratch(SCRATCH_CODEC, BitPackedSize(nrOfInts, 32));
+  char* packBuf = scratch.Data();
+  unsigned int errorCode = 0;
+
+  if (packedSize != 0)
+  {
+    errorCode = ZSTD_decompress(packBuf, packedSize, &src[FOR_HEADER_SIZE_INT],
+      compressedSize - FOR_HEADER_SIZE_INT) != packedSize;
+  }
+
+  ForUnpackInt(reinterpret_cast<int*>(dst), src, packBuf, nrOfInts);
+
+  return errorCode;
+}
+
+unsigned int ZSTD_FOR_INT_D_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize)
+{
+  unsigned int packedSize = ForPackedSizeInt(src, dstCapacity / 4);
+  ScratchBuffer scratch(SCRATCH_CODEC, packedSize);
+  char* packBuf = scratch.Data();
+  unsigned int errorCode = 0;
+
+  if (packedSize != 0)
+  {
+    errorCode = ZSTD_decompress(packBuf, packedSize, &src[FOR_HEADER_SIZE_INT],
+      compressedSize - FOR_HEADER_SIZE_INT) != packedSize;
+  }
+
+  ForUnpackIntRange(reinterpret_cast<int*>(dst), src, packBuf, rangeStart / 4, rangeSize / 4);
+
+  return errorCode;
+}
+
+
+// FOR_INT64
+
+unsigned int FOR_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  unsigned int packedSize = ForPackInt64(dst, &dst[FOR_HEADER_SIZE_INT64], reinterpret_cast<const long long*>(src), srcSize / 8);
+
+  return FOR_HEADER_SIZE_INT64 + packedSize;
+}
+
+unsigned int FOR_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  unsigned int nrOfInts = dstCapacity / 8;
+  unsigned int errorCode = FOR_HEADER_SIZE_INT64 + ForPackedSizeInt64(src, nrOfInts) != compressedSize;
+
+  ForUnpackInt64(reinterpret_cast<long long*>(dst), src, &src[FOR_HEADER_SIZE_INT64], nrOfInts);
+
+  return errorCode;
+}
+
+
+// LZ4_FOR_INT64
+
+unsigned int LZ4_FOR_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  ScratchBuffer scratch(SCRATCH_CODEC, ForPackBufferSizeInt64(srcSize / 8));
+  char* packBuf = scratch.Data();
+
+  // the header is stored uncompressed
+  unsigned int packedSize = ForPackInt64(dst, packBuf, reinterpret_cast<const long long*>(src), srcSize / 8);
+  if (packedSize == 0) return FOR_HEADER_SIZE_INT64;
+
+  return FOR_HEADER_SIZE_INT64 + LZ4_compress_fast(packBuf, &dst[FOR_HEADER_SIZE_INT64], packedSize,
+    dstCapacity - FOR_HEADER_SIZE_INT64, 100 - compressionLevel);
+}
+
+unsigned int LZ4_FOR_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  unsigned int nrOfInts = dstCapacity / 8;
+  unsigned int packedSize = ForPackedSizeInt64(src, nrOfInts);
+  ScratchBuffer scratch(SCRATCH_CODEC, ForPackBufferSizeInt64(nrOfInts));
+  char* packBuf = scratch.Data();
+  unsigned int errorCode = 0;
+
+  if (packedSize != 0)
+  {
+    errorCode = static_cast<unsigned int>(LZ4_decompress_fast(&src[FOR_HEADER_SIZE_INT64], packBuf, packedSize))
+      != compressedSize - FOR_HEADER_SIZE_INT64;
+  }
+
+  ForUnpackInt64(reinterpret_cast<long long*>(dst), src, packBuf, nrOfInts);
+
+  return errorCode;
+}
+
+
+// ZSTD_FOR_INT64
+
+unsigned int ZSTD_FOR_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  ScratchBuffer scratch(SCRATCH_CODEC, ForPackBufferSizeInt64(srcSize / 8));
+  char* packBuf = scratch.Data();
+
+  // the header is stored uncompressed
+  unsigned int packedSize = ForPackInt64(dst, packBuf, reinterpret_cast<const long long*>(src), srcSize / 8);
+  if (packedSize == 0) return FOR_HEADER_SIZE_INT64;
+
+  return FOR_HEADER_SIZE_INT64 + ZSTD_compress(&dst[FOR_HEADER_SIZE_INT64], dstCapacity - FOR_HEADER_SIZE_INT64,
+    packBuf, packedSize, (compressionLevel * ZSTD_maxCLevel()) / 100);
+}
+
+unsigned int ZSTD_FOR_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  unsigned int nrOfInts = dstCapacity / 8;
+  unsigned int packedSize = ForPackedSizeInt64(src, nrOfInts);
+  ScratchBuffer scratch(SCRATCH_CODEC, ForPackBufferSizeInt64(nrOfInts));
+  char* packBuf = scratch.Data();
+  unsigned int errorCode = 0;
+
+  if (packedSize != 0)
+  {
+    errorCode = ZSTD_decompress(packBuf, packedSize, &src[FOR_HEADER_SIZE_INT64],
+      compressedSize - FOR_HEADER_SIZE_INT64) != packedSize;
+  }
+
+  ForUnpackInt64(reinterpret_cast<long long*>(dst), src, packBuf, nrOfInts);
+
+  return errorCode;
+}
+
+
+// XOR_DOUBLE
+
+unsigned int XOR_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  return XorCompressDouble(dst, reinterpret_cast<const double*>(src), srcSize / 8);
+}
+
+unsigned int XOR_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return XorDecompressDouble(reinterpret_cast<double*>(dst), src, compressedSize, dstCapacity / 8);
+}
+
+
+// DEC_DOUBLE
+
+unsigned int DEC_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  return DecimalCompressDouble(dst, dstCapacity, reinterpret_cast<const double*>(src), srcSize / 8, compressionLevel, FOR_INT64_C);
+}
+
+unsigned int DEC_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return DecimalDecompressDouble(reinterpret_cast<double*>(dst), src, compressedSize, dstCapacity / 8, FOR_INT64_D);
+}
+
+
+// LZ4_DEC_DOUBLE
+
+unsigned int LZ4_DEC_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  return DecimalCompressDouble(dst, dstCapacity, reinterpret_cast<const double*>(src), srcSize / 8, compressionLevel, LZ4_FOR_INT64_C);
+}
+
+unsigned int LZ4_DEC_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return DecimalDecompressDouble(reinterpret_cast<double*>(dst), src, compressedSize, dstCapacity / 8, LZ4_FOR_INT64_D);
+}
+
+
+// ZSTD_DEC_DOUBLE
+
+unsigned int ZSTD_DEC_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  return DecimalCompressDouble(dst, dstCapacity, reinterpret_cast<const double*>(src), srcSize / 8, compressionLevel, ZSTD_FOR_INT64_C);
+}
+
+unsigned int ZSTD_DEC_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return DecimalDecompressDouble(reinterpret_cast<double*>(dst), src, compressedSize, dstCapacity / 8, ZSTD_FOR_INT64_D);
+}
+
+
+// RLE_INT
+
+unsigned int RLE_INT_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  return RunLengthCompressInt(dst, reinterpret_cast<const int*>(src), srcSize / 4);
+}
+
+unsigned int RLE_INT_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return RunLengthDecompressInt(reinterpret_cast<int*>(dst), src, compressedSize, dstCapacity / 4);
+}
+
+
+// CONSTANT
+
+unsigned int CONSTANT_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  return ConstantCompress(dst, src, srcSize);
+}
+
+unsigned int CONSTANT_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return ConstantDecompress(dst, dstCapacity, src, compressedSize);
+}
+
+
+// SPARSE_INT
+
+unsigned int SPARSE_INT_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  return SparseCompressInt(dst, reinterpret_cast<const int*>(src), srcSize / 4);
+}
+
+unsigned int SPARSE_INT_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return SparseDecompressInt(reinterpret_cast<int*>(dst), src, compressedSize, dstCapacity / 4);
+}
+
+
+// SPARSE_INT64
+
+unsigned int SPARSE_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  return SparseCompressInt64(dst, reinterpret_cast<const long long*>(src), srcSize / 8);
+}
+
+unsigned int SPARSE_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return SparseDecompressInt64(reinterpret_cast<long long*>(dst), src, compressedSize, dstCapacity / 8);
+}
+
+
+// NARROW_INT64
+
+unsigned int NARROW_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  unsigned int nrOfInts = srcSize / 8;
+  const long long* int64Vec = reinterpret_cast<const long long*>(src);
+  unsigned int width = NarrowWidthInt64(int64Vec, nrOfInts);
+
+  memset(dst, 0, NARROW_HEADER_SIZE);
+  dst[0] = static_cast<char>(width);
+
+  if (width == 8)
+  {
+    memcpy(&dst[NARROW_HEADER_SIZE], src, srcSize);
+    return NARROW_HEADER_SIZE + srcSize;
+  }
+
+  NarrowInt64(&dst[NARROW_HEADER_SIZE], int64Vec, nrOfInts, width);
+  return NARROW_HEADER_SIZE + width * nrOfInts;
+}
+
+unsigned int NARROW_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  unsigned int nrOfInts = dstCapacity / 8;
+  unsigned int width = static_cast<unsigned char>(src[0]);
+
+  if (compressedSize != NARROW_HEADER_SIZE + width * nrOfInts) return 1;
+
+  if (width == 8)
+  {
+    memcpy(dst, &src[NARROW_HEADER_SIZE], dstCapacity);
+    return 0;
+  }
+
+  WidenInt64(reinterpret_cast<long long*>(dst), &src[NARROW_HEADER_SIZE], nrOfInts, width);
+  return 0;
+}
+
+
+// Narrow (or byte shuffle when the block can't be narrowed) a block of integer64 values into buf, which holds at
+// least srcSize bytes. Narrowed integers are byte shuffled as well. Returns the width of the block elements.
+inline unsigned int NarrowShuffleInt64(char* header, const char* src, unsigned int srcSize, char* buf)
+{
+  unsigned int nrOfInts = srcSize / 8;
+  const long long* int64Vec = reinterpret_cast<const long long*>(src);
+  unsigned int width = NarrowWidthInt64(int64Vec, nrOfInts);
+
+  memset(header, 0, NARROW_HEADER_SIZE);
+  header[0] = static_cast<char>(width);
+
+  if (width == 8)
+  {
+    ShuffleReal((double*) src, reinterpret_cast<double*>(buf), nrOfInts);
+    return width;
+  }
+
+  if (width == 4)
+  {
+    ScratchBuffer narrowScratch(SCRATCH_CODEC_AUX, 4 * nrOfInts);
+    char* narrowBuf = narrowScratch.Data();
+    NarrowInt64(narrowBuf, int64Vec, nrOfInts, width);
+    ShuffleInt2(reinterpret_cast<int*>(narrowBuf), reinterpret_cast<int*>(buf), nrOfInts);
+    return width;
+  }
+
+  NarrowInt64(buf, int64Vec, nrOfInts, width);
+  return width;
+}
+
+
+// Inverse of NarrowShuffleInt64, buf contains width * nrOfInts bytes
+inline void WidenDeshuffleInt64(char* dst, char* buf, unsigned int nrOfInts, unsigned int width)
+{
+  if (width == 8)
+  {
+    DeshuffleReal(reinterpret_cast<double*>(buf), dst, nrOfInts);
+    return;
+  }
+
+  if (width == 4)
+  {
+    ScratchBuffer narrowScratch(SCRATCH_CODEC_AUX, 4 * nrOfInts);
+    char* narrowBuf = narrowScratch.Data();
+    DeshuffleInt2(reinterpret_cast<int*>(buf), narrowBuf, nrOfInts);
+    buf = narrowBuf;
+  }
+
+  WidenInt64(reinterpret_cast<long long*>(dst), buf, nrOfInts, width);
+}
+
+
+// LZ4_NARROW_INT64
+
+unsigned int LZ4_NARROW_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  ScratchBuffer scratch(SCRATCH_CODEC, srcSize);
+  char* buf = scratch.Data();
+  unsigned int width = NarrowShuffleInt64(dst, src, srcSize, buf);
+
+  return NARROW_HEADER_SIZE + LZ4_compress_fast(buf, &dst[NARROW_HEADER_SIZE], width * (srcSize / 8),
+    dstCapacity - NARROW_HEADER_SIZE, 100 - compressionLevel);
+}
+
+unsigned int LZ4_NARROW_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  unsigned int nrOfInts = dstCapacity / 8;
+  unsigned int width = static_cast<unsigned char>(src[0]);
+  unsigned int narrowSize = width * nrOfInts;
+
+  if ((width != 1 && width != 2 && width != 4 && width != 8) || compressedSize < NARROW_HEADER_SIZE) return 1;
+
+  ScratchBuffer scratch(SCRATCH_CODEC, narrowSize);
+  char* buf = scratch.Data();
+  unsigned int errorCode = static_cast<unsigned int>(LZ4_decompress_fast(&src[NARROW_HEADER_SIZE], buf, narrowSize))
+    != compressedSize - NARROW_HEADER_SIZE;
+
+  WidenDeshuffleInt64(dst, buf, nrOfInts, width);
+
+  return errorCode;
+}
+
+
+// ZSTD_NARROW_INT64
+
+unsigned int ZSTD_NARROW_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  ScratchBuffer scratch(SCRATCH_CODEC, srcSize);
+  char* buf = scratch.Data();
+  unsigned int width = NarrowShuffleInt64(dst, src, srcSize, buf);
+
+  return NARROW_HEADER_SIZE + ZSTD_compress(&dst[NARROW_HEADER_SIZE], dstCapacity - NARROW_HEADER_SIZE, buf,
+    width * (srcSize / 8), (compressionLevel * ZSTD_maxCLevel()) / 100);
+}
+
+unsigned int ZSTD_NARROW_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  unsigned int nrOfInts = dstCapacity / 8;
+  unsigned int width = static_cast<unsigned char>(src[0]);
+  unsigned int narrowSize = width * nrOfInts;
+
+  if ((width != 1 && width != 2 && width != 4 && width != 8) || compressedSize < NARROW_HEADER_SIZE) return 1;
+
+  ScratchBuffer scratch(SCRATCH_CODEC, narrowSize);
+  char* buf = scratch.Data();
+  unsigned int errorCode = ZSTD_decompress(buf, narrowSize, &src[NARROW_HEADER_SIZE], compressedSize - NARROW_HEADER_SIZE)
+    != narrowSize;
+
+  WidenDeshuffleInt64(dst, buf, nrOfInts, width);
+
+  return errorCode;
+}
+
+
+// INT_DOUBLE
+
+unsigned int INT_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  return DecimalCompressDouble(dst, dstCapacity, reinterpret_cast<const double*>(src), srcSize / 8, compressionLevel, NARROW_INT64_C, 0);
+}
+
+unsigned int INT_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return DecimalDecompressDouble(reinterpret_cast<double*>(dst), src, compressedSize, dstCapacity / 8, NARROW_INT64_D);
+}
+
+
+// LZ4_INT_DOUBLE
+
+unsigned int LZ4_INT_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  return DecimalCompressDouble(dst, dstCapacity, reinterpret_cast<const double*>(src), srcSize / 8, compressionLevel, LZ4_NARROW_INT64_C, 0);
+}
+
+unsigned int LZ4_INT_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return DecimalDecompressDouble(reinterpret_cast<double*>(dst), src, compressedSize, dstCapacity / 8, LZ4_NARROW_INT64_D);
+}
+
+
+// ZSTD_INT_DOUBLE
+
+unsigned int ZSTD_INT_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
+{
+  return DecimalCompressDouble(dst, dstCapacity, reinterpret_cast<const double*>(src), srcSize / 8, compressionLevel, ZSTD_NARROW_INT64_C, 0);
+}
+
+unsigned int ZSTD_INT_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return DecimalDecompressDouble(reinterpret_cast<double*>(dst), src, compressedSize, dstCapacity / 8, ZSTD_NARROW_INT64_D);
+}
+
 
 inline void smallmemcpy(char* dst, const char* src, int size)
 {
@@ -34,14 +34,24 @@ size_t MAX_compressBound(size_t srcSize);
 void ShuffleReal(double* inVec, double* outVec, int nrOfDoubles);
 
 
-void DeshuffleReal(double* inVec, double* outVec, int nrOfDoubles);
+// Output vector outVec can have any alignment
+void DeshuffleReal(const double* inVec, char* outVec, int nrOfDoubles);
+
+
+// Deshuffle only elements [rangeStart, rangeStart + rangeLength) of the nrOfDoubles shuffled doubles into outVec
+void DeshuffleRealRange(const double* inVec, char* outVec, int nrOfDoubles, int rangeStart, int rangeLength);
 
 
 // The size of outVec must be equal to nrOfInts
 void ShuffleInt2(int* inVec, int* outVec, int nrOfInts);
 
 
-void DeshuffleInt2(int* inVec, int* outVec, int nrOfInts);
+// Output vector outVec can have any alignment
+void DeshuffleInt2(const int* inVec, char* outVec, int nrOfInts);
+
+
+// Deshuffle only elements [rangeStart, rangeStart + rangeLength) of the nrOfInts shuffled integers into outVec
+void DeshuffleInt2Range(const int* inVec, char* outVec, int nrOfInts, int rangeStart, int rangeLength);
 
 
 // The first nrOfDiscard decompressed logicals are discarded. Parameter nrOfLogicals includes these discarded values,
@@ -76,6 +86,12 @@ typedef unsigned int (*CompAlgorithm)(char* dst, unsigned int dstCapacity, const
 typedef unsigned int (*DecompAlgorithm)(char* dst, unsigned int dstCapacity, const char* src, unsigned int  compressedSize);
 
 
+// Function pointer to partial decompression algorithm. Only bytes [rangeStart, rangeStart + rangeSize) of a block
+// with dstCapacity decompressed bytes are written to dst.
+typedef unsigned int (*DecompRangeAlgorithm)(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize);
+
+
 // UNCOMPRESS,
 
 unsigned int NoCompression(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
@@ -92,6 +108,10 @@ unsigned int LZ4_C(char* dst, unsigned int dstCapacity, const char* src,  unsign
 unsigned int LZ4_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
 
 
+unsigned int LZ4_D_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize);
+
+
 unsigned int LZ4_INT_TO_BYTE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
 
 
@@ -138,6 +158,10 @@ unsigned int LOGIC64_C(char* dst, unsigned int dstCapacity, const char* src,  un
 unsigned int LOGIC64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
 
 
+unsigned int LOGIC64_D_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize);
+
+
 // LZ4_LOGIC64
 
 // Buffer src should contain an integer vector (with logicals)
@@ -148,6 +172,10 @@ unsigned int LZ4_LOGIC64_C(char* dst, unsigned int dstCapacity, const char* src,
 unsigned int LZ4_LOGIC64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
 
 
+unsigned int LZ4_LOGIC64_D_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize);
+
+
 // ZSTD_LOGIC64
 
 // Buffer src should contain an integer vector (with logicals)
@@ -168,6 +196,10 @@ unsigned int LZ4_C_SHUF4(char* dst, unsigned int dstCapacity, const char* src,
 unsigned int LZ4_D_SHUF4(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
 
 
+unsigned int LZ4_D_SHUF4_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize);
+
+
 // LZ4_SHUF8,
 
 // Buffer src should contain an integer vector
@@ -178,6 +210,10 @@ unsigned int LZ4_C_SHUF8(char* dst, unsigned int dstCapacity, const char* src,
 unsigned int LZ4_D_SHUF8(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
 
 
+unsigned int LZ4_D_SHUF8_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize);
+
+
 // ZSTD_SHUF8
 
 unsigned int ZSTD_C_SHUF8(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
@@ -186,6 +222,10 @@ unsigned int ZSTD_C_SHUF8(char* dst, unsigned int dstCapacity, const char* src,
 unsigned int ZSTD_D_SHUF8(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
 
 
+unsigned int ZSTD_D_SHUF8_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize);
+
+
 // ZSTD,
 
 unsigned int ZSTD_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
@@ -194,6 +234,11 @@ unsigned int ZSTD_C(char* dst, unsigned int dstCapacity, const char* src,  unsig
 unsigned int ZSTD_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
 
 
+// Train a ZSTD dictionary on nrOfSamples consecutive samples. Returns the dictionary size or zero if training failed.
+unsigned int ZSTD_TrainDictionary(char* dict, unsigned int dictCapacity, const char* samples, const size_t* sampleSizes,
+  unsigned int nrOfSamples);
+
+
 // ZSTD_SHUF4,
 
 unsigned int ZSTD_C_SHUF4(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
@@ -202,4 +247,201 @@ unsigned int ZSTD_C_SHUF4(char* dst, unsigned int dstCapacity, const char* src,
 unsigned int ZSTD_D_SHUF4(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
 
 
+unsigned int ZSTD_D_SHUF4_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize);
+
+
+// FOR_INT
+
+// Frame-of-reference bit-packing of an integer vector
+// srcSize must be a multiple of 4
+unsigned int FOR_INT_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int FOR_INT_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+unsigned int FOR_INT_D_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize);
+
+
+// LZ4_FOR_INT
+
+// Frame-of-reference bit-packing followed by LZ4 compression of the packed codes
+unsigned int LZ4_FOR_INT_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int LZ4_FOR_INT_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+unsigned int LZ4_FOR_INT_D_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize);
+
+
+// ZSTD_FOR_INT
+
+unsigned int ZSTD_FOR_INT_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int ZSTD_FOR_INT_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+unsigned int ZSTD_FOR_INT_D_RANGE(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  unsigned int rangeStart, unsigned int rangeSize);
+
+
+// FOR_INT64
+
+// Frame-of-reference bit-packing of an integer64 vector
+// srcSize must be a multiple of 8
+unsigned int FOR_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int FOR_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// LZ4_FOR_INT64
+
+unsigned int LZ4_FOR_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int LZ4_FOR_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// ZSTD_FOR_INT64
+
+unsigned int ZSTD_FOR_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int ZSTD_FOR_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// XOR_DOUBLE
+
+// XOR based compression of a double vector
+// srcSize must be a multiple of 8
+unsigned int XOR_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int XOR_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// DEC_DOUBLE
+
+// Decimal-scaled doubles stored as frame-of-reference bit-packed integers
+// srcSize must be a multiple of 8
+unsigned int DEC_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int DEC_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// LZ4_DEC_DOUBLE
+
+unsigned int LZ4_DEC_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int LZ4_DEC_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// ZSTD_DEC_DOUBLE
+
+unsigned int ZSTD_DEC_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int ZSTD_DEC_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// RLE_INT
+
+// Run-length encoding of an integer vector
+// srcSize must be a multiple of 4
+unsigned int RLE_INT_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int RLE_INT_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// CONSTANT
+
+// Blocks with a single repeated value of 1, 2, 4 or 8 bytes
+unsigned int CONSTANT_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int CONSTANT_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// SPARSE_INT
+
+// Background value and exceptions of an integer vector
+// srcSize must be a multiple of 4
+unsigned int SPARSE_INT_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int SPARSE_INT_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// SPARSE_INT64
+
+// Background value and exceptions of a vector with 8 byte elements (integer64 or double)
+// srcSize must be a multiple of 8
+unsigned int SPARSE_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int SPARSE_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// NARROW_INT64
+
+// Integer64 vector stored with 1, 2 or 4 bytes per element when all values fit
+// srcSize must be a multiple of 8
+unsigned int NARROW_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int NARROW_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// LZ4_NARROW_INT64
+
+// Narrowed and byte shuffled integer64 vector, blocks that can't be narrowed are byte shuffled only
+unsigned int LZ4_NARROW_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int LZ4_NARROW_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// ZSTD_NARROW_INT64
+
+unsigned int ZSTD_NARROW_INT64_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int ZSTD_NARROW_INT64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// INT_DOUBLE
+
+// Double vector with whole numbers only, stored as a narrowed integer64 vector. Other blocks are stored unpacked
+// srcSize must be a multiple of 8
+unsigned int INT_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int INT_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// LZ4_INT_DOUBLE
+
+unsigned int LZ4_INT_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int LZ4_INT_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
+// ZSTD_INT_DOUBLE
+
+unsigned int ZSTD_INT_DOUBLE_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel);
+
+
+unsigned int ZSTD_INT_DOUBLE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+
 #endif  // COMPRESSION_H
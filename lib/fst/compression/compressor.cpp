@@ -22,11 +22,23 @@
 */
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <cstring>
+#include <cmath>
+#include <memory>
+#include <vector>
 
 #include <compression/compressor.h>
 #include <compression/compression.h>
+#include <compression/bitpacking.h>
+#include <compression/xordouble.h>
+#include <compression/decimaldouble.h>
+#include <compression/runlength.h>
+#include <compression/sparse.h>
+#include <compression/narrowint64.h>
+#include <compression/scratchbuffer.h>
+#include <interface/openmphelper.h>
 
 #define LZ4_DISABLE_DEPRECATE_WARNINGS  // required for Clang++6.0 compiler error
 #include <lz4.h>
@@ -52,7 +64,27 @@ CompAlgorithm compAlgorithms[NR_OF_ALGORITHMS] = {  // all current and historic
   INT_TO_BYTE_C,
   INT_TO_SHORT_C,
   ZSTD_INT_TO_BYTE_C,
-  ZSTD_INT_TO_SHORT_SHUF2_C
+  ZSTD_INT_TO_SHORT_SHUF2_C,
+  FOR_INT_C,
+  LZ4_FOR_INT_C,
+  ZSTD_FOR_INT_C,
+  FOR_INT64_C,
+  LZ4_FOR_INT64_C,
+  ZSTD_FOR_INT64_C,
+  XOR_DOUBLE_C,
+  DEC_DOUBLE_C,
+  LZ4_DEC_DOUBLE_C,
+  ZSTD_DEC_DOUBLE_C,
+  RLE_INT_C,
+  CONSTANT_C,
+  SPARSE_INT_C,
+  SPARSE_INT64_C,
+  NARROW_INT64_C,
+  LZ4_NARROW_INT64_C,
+  ZSTD_NARROW_INT64_C,
+  INT_DOUBLE_C,
+  LZ4_INT_DOUBLE_C,
+  ZSTD_INT_DOUBLE_C
 };
 
 
@@ -72,7 +104,68 @@ DecompAlgorithm decompAlgorithms[NR_OF_ALGORITHMS] = {  // all current and histo
   INT_TO_BYTE_D,
   INT_TO_SHORT_D,
   ZSTD_INT_TO_BYTE_D,
-  ZSTD_INT_TO_SHORT_SHUF2_D
+  ZSTD_INT_TO_SHORT_SHUF2_D,
+  FOR_INT_D,
+  LZ4_FOR_INT_D,
+  ZSTD_FOR_INT_D,
+  FOR_INT64_D,
+  LZ4_FOR_INT64_D,
+  ZSTD_FOR_INT64_D,
+  XOR_DOUBLE_D,
+  DEC_DOUBLE_D,
+  LZ4_DEC_DOUBLE_D,
+  ZSTD_DEC_DOUBLE_D,
+  RLE_INT_D,
+  CONSTANT_D,
+  SPARSE_INT_D,
+  SPARSE_INT64_D,
+  NARROW_INT64_D,
+  LZ4_NARROW_INT64_D,
+  ZSTD_NARROW_INT64_D,
+  INT_DOUBLE_D,
+  LZ4_INT_DOUBLE_D,
+  ZSTD_INT_DOUBLE_D
+};
+
+
+// Partial decompression of a byte range, nullptr for algorithms that can only decompress full blocks
+DecompRangeAlgorithm decompRangeAlgorithms[NR_OF_ALGORITHMS] = {
+  nullptr,
+  LZ4_D_RANGE,
+  LZ4_D_SHUF4_RANGE,
+  nullptr,
+  ZSTD_D_SHUF4_RANGE,
+  LZ4_D_SHUF8_RANGE,
+  ZSTD_D_SHUF8_RANGE,
+  LZ4_LOGIC64_D_RANGE,
+  LOGIC64_D_RANGE,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  FOR_INT_D_RANGE,
+  LZ4_FOR_INT_D_RANGE,
+  ZSTD_FOR_INT_D_RANGE,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr,
+  nullptr
 };
 
 
@@ -92,7 +185,27 @@ CompAlgoType algorithmType[NR_OF_ALGORITHMS] = {  // type of algorithm
   CompAlgoType::INT_TO_BYTE_TYPE,
   CompAlgoType::INT_TO_SHORT_TYPE,
   CompAlgoType::ZSTD_INT_TO_BYTE_TYPE,
-  CompAlgoType::ZSTD_INT_TO_SHORT_TYPE
+  CompAlgoType::ZSTD_INT_TO_SHORT_TYPE,
+  CompAlgoType::FOR_INT_TYPE,
+  CompAlgoType::LZ4_FOR_INT_TYPE,
+  CompAlgoType::ZSTD_FOR_INT_TYPE,
+  CompAlgoType::FOR_INT64_TYPE,
+  CompAlgoType::LZ4_FOR_INT64_TYPE,
+  CompAlgoType::ZSTD_FOR_INT64_TYPE,
+  CompAlgoType::XOR_DOUBLE_TYPE,
+  CompAlgoType::DEC_DOUBLE_TYPE,
+  CompAlgoType::LZ4_DEC_DOUBLE_TYPE,
+  CompAlgoType::ZSTD_DEC_DOUBLE_TYPE,
+  CompAlgoType::RLE_INT_TYPE,
+  CompAlgoType::CONSTANT_TYPE,
+  CompAlgoType::SPARSE_TYPE,
+  CompAlgoType::SPARSE_TYPE,
+  CompAlgoType::NARROW_INT64_TYPE,
+  CompAlgoType::LZ4_NARROW_INT64_TYPE,
+  CompAlgoType::ZSTD_NARROW_INT64_TYPE,
+  CompAlgoType::INT_DOUBLE_TYPE,
+  CompAlgoType::LZ4_INT_DOUBLE_TYPE,
+  CompAlgoType::ZSTD_INT_DOUBLE_TYPE
 };
 
 
@@ -113,6 +226,26 @@ unsigned int fixedRatioSourceRepSize[NR_OF_ALGORITHMS] = {  // all current and h
   32,
   16,
   0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
   0
 };
 
@@ -134,6 +267,26 @@ unsigned int fixedRatioTargetRepSize[NR_OF_ALGORITHMS] = {  // all current and h
   8,
   8,
   0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
+  0,
   0
 };
 
@@ -228,6 +381,134 @@ inline int MaxCompressSize(int blockSize, CompAlgoType algoType)
       compBufSize = 8 * nrOfLongs;
       break;
     }
+
+    case CompAlgoType::FOR_INT_TYPE:
+    {
+      int nrOfInts = (blockSize + 3) / 4;  // safely round upwards
+      compBufSize = FOR_HEADER_SIZE_INT + BitPackedSize(nrOfInts, 32);  // header and 32 bit codes at most
+      break;
+    }
+
+    case CompAlgoType::LZ4_FOR_INT_TYPE:
+    {
+      int nrOfInts = (blockSize + 3) / 4;  // safely round upwards
+      compBufSize = FOR_HEADER_SIZE_INT + LZ4_COMPRESSBOUND(BitPackedSize(nrOfInts, 32));  // uncompressed header
+      break;
+    }
+
+    case CompAlgoType::ZSTD_FOR_INT_TYPE:
+    {
+      int nrOfInts = (blockSize + 3) / 4;  // safely round upwards
+      compBufSize = FOR_HEADER_SIZE_INT + ZSTD_compressBound(BitPackedSize(nrOfInts, 32));  // uncompressed header
+      break;
+    }
+
+    case CompAlgoType::FOR_INT64_TYPE:
+    {
+      int nrOfInts = (blockSize + 7) / 8;  // safely round upwards
+      compBufSize = FOR_HEADER_SIZE_INT64 + max(8 * nrOfInts, static_cast<int>(BitPackedSize(nrOfInts, 32)));  // raw or packed
+      break;
+    }
+
+    case CompAlgoType::LZ4_FOR_INT64_TYPE:
+    {
+      int nrOfInts = (blockSize + 7) / 8;  // safely round upwards
+      compBufSize = FOR_HEADER_SIZE_INT64 + LZ4_COMPRESSBOUND(max(8 * nrOfInts, static_cast<int>(BitPackedSize(nrOfInts, 32))));
+      break;
+    }
+
+    case CompAlgoType::ZSTD_FOR_INT64_TYPE:
+    {
+      int nrOfInts = (blockSize + 7) / 8;  // safely round upwards
+      compBufSize = FOR_HEADER_SIZE_INT64 + ZSTD_compressBound(max(8 * nrOfInts, static_cast<int>(BitPackedSize(nrOfInts, 32))));
+      break;
+    }
+
+    case CompAlgoType::XOR_DOUBLE_TYPE:
+    {
+      int nrOfDoubles = (blockSize + 7) / 8;  // safely round upwards
+      compBufSize = XOR_HEADER_SIZE + 8 * nrOfDoubles;  // incompressible blocks are stored unpacked
+      break;
+    }
+
+    case CompAlgoType::DEC_DOUBLE_TYPE:
+    {
+      int nrOfDoubles = (blockSize + 7) / 8;  // safely round upwards
+      compBufSize = DEC_HEADER_SIZE + max(8 * nrOfDoubles, MaxCompressSize(blockSize, CompAlgoType::FOR_INT64_TYPE));
+      break;
+    }
+
+    case CompAlgoType::LZ4_DEC_DOUBLE_TYPE:
+    {
+      int nrOfDoubles = (blockSize + 7) / 8;  // safely round upwards
+      compBufSize = DEC_HEADER_SIZE + max(8 * nrOfDoubles, MaxCompressSize(blockSize, CompAlgoType::LZ4_FOR_INT64_TYPE));
+      break;
+    }
+
+    case CompAlgoType::ZSTD_DEC_DOUBLE_TYPE:
+    {
+      int nrOfDoubles = (blockSize + 7) / 8;  // safely round upwards
+      compBufSize = DEC_HEADER_SIZE + max(8 * nrOfDoubles, MaxCompressSize(blockSize, CompAlgoType::ZSTD_FOR_INT64_TYPE));
+      break;
+    }
+
+    case CompAlgoType::RLE_INT_TYPE:
+    {
+      int nrOfInts = (blockSize + 3) / 4;  // safely round upwards
+      compBufSize = RLE_HEADER_SIZE + 4 * nrOfInts;  // blocks with many runs are stored unpacked
+      break;
+    }
+
+    case CompAlgoType::CONSTANT_TYPE:
+    {
+      compBufSize = CONST_HEADER_SIZE + blockSize;  // non-constant blocks are stored unpacked
+      break;
+    }
+
+    case CompAlgoType::SPARSE_TYPE:
+    {
+      compBufSize = SPARSE_HEADER_SIZE + blockSize;  // dense blocks are stored unpacked
+      break;
+    }
+
+    case CompAlgoType::NARROW_INT64_TYPE:
+    {
+      compBufSize = NARROW_HEADER_SIZE + blockSize;  // wide blocks are stored unpacked
+      break;
+    }
+
+    case CompAlgoType::LZ4_NARROW_INT64_TYPE:
+    {
+      compBufSize = NARROW_HEADER_SIZE + LZ4_COMPRESSBOUND(blockSize);  // wide blocks are shuffled only
+      break;
+    }
+
+    case CompAlgoType::ZSTD_NARROW_INT64_TYPE:
+    {
+      compBufSize = NARROW_HEADER_SIZE + ZSTD_compressBound(blockSize);  // wide blocks are shuffled only
+      break;
+    }
+
+    case CompAlgoType::INT_DOUBLE_TYPE:
+    {
+      int nrOfDoubles = (blockSize + 7) / 8;  // safely round upwards
+      compBufSize = DEC_HEADER_SIZE + max(8 * nrOfDoubles, MaxCompressSize(blockSize, CompAlgoType::NARROW_INT64_TYPE));
+      break;
+    }
+
+    case CompAlgoType::LZ4_INT_DOUBLE_TYPE:
+    {
+      int nrOfDoubles = (blockSize + 7) / 8;  // safely round upwards
+      compBufSize = DEC_HEADER_SIZE + max(8 * nrOfDoubles, MaxCompressSize(blockSize, CompAlgoType::LZ4_NARROW_INT64_TYPE));
+      break;
+    }
+
+    case CompAlgoType::ZSTD_INT_DOUBLE_TYPE:
+    {
+      int nrOfDoubles = (blockSize + 7) / 8;  // safely round upwards
+      compBufSize = DEC_HEADER_SIZE + max(8 * nrOfDoubles, MaxCompressSize(blockSize, CompAlgoType::ZSTD_NARROW_INT64_TYPE));
+      break;
+    }
   }
 
   return compBufSize;
@@ -241,6 +522,30 @@ int Decompressor::Decompress(unsigned int algo, char* dst, unsigned int dstCapac
 }
 
 
+int Decompressor::DecompressRange(unsigned int algo, char* dst, unsigned int dstCapacity, const char* src,
+  unsigned int compressedSize, unsigned int rangeStart, unsigned int rangeSize)
+{
+  if (rangeStart == 0 && rangeSize == dstCapacity)
+  {
+    return Decompress(algo, dst, dstCapacity, src, compressedSize);
+  }
+
+  DecompRangeAlgorithm decompRangeAlgorithm = decompRangeAlgorithms[algo];
+  if (decompRangeAlgorithm != nullptr)
+  {
+    return decompRangeAlgorithm(dst, dstCapacity, src, compressedSize, rangeStart, rangeSize);
+  }
+
+  // decompress full block in staging buffer
+  ScratchBuffer scratch(SCRATCH_STREAM_BLOCK, dstCapacity);
+  char* blockBuf = scratch.Data();
+  int errorCode = Decompress(algo, blockBuf, dstCapacity, src, compressedSize);
+  memcpy(dst, &blockBuf[rangeStart], rangeSize);
+
+  return errorCode;
+}
+
+
 FixedRatioCompressor::FixedRatioCompressor(CompAlgo algo)
 {
   this->algo = algo;
@@ -264,6 +569,30 @@ int FixedRatioCompressor::Compress(char* dst, unsigned int dstCapacity, const ch
 }
 
 
+// ZSTD based algorithms are trial-compressed at a fast level, the level of other algorithms has little effect on speed
+inline int TrialLevel(CompAlgo algo, int compressionLevel)
+{
+  switch (algo)
+  {
+    case CompAlgo::ZSTD:
+    case CompAlgo::ZSTD_SHUF4:
+    case CompAlgo::ZSTD_SHUF8:
+    case CompAlgo::ZSTD_LOGIC64:
+    case CompAlgo::ZSTD_INT_TO_BYTE:
+    case CompAlgo::ZSTD_INT_TO_SHORT_SHUF2:
+    case CompAlgo::ZSTD_FOR_INT:
+    case CompAlgo::ZSTD_FOR_INT64:
+    case CompAlgo::ZSTD_DEC_DOUBLE:
+    case CompAlgo::ZSTD_NARROW_INT64:
+    case CompAlgo::ZSTD_INT_DOUBLE:
+      return ADAPTIVE_TRIAL_LEVEL;
+
+    default:
+      return compressionLevel;
+  }
+}
+
+
 SingleCompressor::SingleCompressor(CompAlgo algo1, int compressionLevel)
 {
   this->algo1 = algo1;
@@ -282,15 +611,16 @@ int SingleCompressor::Compress(char* dst, unsigned int dstCapacity, const char*
   return a1(dst, dstCapacity, src, srcSize, compLevel);
 }
 
+int SingleCompressor::TrialCompress(char* dst, unsigned int dstCapacity, const char* sample, unsigned int sampleSize,
+  const char* src, unsigned int srcSize, CompAlgo &compAlgorithm)
+{
+  compAlgorithm = algo1;
+  return a1(dst, dstCapacity, sample, sampleSize, TrialLevel(algo1, compLevel));
+}
+
 
 DualCompressor::DualCompressor(CompAlgo algo1, CompAlgo algo2, int compressionLevel1, int compressionLevel2)
 {
-  lastCount = 0;
-  a1Count = 0.0;
-  a1Ratio = 50;
-  lastSize1 = 0;
-  lastSize2 = 0;
-
   this->algo1 = algo1;
   this->algo2 = algo2;
   this->compLevel1 = compressionLevel1;
@@ -298,6 +628,20 @@ DualCompressor::DualCompressor(CompAlgo algo1, CompAlgo algo2, int compressionLe
 
   a1 = compAlgorithms[static_cast<int>(algo1)];
   a2 = compAlgorithms[static_cast<int>(algo2)];
+
+  // one state per thread, threads beyond the current thread count share a state
+  nrOfStates = GetFstThreads();
+  states = std::unique_ptr<DualCompressorState[]>(new DualCompressorState[nrOfStates]);
+  sharedRatio = 50;
+
+  for (int state = 0; state < nrOfStates; ++state)
+  {
+    states[state].credit = 0;
+    states[state].a1Ratio = 50;
+    states[state].lastSize1 = 0;
+    states[state].lastSize2 = 0;
+    states[state].blockCount = 0;
+  }
 }
 
 int DualCompressor::CompressBufferSize(int maxBlockSize)
@@ -309,67 +653,420 @@ int DualCompressor::CompressBufferSize(int maxBlockSize)
 
 int DualCompressor::Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm)
 {
-	int lastCountLocal;
-	float a1CountLocal;
-	int a1RatioLocal;
-	int lastSize1Local;
-	int lastSize2Local;
-
-	#pragma omp critical
-	{
-		lastCountLocal = lastCount;
-		a1CountLocal = a1Count;
-		a1RatioLocal = a1Ratio;
-		lastSize1Local = lastSize1;
-		lastSize2Local = lastSize2;
-	}
+  // relaxed atomics: the state is (nearly always) owned by a single thread, so this compiles to plain loads and stores
+  DualCompressorState& state = states[CurrentFstThread() % nrOfStates];
 
-  a1CountLocal += (a1RatioLocal / 100.0);  // check for use of algorithm 1
+  int a1Ratio = state.a1Ratio.load(std::memory_order_relaxed);
+  int lastSize1 = state.lastSize1.load(std::memory_order_relaxed);
+  int lastSize2 = state.lastSize2.load(std::memory_order_relaxed);
+  int credit = state.credit.load(std::memory_order_relaxed) + a1Ratio;  // check for use of algorithm 1
+  int compSize;
 
-  if (a1CountLocal > lastCountLocal)
+  if (credit > 0)
   {
-    ++lastCountLocal;
+    credit -= 100;
     compAlgorithm = algo1;
-    lastSize1Local = a1(dst, dstCapacity, src,  srcSize, compLevel1);
+    compSize = lastSize1 = a1(dst, dstCapacity, src,  srcSize, compLevel1);
+    state.lastSize1.store(lastSize1, std::memory_order_relaxed);
+  }
+  else
+  {
+    compAlgorithm = algo2;
+    compSize = lastSize2 = a2(dst, dstCapacity, src,  srcSize, compLevel2);
+    state.lastSize2.store(lastSize2, std::memory_order_relaxed);
+  }
+
+  if (lastSize2 > lastSize1)
+  {
+    a1Ratio = min(95, a1Ratio + 5);
+  }
+  else
+  {
+    a1Ratio = max(5, a1Ratio - 5);
+  }
+
+  // merge with the statistics of the other threads at batch boundaries
+  int blockCount = state.blockCount.load(std::memory_order_relaxed) + 1;
+  if (blockCount == DUAL_MERGE_BLOCKS)
+  {
+    blockCount = 0;
+    a1Ratio = (sharedRatio.load(std::memory_order_relaxed) + a1Ratio) / 2;
+    sharedRatio.store(a1Ratio, std::memory_order_relaxed);
+  }
+
+  state.credit.store(credit, std::memory_order_relaxed);
+  state.a1Ratio.store(a1Ratio, std::memory_order_relaxed);
+  state.blockCount.store(blockCount, std::memory_order_relaxed);
+
+  return compSize;
+}
+
+
+DecimalDoubleCompressor::DecimalDoubleCompressor(Compressor* compressor, CompAlgo decimalAlgo, int compressionLevel)
+{
+  compress = compressor;
+  algo1 = decimalAlgo;
+  compLevel = compressionLevel;
+  a1 = compAlgorithms[static_cast<int>(decimalAlgo)];
+}
+
+int DecimalDoubleCompressor::CompressBufferSize(int maxBlockSize)
+{
+  int size1 = MaxCompressSize(maxBlockSize, algorithmType[static_cast<int>(algo1)]);
+  int size2 = compress->CompressBufferSize(maxBlockSize);
+  return max(size1, size2);
+}
+
+int DecimalDoubleCompressor::Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm)
+{
+  // most non-decimal blocks are rejected at the first value
+  if (DecimalScaleDouble(reinterpret_cast<const double*>(src), srcSize / 8) < 0)
+  {
+    return compress->Compress(dst, dstCapacity, src, srcSize, compAlgorithm);
+  }
+
+  // the codec stores blocks that fail the integer conversion (such as NaN's with different payloads) as-is
+  int compSize = a1(dst, dstCapacity, src, srcSize, compLevel);
+  if (dst[0] == DEC_MODE_RAW) return compress->Compress(dst, dstCapacity, src, srcSize, compAlgorithm);
+
+  compAlgorithm = algo1;
+  return compSize;
+}
+
+int DecimalDoubleCompressor::TrialCompress(char* dst, unsigned int dstCapacity, const char* sample, unsigned int sampleSize,
+  const char* src, unsigned int srcSize, CompAlgo &compAlgorithm)
+{
+  if (DecimalScaleDouble(reinterpret_cast<const double*>(sample), sampleSize / 8) < 0)
+  {
+    return compress->TrialCompress(dst, dstCapacity, sample, sampleSize, src, srcSize, compAlgorithm);
+  }
+
+  int compSize = a1(dst, dstCapacity, sample, sampleSize, TrialLevel(algo1, compLevel));
+  if (dst[0] == DEC_MODE_RAW) return compress->TrialCompress(dst, dstCapacity, sample, sampleSize, src, srcSize, compAlgorithm);
+
+  compAlgorithm = algo1;
+  return compSize;
+}
+
+
+IntegralDoubleCompressor::IntegralDoubleCompressor(Compressor* compressor, CompAlgo integralAlgo, int compressionLevel)
+{
+  compress = compressor;
+  algo1 = integralAlgo;
+  compLevel = compressionLevel;
+  a1 = compAlgorithms[static_cast<int>(integralAlgo)];
+}
+
+int IntegralDoubleCompressor::CompressBufferSize(int maxBlockSize)
+{
+  int size1 = MaxCompressSize(maxBlockSize, algorithmType[static_cast<int>(algo1)]);
+  int size2 = compress->CompressBufferSize(maxBlockSize);
+  return max(size1, size2);
+}
+
+int IntegralDoubleCompressor::Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm)
+{
+  // blocks with fractional values are rejected at the first such value
+  if (DecimalScaleDouble(reinterpret_cast<const double*>(src), srcSize / 8, 0) != 0)
+  {
+    return compress->Compress(dst, dstCapacity, src, srcSize, compAlgorithm);
+  }
+
+  // the codec stores blocks that fail the integer conversion (such as NaN's with different payloads) as-is
+  int compSize = a1(dst, dstCapacity, src, srcSize, compLevel);
+  if (dst[0] == DEC_MODE_RAW) return compress->Compress(dst, dstCapacity, src, srcSize, compAlgorithm);
+
+  compAlgorithm = algo1;
+  return compSize;
+}
+
+int IntegralDoubleCompressor::TrialCompress(char* dst, unsigned int dstCapacity, const char* sample, unsigned int sampleSize,
+  const char* src, unsigned int srcSize, CompAlgo &compAlgorithm)
+{
+  if (DecimalScaleDouble(reinterpret_cast<const double*>(sample), sampleSize / 8, 0) != 0)
+  {
+    return compress->TrialCompress(dst, dstCapacity, sample, sampleSize, src, srcSize, compAlgorithm);
+  }
+
+  int compSize = a1(dst, dstCapacity, sample, sampleSize, TrialLevel(algo1, compLevel));
+  if (dst[0] == DEC_MODE_RAW) return compress->TrialCompress(dst, dstCapacity, sample, sampleSize, src, srcSize, compAlgorithm);
+
+  compAlgorithm = algo1;
+  return compSize;
+}
+
+
+// Order-0 entropy in bits per byte of every stride-th byte starting at offset, with a correction for the
+// (downward) bias of small samples
+inline double ByteEntropy(const unsigned char* buf, unsigned int nrOfBytes, unsigned int offset, unsigned int stride)
+{
+  // table of count * log2(count) for all possible counts in a sample
+  static const std::vector<double> countLog = []
+  {
+    std::vector<double> table(ADAPTIVE_SAMPLE_SIZE + 1, 0.0);
+    for (int count = 1; count <= ADAPTIVE_SAMPLE_SIZE; ++count) table[count] = count * log2(count);
+    return table;
+  }();
+
+  unsigned int counts[256] = { 0 };
+  unsigned int total = 0;
+
+  for (unsigned int pos = offset; pos < nrOfBytes; pos += stride)
+  {
+    ++counts[buf[pos]];
+    ++total;
+  }
+
+  if (total == 0) return 0.0;
+
+  double sum = 0.0;
+  int nrOfSymbols = 0;
+  for (unsigned int count : counts)
+  {
+    sum += countLog[count];
+    nrOfSymbols += count > 0;
+  }
+
+  return log2(total) - sum / total + (nrOfSymbols - 1) / (2.0 * total * log(2.0));
+}
 
-    if (lastSize2Local > lastSize1Local)
+
+AdaptiveCompressor::AdaptiveCompressor(Compressor** candidates, int nrOfCandidates, int elementSize, int compressionLevel)
+{
+  compressors = candidates;
+  nrOfCompressors = nrOfCandidates;
+  elemSize = elementSize;
+  speedWeight = static_cast<float>(ADAPTIVE_SPEED_WEIGHT * (100 - compressionLevel) / 100.0);
+}
+
+int AdaptiveCompressor::CompressBufferSize(int maxBlockSize)
+{
+  int bufSize = maxBlockSize;  // uncompressed blocks
+
+  for (int candidate = 0; candidate < nrOfCompressors; ++candidate)
+  {
+    bufSize = max(bufSize, compressors[candidate]->CompressBufferSize(maxBlockSize));
+  }
+
+  return bufSize;
+}
+
+int AdaptiveCompressor::Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm)
+{
+  // sample evenly spread slices of the block, aligned to whole elements
+  char sample[ADAPTIVE_SAMPLE_SIZE];
+  unsigned int sampleSize = srcSize;
+  const char* sampleP = src;
+
+  if (srcSize > ADAPTIVE_SAMPLE_SIZE)
+  {
+    unsigned int sliceSize = ADAPTIVE_SAMPLE_SIZE / ADAPTIVE_SAMPLE_SLICES;
+    unsigned int sliceStep = ((srcSize - sliceSize) / (ADAPTIVE_SAMPLE_SLICES - 1)) / 8 * 8;
+
+    for (int slice = 0; slice < ADAPTIVE_SAMPLE_SLICES; ++slice)
     {
-      a1RatioLocal = min(95, a1RatioLocal + 5);
+      memcpy(&sample[slice * sliceSize], &src[slice * sliceStep], sliceSize);
     }
-    else
+
+    sampleSize = ADAPTIVE_SAMPLE_SIZE;
+    sampleP = sample;
+  }
+
+  // entropy of all bytes and average entropy per byte position within an element (as seen by shuffle codecs)
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(sampleP);
+  bool compressible = ByteEntropy(bytes, sampleSize, 0, 1) <= ADAPTIVE_MAX_ENTROPY;
+
+  if (!compressible && elemSize > 1)
+  {
+    double laneEntropy = 0.0;
+    for (int lane = 0; lane < elemSize; ++lane) laneEntropy += ByteEntropy(bytes, sampleSize, lane, elemSize);
+
+    compressible = laneEntropy / elemSize <= ADAPTIVE_MAX_LANE_ENTROPY;
+  }
+
+  int selected = -1;
+
+  // trial compression of the sample for compressible blocks
+  if (compressible)
+  {
+    int trialBufSize = CompressBufferSize(srcSize);  // candidates can trial-compress the full block
+    ScratchBuffer scratch(SCRATCH_ADAPTIVE, trialBufSize);
+    char* trialBuf = scratch.Data();
+
+    double bestSize = ADAPTIVE_MIN_GAIN * sampleSize;
+
+    for (int candidate = 0; candidate < nrOfCompressors; ++candidate)
     {
-      a1RatioLocal = max(5, a1RatioLocal - 5);
+      CompAlgo trialAlgo;
+      int trialSize = compressors[candidate]->TrialCompress(trialBuf, trialBufSize, sampleP, sampleSize, src, srcSize, trialAlgo);
+      double weightedSize = trialSize * (1.0 + candidate * speedWeight);
+
+      if (weightedSize < bestSize)
+      {
+        bestSize = weightedSize;
+        selected = candidate;
+      }
     }
+  }
 
-	#pragma omp critical (criticalcompression)
-	{
-		lastCount = lastCountLocal;
-		a1Ratio = a1RatioLocal;
-		lastSize1 = lastSize1Local;
-	}
+  if (selected >= 0)
+  {
+    int compSize = compressors[selected]->Compress(dst, dstCapacity, src, srcSize, compAlgorithm);
+    if (compSize < static_cast<int>(srcSize)) return compSize;
+  }
+
+  // incompressible block
+  compAlgorithm = CompAlgo::UNCOMPRESS;
+  memcpy(dst, src, srcSize);
+
+  return srcSize;
+}
+
+
+RunLengthCompressor::RunLengthCompressor(Compressor* compressor, int minRunLength)
+{
+  compress = compressor;
+  minRun = minRunLength;
+}
+
+int RunLengthCompressor::CompressBufferSize(int maxBlockSize)
+{
+  int size1 = MaxCompressSize(maxBlockSize, CompAlgoType::RLE_INT_TYPE);
+  int size2 = compress->CompressBufferSize(maxBlockSize);
+  return max(size1, size2);
+}
+
+int RunLengthCompressor::Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm)
+{
+  unsigned int nrOfInts = srcSize / 4;
+  unsigned int maxRuns = nrOfInts / minRun;
+
+  // counting stops as soon as the block has too many runs
+  unsigned int nrOfRuns = RunCountInt(reinterpret_cast<const int*>(src), nrOfInts, maxRuns);
+  int compSize = compress->Compress(dst, dstCapacity, src, srcSize, compAlgorithm);
+
+  // runs are stored unpacked, so the wrapped compressor can still give a smaller block
+  if (nrOfRuns > maxRuns || compSize <= static_cast<int>(RLE_HEADER_SIZE + 8 * nrOfRuns)) return compSize;
 
-    return lastSize1Local;
+  compAlgorithm = CompAlgo::RLE_INT;
+  return RunLengthCompressInt(dst, reinterpret_cast<const int*>(src), nrOfInts);
+}
+
+int RunLengthCompressor::TrialCompress(char* dst, unsigned int dstCapacity, const char* sample, unsigned int sampleSize,
+  const char* src, unsigned int srcSize, CompAlgo &compAlgorithm)
+{
+  // the slice boundaries of a sample add runs, so the runs are counted in the full block
+  unsigned int nrOfInts = srcSize / 4;
+  unsigned int maxRuns = nrOfInts / minRun;
+
+  unsigned int nrOfRuns = RunCountInt(reinterpret_cast<const int*>(src), nrOfInts, maxRuns);
+  if (nrOfRuns > maxRuns) return compress->TrialCompress(dst, dstCapacity, sample, sampleSize, src, srcSize, compAlgorithm);
+
+  // blocks with long runs compress fast, so both options are sized on the full block and scaled to the sample
+  double compSize = compress->TrialCompress(dst, dstCapacity, src, srcSize, src, srcSize, compAlgorithm);
+  double runSize = RLE_HEADER_SIZE + 8.0 * nrOfRuns;
+
+  if (runSize < compSize)
+  {
+    compAlgorithm = CompAlgo::RLE_INT;
+    compSize = runSize;
   }
 
-  compAlgorithm = algo2;
-  lastSize2Local = a2(dst, dstCapacity, src,  srcSize, compLevel2);
+  return static_cast<int>(compSize * sampleSize / srcSize);
+}
+
+
+ZstdDictCompressor::ZstdDictCompressor(const char* dict, unsigned int dictSize, int compressionLevel)
+{
+  cctx = ZSTD_createCCtx();
+  cdict = ZSTD_createCDict(dict, dictSize, (compressionLevel * ZSTD_maxCLevel()) / 100);
+}
+
+ZstdDictCompressor::~ZstdDictCompressor()
+{
+  ZSTD_freeCDict(cdict);
+  ZSTD_freeCCtx(cctx);
+}
+
+int ZstdDictCompressor::CompressBufferSize(int maxBlockSize)
+{
+  return MaxCompressSize(maxBlockSize, CompAlgoType::ZSTD_TYPE);
+}
+
+int ZstdDictCompressor::Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm)
+{
+  compAlgorithm = CompAlgo::ZSTD;
+  return static_cast<int>(ZSTD_compress_usingCDict(cctx, dst, dstCapacity, src, srcSize, cdict));
+}
+
+
+ZstdDictDecompressor::ZstdDictDecompressor(const char* dict, unsigned int dictSize)
+{
+  dctx = ZSTD_createDCtx();
+  ddict = ZSTD_createDDict(dict, dictSize);
+}
+
+ZstdDictDecompressor::~ZstdDictDecompressor()
+{
+  ZSTD_freeDDict(ddict);
+  ZSTD_freeDCtx(dctx);
+}
+
+int ZstdDictDecompressor::Decompress(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return ZSTD_decompress_usingDDict(dctx, dst, dstCapacity, src, compressedSize, ddict) != dstCapacity;
+}
+
+
+StreamSparseCompressor::StreamSparseCompressor(StreamCompressor* streamCompressor, int elementSize)
+{
+  compress = streamCompressor;
+  elemSize = elementSize;
+}
+
+int StreamSparseCompressor::CompressBufferSize(unsigned int srcSize)
+{
+  int sparseSize = MaxCompressSize(srcSize, CompAlgoType::SPARSE_TYPE);
+  return max(sparseSize, compress->CompressBufferSize(srcSize));
+}
+
+int StreamSparseCompressor::CompressBufferSize()
+{
+  return compress->CompressBufferSize();
+}
 
-  if (lastSize2Local > lastSize1Local)
+int StreamSparseCompressor::Compress(char* src,  unsigned int srcSize, char* compBuf, CompAlgo &compAlgorithm, int blockNr)
+{
+  // all-NA and other constant blocks
+  if (IsConstantBlock(src, srcSize, elemSize))
   {
-    a1RatioLocal = min(95, a1RatioLocal + 5);
+    compAlgorithm = CompAlgo::CONSTANT;
+    return ConstantCompress(compBuf, src, srcSize);
   }
-  else
+
+  unsigned int nrOfElements = srcSize / elemSize;
+  unsigned int maxExceptions = nrOfElements / SPARSE_MIN_RATIO;
+
+  // exception positions are 16-bit, larger blocks use the wrapped compressor
+  if (nrOfElements > SPARSE_MAX_ELEMENTS)
   {
-    a1RatioLocal = max(5, a1RatioLocal - 5);
+    return compress->Compress(src, srcSize, compBuf, compAlgorithm, blockNr);
   }
 
-	#pragma omp critical (criticalcompression)
-	{
-		a1Ratio = a1RatioLocal;
-		lastSize2 = lastSize2Local;
-	}
+  // counting stops as soon as the block has too many exceptions
+  if (elemSize == 4 && SparseExceptionCountInt(reinterpret_cast<int*>(src), nrOfElements, maxExceptions) <= maxExceptions)
+  {
+    compAlgorithm = CompAlgo::SPARSE_INT;
+    return SparseCompressInt(compBuf, reinterpret_cast<int*>(src), nrOfElements);
+  }
+
+  if (elemSize == 8 && SparseExceptionCountInt64(reinterpret_cast<long long*>(src), nrOfElements, maxExceptions) <= maxExceptions)
+  {
+    compAlgorithm = CompAlgo::SPARSE_INT64;
+    return SparseCompressInt64(compBuf, reinterpret_cast<long long*>(src), nrOfElements);
+  }
 
-  return lastSize2Local;
+  return compress->Compress(src, srcSize, compBuf, compAlgorithm, blockNr);
 }
 
 
@@ -437,6 +1134,118 @@ int StreamSingleCompressor::Compress(char* src, unsigned int srcSize, char* comp
 }
 
 
+StreamAutotuneCompressor::StreamAutotuneCompressor(Compressor** candidates, int nrOfCandidates, double writeSpeed, double readSpeed)
+{
+  compressors = candidates;
+  nrOfCompressors = nrOfCandidates;
+  targetWriteSpeed = writeSpeed;
+  targetReadSpeed = readSpeed;
+  selected = -1;
+  compBufSize = 0;
+}
+
+void StreamAutotuneCompressor::Calibrate(const char* vec, unsigned long long vecSize, unsigned int blockSize)
+{
+  selected = -1;
+
+  unsigned long long calibrationSize = min(vecSize, static_cast<unsigned long long>(AUTOTUNE_CALIBRATION_BLOCKS) * blockSize);
+  if (calibrationSize == 0) return;
+
+  int bufSize = static_cast<int>(blockSize);
+  for (int candidate = 0; candidate < nrOfCompressors; ++candidate)
+  {
+    bufSize = max(bufSize, compressors[candidate]->CompressBufferSize(blockSize));
+  }
+
+  std::unique_ptr<char[]> compBufP(new char[bufSize]);
+  std::unique_ptr<char[]> blockBufP(new char[blockSize]);
+  char* compBuf = compBufP.get();
+  char* blockBuf = blockBufP.get();
+
+  // blocks are processed in parallel
+  double nrOfThreads = GetFstThreads();
+  double megaBytes = calibrationSize / 1e6;
+  unsigned long long bestSize = calibrationSize;  // uncompressed
+
+  for (int candidate = 0; candidate < nrOfCompressors; ++candidate)
+  {
+    unsigned long long totCompSize = 0;
+    double compTime = 0.0;
+    double decompTime = 0.0;
+
+    for (unsigned long long pos = 0; pos < calibrationSize; pos += blockSize)
+    {
+      unsigned int srcSize = static_cast<unsigned int>(min(static_cast<unsigned long long>(blockSize), vecSize - pos));
+      CompAlgo compAlgo;
+
+      auto start = std::chrono::steady_clock::now();
+      int compSize = compressors[candidate]->Compress(compBuf, bufSize, &vec[pos], srcSize, compAlgo);
+      auto middle = std::chrono::steady_clock::now();
+
+      if (compAlgo == CompAlgo::UNCOMPRESS)
+      {
+        memcpy(blockBuf, compBuf, srcSize);
+      }
+      else
+      {
+        Decompressor::Decompress(static_cast<unsigned int>(compAlgo), blockBuf, srcSize, compBuf, compSize);
+      }
+
+      auto end = std::chrono::steady_clock::now();
+
+      totCompSize += compSize;
+      compTime += std::chrono::duration<double>(middle - start).count();
+      decompTime += std::chrono::duration<double>(end - middle).count();
+    }
+
+    bool fastEnough = (targetWriteSpeed <= 0.0 || nrOfThreads * megaBytes >= targetWriteSpeed * compTime) &&
+      (targetReadSpeed <= 0.0 || nrOfThreads * megaBytes >= targetReadSpeed * decompTime);
+
+    if (fastEnough && totCompSize < bestSize)
+    {
+      bestSize = totCompSize;
+      selected = candidate;
+    }
+  }
+}
+
+int StreamAutotuneCompressor::Selected() const
+{
+  return selected;
+}
+
+int StreamAutotuneCompressor::CompressBufferSize()
+{
+  return compBufSize;  // return buffer size for the compression algorithm
+}
+
+int StreamAutotuneCompressor::CompressBufferSize(unsigned int srcSize)
+{
+  // buffer size is valid for any calibration result
+  compBufSize = static_cast<int>(srcSize);
+  for (int candidate = 0; candidate < nrOfCompressors; ++candidate)
+  {
+    compBufSize = max(compBufSize, compressors[candidate]->CompressBufferSize(srcSize));
+  }
+
+  return compBufSize;
+}
+
+int StreamAutotuneCompressor::Compress(char* src, unsigned int srcSize, char* compBuf, CompAlgo &compAlgorithm, int blockNr)
+{
+  if (selected >= 0)
+  {
+    return compressors[selected]->Compress(compBuf, compBufSize, src, srcSize, compAlgorithm);
+  }
+
+  // Uncompressed
+  compAlgorithm = CompAlgo::UNCOMPRESS;
+  memcpy(compBuf, src, srcSize);
+
+  return srcSize;
+}
+
+
 StreamCompositeCompressor::StreamCompositeCompressor(Compressor *compressor1, Compressor *compressor2, float compressionLevel)
 {
   compress1 = compressor2;
@@ -24,14 +24,33 @@
 #ifndef COMPRESSOR_H
 #define COMPRESSOR_H
 
+#include <atomic>
+#include <memory>
+
 #include <compression/compression.h>
 #include <interface/fstdefines.h>
 
 
-#define NR_OF_ALGORITHMS 16
+#define NR_OF_ALGORITHMS 36
 #define MAX_TARGET_REP_SIZE 8
 #define MAX_SOURCE_REP_SIZE 128
 
+// Adaptive compression
+#define ADAPTIVE_SAMPLE_SIZE   2048  // number of bytes in a block sample used for codec selection
+#define ADAPTIVE_SAMPLE_SLICES 4     // number of evenly spread slices in a block sample
+#define ADAPTIVE_MAX_ENTROPY   7.9   // bits per byte above which a block is considered incompressible
+#define ADAPTIVE_MAX_LANE_ENTROPY 7.5  // same for the bytes at a single position within an element (smaller sample)
+#define ADAPTIVE_MIN_GAIN      0.95  // maximum compressed size of the sample relative to the source
+#define ADAPTIVE_SPEED_WEIGHT  0.1   // relative size penalty for each slower compressor at compression level 0
+#define ADAPTIVE_TRIAL_LEVEL   14    // compression level of ZSTD based trials (ZSTD level 3)
+
+// Dual compression
+#define CACHE_LINE_SIZE        64    // per thread state is padded to avoid false sharing
+#define DUAL_MERGE_BLOCKS      32    // number of blocks after which a thread merges its statistics with other threads
+
+// Autotuning
+#define AUTOTUNE_CALIBRATION_BLOCKS 8  // number of leading blocks of a column used to measure codec speed and ratio
+
 // Compression algorithm types. Used for determining the maximum compression buffer size.
 enum CompAlgoType
 {
@@ -46,7 +65,26 @@ enum CompAlgoType
   INT_TO_BYTE_TYPE,
   INT_TO_SHORT_TYPE,
   ZSTD_INT_TO_BYTE_TYPE,
-  ZSTD_INT_TO_SHORT_TYPE
+  ZSTD_INT_TO_SHORT_TYPE,
+  FOR_INT_TYPE,
+  LZ4_FOR_INT_TYPE,
+  ZSTD_FOR_INT_TYPE,
+  FOR_INT64_TYPE,
+  LZ4_FOR_INT64_TYPE,
+  ZSTD_FOR_INT64_TYPE,
+  XOR_DOUBLE_TYPE,
+  DEC_DOUBLE_TYPE,
+  LZ4_DEC_DOUBLE_TYPE,
+  ZSTD_DEC_DOUBLE_TYPE,
+  RLE_INT_TYPE,
+  CONSTANT_TYPE,
+  SPARSE_TYPE,
+  NARROW_INT64_TYPE,
+  LZ4_NARROW_INT64_TYPE,
+  ZSTD_NARROW_INT64_TYPE,
+  INT_DOUBLE_TYPE,
+  LZ4_INT_DOUBLE_TYPE,
+  ZSTD_INT_DOUBLE_TYPE
 };
 
 
@@ -67,7 +105,27 @@ enum CompAlgo
   INT_TO_BYTE,
   INT_TO_SHORT,
   ZSTD_INT_TO_BYTE,
-  ZSTD_INT_TO_SHORT_SHUF2
+  ZSTD_INT_TO_SHORT_SHUF2,
+  FOR_INT,
+  LZ4_FOR_INT,
+  ZSTD_FOR_INT,
+  FOR_INT64,
+  LZ4_FOR_INT64,
+  ZSTD_FOR_INT64,
+  XOR_DOUBLE,
+  DEC_DOUBLE,
+  LZ4_DEC_DOUBLE,
+  ZSTD_DEC_DOUBLE,
+  RLE_INT,
+  CONSTANT,
+  SPARSE_INT,
+  SPARSE_INT64,
+  NARROW_INT64,
+  LZ4_NARROW_INT64,
+  ZSTD_NARROW_INT64,
+  INT_DOUBLE,
+  LZ4_INT_DOUBLE,
+  ZSTD_INT_DOUBLE
 };
 
 
@@ -86,6 +144,24 @@ public:
   ~Decompressor() { };
 
   static int Decompress(unsigned int algo, char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+
+  /**
+   Decompress only bytes [rangeStart, rangeStart + rangeSize) of a block into dst. Algorithms with partial decoding
+   support only decode (or unpack) the part of the block that is needed, other algorithms decompress the full block
+   into a staging buffer.
+
+   @param algo Compression algorithm of the block.
+   @param dst Destination of rangeSize bytes, can have any alignment.
+   @param dstCapacity Size of the fully decompressed block.
+   @param src Compressed block.
+   @param compressedSize Size of the compressed block.
+   @param rangeStart Offset of the range in the decompressed block, a multiple of the element size.
+   @param rangeSize Size of the range, a multiple of the element size.
+
+   @return Zero on success.
+   */
+  static int DecompressRange(unsigned int algo, char* dst, unsigned int dstCapacity, const char* src,
+    unsigned int compressedSize, unsigned int rangeStart, unsigned int rangeSize);
 };
 
 
@@ -98,6 +174,14 @@ public:
   virtual int Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm) = 0;
   virtual int CompressBufferSize(int maxBlockSize) = 0;
 
+  // Compress a sample of block src for codec selection, dst holds at least CompressBufferSize(srcSize) bytes. By
+  // default, the sample is compressed as a regular block.
+  virtual int TrialCompress(char* dst, unsigned int dstCapacity, const char* sample, unsigned int sampleSize,
+    const char* src, unsigned int srcSize, CompAlgo &compAlgorithm)
+  {
+    return Compress(dst, dstCapacity, sample, sampleSize, compAlgorithm);
+  }
+
   virtual ~Compressor() {}
 };
 
@@ -177,9 +261,30 @@ public:
   @return Resulting number of bytes in the compressed data
   */
   int Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm);
+
+  // Compress a sample of the block, ZSTD based algorithms use compression level ADAPTIVE_TRIAL_LEVEL
+  int TrialCompress(char* dst, unsigned int dstCapacity, const char* sample, unsigned int sampleSize,
+    const char* src, unsigned int srcSize, CompAlgo &compAlgorithm);
 };
 
 
+// Adaptation state of a single thread, padded so that the states of different threads never share a cache line
+struct DualCompressorState
+{
+  std::atomic<int> credit;      // percentage credit for using the first algorithm on the next block
+  std::atomic<int> a1Ratio;     // percentage of blocks compressed with the first algorithm
+  std::atomic<int> lastSize1;
+  std::atomic<int> lastSize2;
+  std::atomic<int> blockCount;  // blocks since the last merge
+  char padding[2 * CACHE_LINE_SIZE - 5 * sizeof(std::atomic<int>)];
+};
+
+
+/**
+ A compressor that alternates between two algorithms and adapts the ratio between them to the compressed sizes.
+ Each thread adapts its own ratio without locking, and merges it with the ratio of the other threads every
+ DUAL_MERGE_BLOCKS blocks.
+*/
 class DualCompressor : public Compressor
 {
 private:
@@ -187,11 +292,9 @@ private:
   CompAlgo algo1, algo2;
   int compLevel1, compLevel2;
 
-  int lastCount;
-  float a1Count;
-  int a1Ratio;
-  int lastSize1;
-  int lastSize2;
+  int nrOfStates;
+  std::unique_ptr<DualCompressorState[]> states;
+  std::atomic<int> sharedRatio;
 
 public:
 
@@ -218,6 +321,237 @@ public:
 };
 
 
+/**
+ A compressor for double vectors that stores fixed-point blocks (all values equal k / 10^scale) as scaled integers.
+ Blocks that are not decimal are compressed with the wrapped compressor.
+*/
+class DecimalDoubleCompressor : public Compressor
+{
+private:
+  Compressor* compress;
+  CompAlgorithm a1;
+  CompAlgo algo1;
+  int compLevel;
+
+public:
+
+  /**
+   Constructor for a decimal double compressor.
+
+   @param compressor Compressor used for blocks that are not decimal.
+   @param decimalAlgo Decimal algorithm (DEC_DOUBLE, LZ4_DEC_DOUBLE or ZSTD_DEC_DOUBLE) used for decimal blocks.
+   @param compressionLevel Level of compression for the decimal algorithm.
+   */
+  DecimalDoubleCompressor(Compressor* compressor, CompAlgo decimalAlgo, int compressionLevel);
+
+  int CompressBufferSize(int maxBlockSize);
+
+  /**
+  Compress src into dst
+
+  @param dst Destination buffer
+  @param dstCapacity Size of destination buffer
+  @param src Source buffer with doubles
+  @param srcSize Size of source buffer
+  @return Resulting number of bytes in the compressed data
+  */
+  int Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm);
+
+  // Compress a sample of the block, ZSTD based algorithms use compression level ADAPTIVE_TRIAL_LEVEL
+  int TrialCompress(char* dst, unsigned int dstCapacity, const char* sample, unsigned int sampleSize,
+    const char* src, unsigned int srcSize, CompAlgo &compAlgorithm);
+};
+
+
+/**
+ A compressor for double vectors that stores integral blocks (all values are whole numbers) as narrowed integers.
+ Blocks with fractional values are compressed with the wrapped compressor.
+*/
+class IntegralDoubleCompressor : public Compressor
+{
+private:
+  Compressor* compress;
+  CompAlgorithm a1;
+  CompAlgo algo1;
+  int compLevel;
+
+public:
+
+  /**
+   Constructor for an integral double compressor.
+
+   @param compressor Compressor used for blocks that are not integral.
+   @param integralAlgo Integral algorithm (INT_DOUBLE, LZ4_INT_DOUBLE or ZSTD_INT_DOUBLE) used for integral blocks.
+   @param compressionLevel Level of compression for the integral algorithm.
+   */
+  IntegralDoubleCompressor(Compressor* compressor, CompAlgo integralAlgo, int compressionLevel);
+
+  int CompressBufferSize(int maxBlockSize);
+
+  /**
+  Compress src into dst
+
+  @param dst Destination buffer
+  @param dstCapacity Size of destination buffer
+  @param src Source buffer with doubles
+  @param srcSize Size of source buffer
+  @return Resulting number of bytes in the compressed data
+  */
+  int Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm);
+
+  // Compress a sample of the block, ZSTD based algorithms use compression level ADAPTIVE_TRIAL_LEVEL
+  int TrialCompress(char* dst, unsigned int dstCapacity, const char* sample, unsigned int sampleSize,
+    const char* src, unsigned int srcSize, CompAlgo &compAlgorithm);
+};
+
+
+/**
+ A compressor that selects a compressor for each block from a list of candidates. A sample of the block is used to
+ estimate the byte entropy (per byte and per byte position within an element). Blocks with a high entropy, such as
+ random doubles or hashes, are stored uncompressed without any compression work. For other blocks, each candidate
+ compresses the sample (at a fast level) and the candidate with the smallest weighted size is used for the complete
+ block. Candidates
+ are expected to be ordered from fast to slow, and slower candidates get a size penalty that decreases with the
+ compression level. The compressor has no state, so it can be used from multiple threads.
+*/
+class AdaptiveCompressor : public Compressor
+{
+private:
+  Compressor** compressors;
+  int nrOfCompressors;
+  int elemSize;
+  float speedWeight;
+
+public:
+
+  /**
+   Constructor for an adaptive compressor.
+
+   @param candidates Candidate compressors, ordered from fast to slow. The array must outlive the compressor.
+   @param nrOfCandidates Number of candidate compressors.
+   @param elementSize Size of a single element in bytes, used for the per byte position entropy.
+   @param compressionLevel Value 0 - 100, higher values favor compression ratio over speed.
+   */
+  AdaptiveCompressor(Compressor** candidates, int nrOfCandidates, int elementSize, int compressionLevel);
+
+  int CompressBufferSize(int maxBlockSize);
+
+  /**
+  Compress src into dst
+
+  @param dst Destination buffer
+  @param dstCapacity Size of destination buffer
+  @param src Source buffer
+  @param srcSize Size of source buffer
+  @return Resulting number of bytes in the compressed data
+  */
+  int Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm);
+};
+
+
+/**
+ A compressor for integer vectors that run-length encodes blocks with long runs of identical values. Blocks with a
+ shorter average run length are compressed with the wrapped compressor.
+*/
+class RunLengthCompressor : public Compressor
+{
+private:
+  Compressor* compress;
+  int minRun;
+
+public:
+
+  /**
+   Constructor for a run-length compressor.
+
+   @param compressor Compressor used for blocks with short runs.
+   @param minRunLength Minimum average run length for a block to be run-length encoded.
+   */
+  RunLengthCompressor(Compressor* compressor, int minRunLength);
+
+  int CompressBufferSize(int maxBlockSize);
+
+  /**
+  Compress src into dst
+
+  @param dst Destination buffer
+  @param dstCapacity Size of destination buffer
+  @param src Source buffer with integers
+  @param srcSize Size of source buffer
+  @return Resulting number of bytes in the compressed data
+  */
+  int Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm);
+
+  /**
+  Compress a sample of block src, blocks with long runs are sized on the full block
+
+  @param dst Destination buffer
+  @param dstCapacity Size of destination buffer
+  @param sample Sample of the source buffer
+  @param sampleSize Size of the sample
+  @param src Source buffer with integers
+  @param srcSize Size of source buffer
+  @return Estimated compressed size of the sample
+  */
+  int TrialCompress(char* dst, unsigned int dstCapacity, const char* sample, unsigned int sampleSize,
+    const char* src, unsigned int srcSize, CompAlgo &compAlgorithm);
+};
+
+
+// Opaque ZSTD context and dictionary types
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+
+/**
+ A ZSTD compressor that uses a trained dictionary. Blocks are reported as CompAlgo::ZSTD blocks and can only be
+ decompressed with a ZstdDictDecompressor that uses the same dictionary. The compression context is reused between
+ calls, so a single instance should not be used from multiple threads.
+*/
+class ZstdDictCompressor : public Compressor
+{
+private:
+  ZSTD_CCtx_s* cctx;
+  ZSTD_CDict_s* cdict;
+
+public:
+
+  /**
+   Constructor for a dictionary based ZSTD compressor.
+
+   @param dict Trained dictionary, the contents are copied.
+   @param dictSize Size of the dictionary.
+   @param compressionLevel Level of compression (0 - 100).
+   */
+  ZstdDictCompressor(const char* dict, unsigned int dictSize, int compressionLevel);
+
+  ~ZstdDictCompressor();
+
+  int CompressBufferSize(int maxBlockSize);
+
+  int Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm);
+};
+
+
+// Decompressor for blocks compressed with a ZstdDictCompressor. Not thread safe.
+class ZstdDictDecompressor
+{
+private:
+  ZSTD_DCtx_s* dctx;
+  ZSTD_DDict_s* ddict;
+
+public:
+  ZstdDictDecompressor(const char* dict, unsigned int dictSize);
+
+  ~ZstdDictDecompressor();
+
+  // Returns 0 on success
+  int Decompress(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+};
+
+
 class StreamCompressor
 {
 public:
@@ -231,6 +565,34 @@ public:
 };
 
 
+/**
+ A stream compressor that stores constant blocks (such as all-NA blocks) as a single value and blocks where nearly all
+ elements have the same value as a list of exceptions. Other blocks are compressed with the wrapped stream compressor.
+*/
+class StreamSparseCompressor : public StreamCompressor
+{
+private:
+  StreamCompressor* compress;
+  int elemSize;
+
+public:
+
+  /**
+   Constructor for a sparse stream compressor.
+
+   @param streamCompressor Stream compressor used for dense blocks.
+   @param elementSize Size of a single element in bytes. Sparse blocks require 4 or 8 byte elements.
+   */
+  StreamSparseCompressor(StreamCompressor* streamCompressor, int elementSize);
+
+  int CompressBufferSize();
+
+  int CompressBufferSize(unsigned int srcSize);
+
+  int Compress(char* src,  unsigned int srcSize, char* compBuf, CompAlgo &compAlgorithm, int blockNr);
+};
+
+
 /**
  A compressor that works by producing uncompressed and compressed blocks in a specific ratio.
  The chosen ratio determines the overall compression ratio. A ratio of zero means that only
@@ -292,6 +654,57 @@ public:
 };
 
 
+/**
+ A stream compressor that selects a single compressor for a column from a list of candidates. The candidates are
+ measured on the first blocks of the column and the candidate with the best compression ratio that meets the write
+ and read throughput targets is used for all blocks. If no candidate is fast enough, the column is stored
+ uncompressed. Throughput is measured on a single thread and scaled with the number of threads in use.
+*/
+class StreamAutotuneCompressor : public StreamCompressor
+{
+private:
+  Compressor** compressors;
+  int nrOfCompressors;
+  double targetWriteSpeed;
+  double targetReadSpeed;
+  int selected;
+  int compBufSize;
+
+public:
+
+  /**
+   Constructor for an autotuning stream compressor.
+
+   @param candidates Candidate compressors. The array must outlive the compressor.
+   @param nrOfCandidates Number of candidate compressors.
+   @param writeSpeed Target compression speed in MB/s of source data, 0 for no target.
+   @param readSpeed Target decompression speed in MB/s of source data, 0 for no target.
+   */
+  StreamAutotuneCompressor(Compressor** candidates, int nrOfCandidates, double writeSpeed, double readSpeed);
+
+  /**
+   Measure the candidates on the first blocks of a vector and select the compressor to use. Must be called before
+   the first call to Compress.
+
+   @param vec Source vector.
+   @param vecSize Size of the source vector in bytes.
+   @param blockSize Size of a single block in bytes.
+   */
+  void Calibrate(const char* vec, unsigned long long vecSize, unsigned int blockSize);
+
+  /**
+   Index of the selected candidate, -1 if blocks are stored uncompressed.
+   */
+  int Selected() const;
+
+  int CompressBufferSize();
+
+  int CompressBufferSize(unsigned int srcSize);
+
+  int Compress(char* src, unsigned int srcSize, char* compBuf, CompAlgo &compAlgorithm, int blockNr);
+};
+
+
 /**
  A compressor that works by producing compressed blocks with two algorithms in a specific ratio.
  The second algorithm is expected to be a slower but stronger algorithm.
@@ -0,0 +1,178 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+#include <cstring>
+
+#include <compression/decimaldouble.h>
+#include <compression/scratchbuffer.h>
+#include <interface/fstdefines.h>
+
+
+#define DEC_MAX_INT 9007199254740992.0  // 2^53, larger integers can not be converted to a double exactly
+
+
+// Powers of ten are exactly representable as doubles, so k / 10^scale is correctly rounded
+static const double decimalPowers[DEC_MAX_SCALE + 1] = {
+  1.0, 10.0, 100.0, 1000.0, 10000.0, 100000.0, 1000000.0, 10000000.0, 100000000.0, 1000000000.0
+};
+
+
+// Scale value to an integer, returns false if the integer is not exactly restored to value
+inline bool ScaleDecimal(double value, int scale, long long &intValue)
+{
+  double scaled = value * decimalPowers[scale];
+
+  if (!(scaled < DEC_MAX_INT && scaled > -DEC_MAX_INT)) return false;  // also excludes infinity
+
+  // any nearby integer will do, the result is verified below
+  intValue = static_cast<long long>(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+  double restored = static_cast<double>(intValue) / decimalPowers[scale];
+
+  return memcmp(&restored, &value, 8) == 0;  // bitwise, so -0.0 is not decimal
+}
+
+
+int DecimalScaleDouble(const double* doubleVec, unsigned int nrOfDoubles, int maxScale)
+{
+  int scale = 0;
+  long long intValue;
+
+  for (unsigned int pos = 0; pos < nrOfDoubles; ++pos)
+  {
+    double value = doubleVec[pos];
+    if (value != value) continue;  // NaN payloads are checked during conversion
+
+    // a decimal value is also decimal at larger scales, so the scale only increases
+    while (!ScaleDecimal(value, scale, intValue))
+    {
+      if (++scale > maxScale) return -1;
+    }
+  }
+
+  return scale;
+}
+
+
+// Convert to scaled integers, returns false if the block is not decimal at the given scale
+inline bool DecimalToInt64(long long* intVec, const double* doubleVec, unsigned int nrOfDoubles, int scale,
+  unsigned long long &nanBits)
+{
+  bool hasNaN = false;
+
+  for (unsigned int pos = 0; pos < nrOfDoubles; ++pos)
+  {
+    double value = doubleVec[pos];
+
+    if (value != value)
+    {
+      unsigned long long bits;
+      memcpy(&bits, &value, 8);
+
+      if (!hasNaN)
+      {
+        hasNaN = true;
+        nanBits = bits;
+      }
+      else if (bits != nanBits)
+      {
+        return false;  // multiple NaN payloads
+      }
+
+      intVec[pos] = static_cast<long long>(FST_NA_INT64);
+      continue;
+    }
+
+    if (!ScaleDecimal(value, scale, intVec[pos])) return false;
+  }
+
+  return true;
+}
+
+
+unsigned int DecimalCompressDouble(char* dst, unsigned int dstCapacity, const double* doubleVec, unsigned int nrOfDoubles,
+  int compressionLevel, CompAlgorithm intAlgorithm, int maxScale)
+{
+  ScratchBuffer scratch(SCRATCH_DECIMAL, 8 * nrOfDoubles);
+  long long* intBuf = reinterpret_cast<long long*>(scratch.Data());
+  unsigned long long nanBits = 0;
+
+  memset(dst, 0, DEC_HEADER_SIZE);
+  int scale = DecimalScaleDouble(doubleVec, nrOfDoubles, maxScale);
+
+  if (scale < 0 || !DecimalToInt64(intBuf, doubleVec, nrOfDoubles, scale, nanBits))
+  {
+    dst[0] = DEC_MODE_RAW;
+    memcpy(&dst[DEC_HEADER_SIZE], doubleVec, 8 * nrOfDoubles);
+    return DEC_HEADER_SIZE + 8 * nrOfDoubles;
+  }
+
+  dst[0] = DEC_MODE_SCALED;
+  dst[1] = static_cast<char>(scale);
+  memcpy(&dst[8], &nanBits, 8);
+
+  return DEC_HEADER_SIZE + intAlgorithm(&dst[DEC_HEADER_SIZE], dstCapacity - DEC_HEADER_SIZE,
+    reinterpret_cast<const char*>(intBuf), 8 * nrOfDoubles, compressionLevel);
+}
+
+
+unsigned int DecimalDecompressDouble(double* doubleVec, const char* src, unsigned int compressedSize, unsigned int nrOfDoubles,
+  DecompAlgorithm intAlgorithm)
+{
+  if (compressedSize < DEC_HEADER_SIZE) return 1;
+
+  if (src[0] == DEC_MODE_RAW)
+  {
+    if (compressedSize != DEC_HEADER_SIZE + 8 * nrOfDoubles) return 1;
+
+    memcpy(doubleVec, &src[DEC_HEADER_SIZE], 8 * nrOfDoubles);
+    return 0;
+  }
+
+  int scale = src[1];
+  if (src[0] != DEC_MODE_SCALED || scale < 0 || scale > DEC_MAX_SCALE) return 1;
+
+  // the integers are decompressed in place
+  char* buf = reinterpret_cast<char*>(doubleVec);
+  unsigned int errorCode = intAlgorithm(buf, 8 * nrOfDoubles, &src[DEC_HEADER_SIZE], compressedSize - DEC_HEADER_SIZE);
+
+  double power = decimalPowers[scale];
+  const long long naInt64 = static_cast<long long>(FST_NA_INT64);
+
+  for (unsigned int pos = 0; pos < nrOfDoubles; ++pos)
+  {
+    long long intValue;
+    memcpy(&intValue, &buf[8 * pos], 8);
+
+    if (intValue == naInt64)
+    {
+      memcpy(&buf[8 * pos], &src[8], 8);
+      continue;
+    }
+
+    double value = static_cast<double>(intValue) / power;
+    memcpy(&buf[8 * pos], &value, 8);
+  }
+
+  return errorCode;
+}
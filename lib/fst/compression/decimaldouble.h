@@ -0,0 +1,62 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+#ifndef DECIMALDOUBLE_H
+#define DECIMALDOUBLE_H
+
+#include <compression/compression.h>
+
+
+#define DEC_HEADER_SIZE  16  // block header: mode, scale, 6 reserved bytes and the NaN bit pattern
+#define DEC_MODE_RAW     0   // doubles are stored as-is
+#define DEC_MODE_SCALED  1   // doubles are stored as integers k, with value = k / 10^scale
+#define DEC_MAX_SCALE    9   // maximum number of decimals
+
+
+// Decimal-scaled double compression.
+//
+// Many double vectors hold fixed-point values, such as prices with a few decimals. When every value in a block equals
+// k / 10^scale exactly (bit for bit), the block is stored as an integer64 vector of k values that is compressed with an
+// integer64 codec. A single NaN bit pattern per block (typically R's NA) is stored in the header and maps to the
+// integer64 NA value. Negative zero, infinities and blocks with different NaN payloads are not decimal.
+
+
+// Determine the smallest scale (up to maxScale) for which all doubles can be restored from a scaled integer. Returns -1
+// if no such scale exists. With a maxScale of 0, the function detects blocks of whole numbers.
+int DecimalScaleDouble(const double* doubleVec, unsigned int nrOfDoubles, int maxScale = DEC_MAX_SCALE);
+
+
+// Compress nrOfDoubles doubles into dst by scaling to integers that are compressed with intAlgorithm. Blocks that are
+// not decimal at a scale of at most maxScale are stored unpacked. Buffer dst should hold at least
+// DEC_HEADER_SIZE + 8 * nrOfDoubles bytes and the compressed size for intAlgorithm. Returns the compressed size.
+unsigned int DecimalCompressDouble(char* dst, unsigned int dstCapacity, const double* doubleVec, unsigned int nrOfDoubles,
+  int compressionLevel, CompAlgorithm intAlgorithm, int maxScale = DEC_MAX_SCALE);
+
+
+// Decompress nrOfDoubles doubles, returns 0 on success
+unsigned int DecimalDecompressDouble(double* doubleVec, const char* src, unsigned int compressedSize, unsigned int nrOfDoubles,
+  DecompAlgorithm intAlgorithm);
+
+
+#endif  // DECIMALDOUBLE_H
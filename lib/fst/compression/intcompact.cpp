@@ -0,0 +1,181 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+
+#include <compression/simd.h>
+#include <compression/intcompact.h>
+
+#ifdef FST_AVX2
+  #include <immintrin.h>
+#endif
+
+
+// The scalar code stores the integers of a group of 8 as bytes in the order 6, 4, 2, 0, 7, 5, 3, 1 and the integers
+// of a group of 4 as shorts in the order 2, 0, 3, 1. The stored code is the lowest byte (short) or'ed with the highest
+// byte (short), so the NA bit is stored in the top bit of the code. Expansion maps the top bit back to bit 31.
+//
+// The scalar code works on 64-bit words and is as fast as a SSE2 implementation, so only AVX2 kernels are used.
+
+
+#ifdef FST_AVX2
+
+FST_TARGET_AVX2 static unsigned int CompactIntToByteAVX2(char* outVec, const char* intVec, unsigned int nrOfInts)
+{
+  const __m256i* src = reinterpret_cast<const __m256i*>(intVec);
+  __m256i* dst = reinterpret_cast<__m256i*>(outVec);
+  const __m256i byteMask = _mm256_set1_epi32(0xff);
+  const __m256i groupOrder = _mm256_setr_epi32(6, 4, 2, 0, 7, 5, 3, 1);
+  const __m256i laneOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  unsigned int nrOfBlocks = nrOfInts / 32;
+
+  for (unsigned int block = 0; block < nrOfBlocks; ++block, src += 4)
+  {
+    __m256i codes[4];
+    for (int reg = 0; reg < 4; ++reg)
+    {
+      __m256i ints = _mm256_loadu_si256(&src[reg]);
+      __m256i code = _mm256_and_si256(_mm256_or_si256(ints, _mm256_srli_epi32(ints, 24)), byteMask);
+      codes[reg] = _mm256_permutevar8x32_epi32(code, groupOrder);
+    }
+
+    // the packs work per 128-bit lane, so the 4-byte parts of the groups are reordered afterwards
+    __m256i shorts0 = _mm256_packs_epi32(codes[0], codes[1]);
+    __m256i shorts1 = _mm256_packs_epi32(codes[2], codes[3]);
+    __m256i bytes = _mm256_packus_epi16(shorts0, shorts1);
+    _mm256_storeu_si256(&dst[block], _mm256_permutevar8x32_epi32(bytes, laneOrder));
+  }
+
+  return 32 * nrOfBlocks;
+}
+
+
+FST_TARGET_AVX2 static unsigned int DecompactByteToIntAVX2(const char* compressedVec, char* intVec, unsigned int nrOfInts)
+{
+  __m256i* dst = reinterpret_cast<__m256i*>(intVec);
+  const __m256i groupOrder = _mm256_setr_epi32(3, 7, 2, 6, 1, 5, 0, 4);
+  const __m256i valueMask = _mm256_set1_epi32(0x7f);
+  const __m256i signBit = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+  unsigned int nrOfGroups = nrOfInts / 8;
+
+  for (unsigned int group = 0; group < nrOfGroups; ++group)
+  {
+    __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&compressedVec[8 * group]));
+    __m256i ints = _mm256_permutevar8x32_epi32(_mm256_cvtepu8_epi32(bytes), groupOrder);
+
+    ints = _mm256_or_si256(_mm256_and_si256(ints, valueMask), _mm256_and_si256(_mm256_slli_epi32(ints, 24), signBit));
+    _mm256_storeu_si256(&dst[group], ints);
+  }
+
+  return 8 * nrOfGroups;
+}
+
+
+FST_TARGET_AVX2 static unsigned int CompactIntToShortAVX2(char* outVec, const char* intVec, unsigned int nrOfInts)
+{
+  const __m256i* src = reinterpret_cast<const __m256i*>(intVec);
+  __m256i* dst = reinterpret_cast<__m256i*>(outVec);
+  const __m256i groupOrder = _mm256_setr_epi32(2, 0, 3, 1, 6, 4, 7, 5);
+  unsigned int nrOfBlocks = nrOfInts / 16;
+
+  for (unsigned int block = 0; block < nrOfBlocks; ++block, src += 2)
+  {
+    __m256i codes[2];
+    for (int reg = 0; reg < 2; ++reg)
+    {
+      __m256i ints = _mm256_loadu_si256(&src[reg]);
+      __m256i code = _mm256_or_si256(ints, _mm256_srli_epi32(ints, 16));
+      code = _mm256_srai_epi32(_mm256_slli_epi32(code, 16), 16);
+      codes[reg] = _mm256_permutevar8x32_epi32(code, groupOrder);
+    }
+
+    __m256i shorts = _mm256_packs_epi32(codes[0], codes[1]);
+    _mm256_storeu_si256(&dst[block], _mm256_permute4x64_epi64(shorts, _MM_SHUFFLE(3, 1, 2, 0)));
+  }
+
+  return 16 * nrOfBlocks;
+}
+
+
+FST_TARGET_AVX2 static unsigned int DecompactShortToIntAVX2(const char* compressedVec, char* intVec, unsigned int nrOfInts)
+{
+  const __m128i* src = reinterpret_cast<const __m128i*>(compressedVec);
+  __m256i* dst = reinterpret_cast<__m256i*>(intVec);
+  const __m256i groupOrder = _mm256_setr_epi32(1, 3, 0, 2, 5, 7, 4, 6);
+  const __m256i valueMask = _mm256_set1_epi32(0x7fff);
+  const __m256i signBit = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+  unsigned int nrOfBlocks = nrOfInts / 8;
+
+  for (unsigned int block = 0; block < nrOfBlocks; ++block)
+  {
+    __m256i ints = _mm256_cvtepu16_epi32(_mm_loadu_si128(&src[block]));
+    ints = _mm256_permutevar8x32_epi32(ints, groupOrder);
+
+    ints = _mm256_or_si256(_mm256_and_si256(ints, valueMask), _mm256_and_si256(_mm256_slli_epi32(ints, 16), signBit));
+    _mm256_storeu_si256(&dst[block], ints);
+  }
+
+  return 8 * nrOfBlocks;
+}
+
+#endif  // FST_AVX2
+
+
+unsigned int CompactIntToByteKernel(char* outVec, const char* intVec, unsigned int nrOfInts)
+{
+#ifdef FST_AVX2
+  if (SimdActiveLevel() == SimdLevel::SIMD_AVX2) return CompactIntToByteAVX2(outVec, intVec, nrOfInts);
+#endif
+
+  return 0;
+}
+
+
+unsigned int DecompactByteToIntKernel(const char* compressedVec, char* intVec, unsigned int nrOfInts)
+{
+#ifdef FST_AVX2
+  if (SimdActiveLevel() == SimdLevel::SIMD_AVX2) return DecompactByteToIntAVX2(compressedVec, intVec, nrOfInts);
+#endif
+
+  return 0;
+}
+
+
+unsigned int CompactIntToShortKernel(char* outVec, const char* intVec, unsigned int nrOfInts)
+{
+#ifdef FST_AVX2
+  if (SimdActiveLevel() == SimdLevel::SIMD_AVX2) return CompactIntToShortAVX2(outVec, intVec, nrOfInts);
+#endif
+
+  return 0;
+}
+
+
+unsigned int DecompactShortToIntKernel(const char* compressedVec, char* intVec, unsigned int nrOfInts)
+{
+#ifdef FST_AVX2
+  if (SimdActiveLevel() == SimdLevel::SIMD_AVX2) return DecompactShortToIntAVX2(compressedVec, intVec, nrOfInts);
+#endif
+
+  return 0;
+}
@@ -0,0 +1,52 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+
+#ifndef INTCOMPACT_H
+#define INTCOMPACT_H
+
+
+// Vectorised kernels for the integer compaction codecs (INT_TO_BYTE and INT_TO_SHORT). The kernels process the
+// leading groups of integers and return the number of integers processed, which is a multiple of the group size (8
+// integers for bytes, 4 for shorts). The remaining integers are left to the scalar code in compression.cpp. Output is
+// identical to the scalar code, so a kernel that processes nothing (instruction sets below AVX2) is always valid.
+
+
+// Compact integers to bytes, see CompactIntToByte
+unsigned int CompactIntToByteKernel(char* outVec, const char* intVec, unsigned int nrOfInts);
+
+
+// Expand bytes to integers, see DecompactByteToInt
+unsigned int DecompactByteToIntKernel(const char* compressedVec, char* intVec, unsigned int nrOfInts);
+
+
+// Compact integers to shorts, see CompactIntToShort
+unsigned int CompactIntToShortKernel(char* outVec, const char* intVec, unsigned int nrOfInts);
+
+
+// Expand shorts to integers, see DecompactShortToInt
+unsigned int DecompactShortToIntKernel(const char* compressedVec, char* intVec, unsigned int nrOfInts);
+
+
+#endif  // INTCOMPACT_H
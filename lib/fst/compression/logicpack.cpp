@@ -0,0 +1,288 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+
+#include <stdint.h>
+
+#include <compression/simd.h>
+#include <compression/logicpack.h>
+
+#ifdef FST_SSE2
+  #include <emmintrin.h>
+#endif
+
+#ifdef FST_AVX2
+  #include <immintrin.h>
+#endif
+
+
+void LogicPack64Scalar(const char* logicalVec, unsigned long long* compress, int nrOfGroups)
+{
+  const unsigned long long* logicals = reinterpret_cast<const unsigned long long*>(logicalVec);
+
+  // Define filters
+  unsigned long long BIT = (1LL << 32) | 1LL;
+  unsigned long long BIT0  = (BIT << 16) | (BIT << 15);
+  unsigned long long BIT1  = (BIT << 17) | (BIT << 14);
+  unsigned long long BIT2  = (BIT << 18) | (BIT << 13);
+  unsigned long long BIT3  = (BIT << 19) | (BIT << 12);
+  unsigned long long BIT4  = (BIT << 20) | (BIT << 11);
+  unsigned long long BIT5  = (BIT << 21) | (BIT << 10);
+  unsigned long long BIT6  = (BIT << 22) | (BIT << 9 );
+  unsigned long long BIT7  = (BIT << 23) | (BIT << 8 );
+  unsigned long long BIT8  = (BIT << 24) | (BIT << 7 );
+  unsigned long long BIT9  = (BIT << 25) | (BIT << 6 );
+  unsigned long long BIT10 = (BIT << 26) | (BIT << 5 );
+  unsigned long long BIT11 = (BIT << 27) | (BIT << 4 );
+  unsigned long long BIT12 = (BIT << 28) | (BIT << 3 );
+  unsigned long long BIT13 = (BIT << 29) | (BIT << 2 );
+  unsigned long long BIT14 = (BIT << 30) | (BIT << 1 );
+  unsigned long long BIT15 = (BIT << 31) | BIT;
+
+  // Compress in cycles of 32 logicals
+  for (int i = 0; i < nrOfGroups; ++i)
+  {
+    const unsigned long long* logics = &logicals[16 * i];
+
+    compress[i] =
+      (((logics[15] >> 15) | logics[15] << 15) & BIT0 ) |
+      (((logics[14] >> 14) | logics[14] << 14) & BIT1 ) |
+      (((logics[13] >> 13) | logics[13] << 13) & BIT2 ) |
+      (((logics[12] >> 12) | logics[12] << 12) & BIT3 ) |
+      (((logics[11] >> 11) | logics[11] << 11) & BIT4 ) |
+      (((logics[10] >> 10) | logics[10] << 10) & BIT5 ) |
+      (((logics[9 ] >> 9 ) | logics[9 ] << 9 ) & BIT6 ) |
+      (((logics[8 ] >> 8 ) | logics[8 ] << 8 ) & BIT7 ) |
+      (((logics[7 ] >> 7 ) | logics[7 ] << 7 ) & BIT8 ) |
+      (((logics[6 ] >> 6 ) | logics[6 ] << 6 ) & BIT9 ) |
+      (((logics[5 ] >> 5 ) | logics[5 ] << 5 ) & BIT10) |
+      (((logics[4 ] >> 4 ) | logics[4 ] << 4 ) & BIT11) |
+      (((logics[3 ] >> 3 ) | logics[3 ] << 3 ) & BIT12) |
+      (((logics[2 ] >> 2 ) | logics[2 ] << 2 ) & BIT13) |
+      (((logics[1 ] >> 1 ) | logics[1 ] << 1 ) & BIT14) |
+      (  logics[0 ] & BIT15);
+  }
+}
+
+
+void LogicUnpack64Scalar(char* logicalVec, const unsigned long long* compress, int nrOfGroups)
+{
+  unsigned long long* logicals = reinterpret_cast<unsigned long long*>(logicalVec);
+
+  // Define filters
+  unsigned long long BIT0 = (1LL << 32) | 1LL;
+  unsigned long long BIT31 = BIT0 << 31;
+  unsigned long long BIT = BIT0 | BIT31;
+
+  // Decompress in cycles of 32 logicals
+  for (int i = 0; i < nrOfGroups; ++i)
+  {
+    unsigned long long* logics = &logicals[16 * i];
+    unsigned long long compVal = compress[i];
+
+    logics[15] = (compVal << 15 & BIT31) | (compVal >> 15 & BIT0);
+    logics[14] = (compVal << 14 & BIT31) | (compVal >> 14 & BIT0);
+    logics[13] = (compVal << 13 & BIT31) | (compVal >> 13 & BIT0);
+    logics[12] = (compVal << 12 & BIT31) | (compVal >> 12 & BIT0);
+    logics[11] = (compVal << 11 & BIT31) | (compVal >> 11 & BIT0);
+    logics[10] = (compVal << 10 & BIT31) | (compVal >> 10 & BIT0);
+    logics[9 ] = (compVal << 9  & BIT31) | (compVal >> 9  & BIT0);
+    logics[8 ] = (compVal << 8  & BIT31) | (compVal >> 8  & BIT0);
+    logics[7 ] = (compVal << 7  & BIT31) | (compVal >> 7  & BIT0);
+    logics[6 ] = (compVal << 6  & BIT31) | (compVal >> 6  & BIT0);
+    logics[5 ] = (compVal << 5  & BIT31) | (compVal >> 5  & BIT0);
+    logics[4 ] = (compVal << 4  & BIT31) | (compVal >> 4  & BIT0);
+    logics[3 ] = (compVal << 3  & BIT31) | (compVal >> 3  & BIT0);
+    logics[2 ] = (compVal << 2  & BIT31) | (compVal >> 2  & BIT0);
+    logics[1 ] = (compVal << 1  & BIT31) | (compVal >> 1  & BIT0);
+    logics[0 ] = compVal & BIT;
+  }
+}
+
+
+#ifdef FST_SSE2
+
+static void LogicPack64SSE2(const char* logicalVec, unsigned long long* compress, int nrOfGroups)
+{
+  const __m128i* src = reinterpret_cast<const __m128i*>(logicalVec);
+
+  for (int group = 0; group < nrOfGroups; ++group, src += 8)
+  {
+    uint32_t even0 = 0, odd0 = 0, even31 = 0, odd31 = 0;
+
+    for (int k = 0; k < 4; ++k)
+    {
+      __m128 a = _mm_castsi128_ps(_mm_loadu_si128(&src[2 * k]));
+      __m128 b = _mm_castsi128_ps(_mm_loadu_si128(&src[2 * k + 1]));
+
+      // even and odd logicals 4k .. 4k + 3 of the group halves
+      __m128i even = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      __m128i odd = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+      even0 |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(even, 31)))) << (4 * k);
+      odd0 |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(odd, 31)))) << (4 * k);
+
+      // reversed lane order puts bit 31 of logical j at bit 15 - j
+      __m128i evenRev = _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 1, 2, 3));
+      __m128i oddRev = _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 1, 2, 3));
+      even31 |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(evenRev))) << (12 - 4 * k);
+      odd31 |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(oddRev))) << (12 - 4 * k);
+    }
+
+    compress[group] = (even0 | even31 << 16) | static_cast<unsigned long long>(odd0 | odd31 << 16) << 32;
+  }
+}
+
+
+static void LogicUnpack64SSE2(char* logicalVec, const unsigned long long* compress, int nrOfGroups)
+{
+  __m128i* dst = reinterpret_cast<__m128i*>(logicalVec);
+
+  for (int group = 0; group < nrOfGroups; ++group, dst += 8)
+  {
+    unsigned long long compVal = compress[group];
+    int half0 = static_cast<int>(static_cast<uint32_t>(compVal));
+    int half1 = static_cast<int>(static_cast<uint32_t>(compVal >> 32));
+    __m128i halves = _mm_set_epi32(half1, half0, half1, half0);
+
+    // lanes hold logicals 2j, 2j + 1, 2j + 2 and 2j + 3, with bit 0 at bit j or j + 1 of their half
+    __m128i mask0 = _mm_set_epi32(2, 2, 1, 1);
+    __m128i mask31 = _mm_set_epi32(1 << 30, 1 << 30, static_cast<int>(0x80000000u), static_cast<int>(0x80000000u));
+
+    for (int reg = 0; reg < 8; ++reg)
+    {
+      __m128i bit0 = _mm_srli_epi32(_mm_cmpeq_epi32(_mm_and_si128(halves, mask0), mask0), 31);
+      __m128i bit31 = _mm_slli_epi32(_mm_cmpeq_epi32(_mm_and_si128(halves, mask31), mask31), 31);
+      _mm_storeu_si128(&dst[reg], _mm_or_si128(bit0, bit31));
+
+      mask0 = _mm_slli_epi32(mask0, 2);
+      mask31 = _mm_srli_epi32(mask31, 2);
+    }
+  }
+}
+
+#endif  // FST_SSE2
+
+
+#ifdef FST_AVX2
+
+FST_TARGET_AVX2 static void LogicPack64AVX2(const char* logicalVec, unsigned long long* compress, int nrOfGroups)
+{
+  const __m256i* src = reinterpret_cast<const __m256i*>(logicalVec);
+
+  for (int group = 0; group < nrOfGroups; ++group, src += 4)
+  {
+    // lanes hold logicals with index j, j, j + 1, j + 1, ... of the even and odd halves
+    __m256i shift = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    __m256i mask0 = _mm256_sllv_epi32(_mm256_set1_epi32(1), shift);
+    __m256i mask31 = _mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(0x80000000u)), shift);
+    __m256i acc = _mm256_setzero_si256();
+
+    for (int reg = 0; reg < 4; ++reg)
+    {
+      __m256i logics = _mm256_loadu_si256(&src[reg]);
+      acc = _mm256_or_si256(acc, _mm256_and_si256(_mm256_sllv_epi32(logics, shift), mask0));
+      acc = _mm256_or_si256(acc, _mm256_and_si256(_mm256_srlv_epi32(logics, shift), mask31));
+
+      shift = _mm256_add_epi32(shift, _mm256_set1_epi32(4));
+      mask0 = _mm256_slli_epi32(mask0, 4);
+      mask31 = _mm256_srli_epi32(mask31, 4);
+    }
+
+    // each 64-bit lane holds part of the packed word
+    __m128i word = _mm_or_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    word = _mm_or_si128(word, _mm_unpackhi_epi64(word, word));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&compress[group]), word);
+  }
+}
+
+
+FST_TARGET_AVX2 static void LogicUnpack64AVX2(char* logicalVec, const unsigned long long* compress, int nrOfGroups)
+{
+  __m256i* dst = reinterpret_cast<__m256i*>(logicalVec);
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i signBit = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+
+  for (int group = 0; group < nrOfGroups; ++group, dst += 4)
+  {
+    __m256i halves = _mm256_set1_epi64x(static_cast<long long>(compress[group]));
+    __m256i shift = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+
+    for (int reg = 0; reg < 4; ++reg)
+    {
+      // bit j holds bit 0 and bit 31 - j holds bit 31 of logical j
+      __m256i bit0 = _mm256_and_si256(_mm256_srlv_epi32(halves, shift), one);
+      __m256i bit31 = _mm256_and_si256(_mm256_sllv_epi32(halves, shift), signBit);
+      _mm256_storeu_si256(&dst[reg], _mm256_or_si256(bit0, bit31));
+
+      shift = _mm256_add_epi32(shift, _mm256_set1_epi32(4));
+    }
+  }
+}
+
+#endif  // FST_AVX2
+
+
+void LogicPack64(const char* logicalVec, unsigned long long* compress, int nrOfGroups)
+{
+  switch (SimdActiveLevel())
+  {
+#ifdef FST_AVX2
+    case SimdLevel::SIMD_AVX2:
+      LogicPack64AVX2(logicalVec, compress, nrOfGroups);
+      return;
+#endif
+
+#ifdef FST_SSE2
+    case SimdLevel::SIMD_SSE2:
+      LogicPack64SSE2(logicalVec, compress, nrOfGroups);
+      return;
+#endif
+
+    default:
+      LogicPack64Scalar(logicalVec, compress, nrOfGroups);
+  }
+}
+
+
+void LogicUnpack64(char* logicalVec, const unsigned long long* compress, int nrOfGroups)
+{
+  switch (SimdActiveLevel())
+  {
+#ifdef FST_AVX2
+    case SimdLevel::SIMD_AVX2:
+      LogicUnpack64AVX2(logicalVec, compress, nrOfGroups);
+      return;
+#endif
+
+#ifdef FST_SSE2
+    case SimdLevel::SIMD_SSE2:
+      LogicUnpack64SSE2(logicalVec, compress, nrOfGroups);
+      return;
+#endif
+
+    default:
+      LogicUnpack64Scalar(logicalVec, compress, nrOfGroups);
+  }
+}
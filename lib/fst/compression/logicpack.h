@@ -0,0 +1,50 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+
+#ifndef LOGICPACK_H
+#define LOGICPACK_H
+
+
+// Logical vectors are stored with 2 bits per element: bit 0 (TRUE) and bit 31 (NA) of each 32-bit logical. A group
+// of 32 logicals is packed into a single 64-bit word. The even logicals use the lower and the odd logicals the upper
+// 32 bits of the word. Within these 32 bits, bit j holds bit 0 of logical j and bit 31 - j holds bit 31 of logical j
+// (counting logicals of the same parity).
+
+
+// Pack nrOfGroups groups of 32 logicals into nrOfGroups 64-bit words. Uses the fastest available instruction set.
+void LogicPack64(const char* logicalVec, unsigned long long* compress, int nrOfGroups);
+
+
+// Unpack nrOfGroups 64-bit words into 32 logicals each. Uses the fastest available instruction set.
+void LogicUnpack64(char* logicalVec, const unsigned long long* compress, int nrOfGroups);
+
+
+// Portable implementations with identical output, used as reference
+void LogicPack64Scalar(const char* logicalVec, unsigned long long* compress, int nrOfGroups);
+
+void LogicUnpack64Scalar(char* logicalVec, const unsigned long long* compress, int nrOfGroups);
+
+
+#endif  // LOGICPACK_H
@@ -0,0 +1,219 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+
+#include <climits>
+#include <cstring>
+#include <limits>
+
+#include <compression/simd.h>
+#include <compression/narrowint64.h>
+#include <interface/fstdefines.h>
+
+#ifdef FST_SSE2
+  #include <emmintrin.h>
+#endif
+
+
+unsigned int NarrowWidthInt64(const long long* int64Vec, unsigned int nrOfInts)
+{
+  const long long naInt64 = static_cast<long long>(FST_NA_INT64);
+  long long minVal = 0;
+  long long maxVal = 0;
+
+  for (unsigned int pos = 0; pos < nrOfInts; ++pos)
+  {
+    long long val = int64Vec[pos];
+
+    if (val == naInt64) continue;
+
+    if (val < minVal) minVal = val;
+    if (val > maxVal) maxVal = val;
+  }
+
+  // the smallest value of each width is the NA sentinel
+  if (minVal > SCHAR_MIN && maxVal <= SCHAR_MAX) return 1;
+  if (minVal > SHRT_MIN && maxVal <= SHRT_MAX) return 2;
+  if (minVal > INT_MIN && maxVal <= INT_MAX) return 4;
+
+  return 8;
+}
+
+
+template<typename T>
+void NarrowInt64Type(char* dst, const long long* int64Vec, unsigned int nrOfInts)
+{
+  const long long naInt64 = static_cast<long long>(FST_NA_INT64);
+  const T naNarrow = std::numeric_limits<T>::min();
+
+  for (unsigned int pos = 0; pos < nrOfInts; ++pos)
+  {
+    long long val = int64Vec[pos];
+    T narrow = val == naInt64 ? naNarrow : static_cast<T>(val);
+    memcpy(&dst[sizeof(T) * pos], &narrow, sizeof(T));
+  }
+}
+
+
+void NarrowInt64(char* dst, const long long* int64Vec, unsigned int nrOfInts, unsigned int width)
+{
+  switch (width)
+  {
+    case 1:
+      NarrowInt64Type<signed char>(dst, int64Vec, nrOfInts);
+      break;
+
+    case 2:
+      NarrowInt64Type<short>(dst, int64Vec, nrOfInts);
+      break;
+
+    default:
+      NarrowInt64Type<int>(dst, int64Vec, nrOfInts);
+  }
+}
+
+
+template<typename T>
+void WidenInt64Scalar(long long* int64Vec, const char* src, unsigned int nrOfInts)
+{
+  const long long naInt64 = static_cast<long long>(FST_NA_INT64);
+  const T naNarrow = std::numeric_limits<T>::min();
+
+  for (unsigned int pos = 0; pos < nrOfInts; ++pos)
+  {
+    T narrow;
+    memcpy(&narrow, &src[sizeof(T) * pos], sizeof(T));
+    int64Vec[pos] = narrow == naNarrow ? naInt64 : static_cast<long long>(narrow);
+  }
+}
+
+
+#ifdef FST_SSE2
+
+// Sign extend 4 integers to integer64 and map the NA sentinel naVec to the integer64 NA
+inline void WidenInt32x4(long long* out, __m128i val, __m128i naVec, __m128i naInt64Vec)
+{
+  const __m128i sign = _mm_srai_epi32(val, 31);
+  const __m128i isNA = _mm_cmpeq_epi32(val, naVec);
+
+  __m128i lo = _mm_unpacklo_epi32(val, sign);
+  __m128i hi = _mm_unpackhi_epi32(val, sign);
+  const __m128i isNALo = _mm_unpacklo_epi32(isNA, isNA);
+  const __m128i isNAHi = _mm_unpackhi_epi32(isNA, isNA);
+
+  lo = _mm_or_si128(_mm_andnot_si128(isNALo, lo), _mm_and_si128(isNALo, naInt64Vec));
+  hi = _mm_or_si128(_mm_andnot_si128(isNAHi, hi), _mm_and_si128(isNAHi, naInt64Vec));
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), lo);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[2]), hi);
+}
+
+
+// Sign extend 8 shorts to integers
+inline void WidenInt16x8(__m128i val, __m128i &lo, __m128i &hi)
+{
+  const __m128i sign = _mm_srai_epi16(val, 15);
+  lo = _mm_unpacklo_epi16(val, sign);
+  hi = _mm_unpackhi_epi16(val, sign);
+}
+
+
+void WidenInt64SSE2(long long* int64Vec, const char* src, unsigned int nrOfInts, unsigned int width)
+{
+  const __m128i naInt64Vec = _mm_set_epi32(INT_MIN, 0, INT_MIN, 0);  // two integer64 NA values
+  unsigned int nrOfVecs = (width * nrOfInts) / 16;  // number of complete 16 byte source vectors
+  const __m128i* in = reinterpret_cast<const __m128i*>(src);
+
+  if (width == 4)
+  {
+    const __m128i naVec = _mm_set1_epi32(INT_MIN);
+
+    for (unsigned int vec = 0; vec < nrOfVecs; ++vec)
+    {
+      WidenInt32x4(&int64Vec[4 * vec], _mm_loadu_si128(&in[vec]), naVec, naInt64Vec);
+    }
+
+    WidenInt64Scalar<int>(&int64Vec[4 * nrOfVecs], &src[16 * nrOfVecs], nrOfInts - 4 * nrOfVecs);
+    return;
+  }
+
+  if (width == 2)
+  {
+    const __m128i naVec = _mm_set1_epi32(SHRT_MIN);
+
+    for (unsigned int vec = 0; vec < nrOfVecs; ++vec)
+    {
+      __m128i lo, hi;
+      WidenInt16x8(_mm_loadu_si128(&in[vec]), lo, hi);
+      WidenInt32x4(&int64Vec[8 * vec], lo, naVec, naInt64Vec);
+      WidenInt32x4(&int64Vec[8 * vec + 4], hi, naVec, naInt64Vec);
+    }
+
+    WidenInt64Scalar<short>(&int64Vec[8 * nrOfVecs], &src[16 * nrOfVecs], nrOfInts - 8 * nrOfVecs);
+    return;
+  }
+
+  const __m128i naVec = _mm_set1_epi32(SCHAR_MIN);
+
+  for (unsigned int vec = 0; vec < nrOfVecs; ++vec)
+  {
+    const __m128i val = _mm_loadu_si128(&in[vec]);
+    const __m128i sign = _mm_cmpgt_epi8(_mm_setzero_si128(), val);
+
+    __m128i lo, hi;
+    WidenInt16x8(_mm_unpacklo_epi8(val, sign), lo, hi);
+    WidenInt32x4(&int64Vec[16 * vec], lo, naVec, naInt64Vec);
+    WidenInt32x4(&int64Vec[16 * vec + 4], hi, naVec, naInt64Vec);
+
+    WidenInt16x8(_mm_unpackhi_epi8(val, sign), lo, hi);
+    WidenInt32x4(&int64Vec[16 * vec + 8], lo, naVec, naInt64Vec);
+    WidenInt32x4(&int64Vec[16 * vec + 12], hi, naVec, naInt64Vec);
+  }
+
+  WidenInt64Scalar<signed char>(&int64Vec[16 * nrOfVecs], &src[16 * nrOfVecs], nrOfInts - 16 * nrOfVecs);
+}
+
+#endif  // FST_SSE2
+
+
+void WidenInt64(long long* int64Vec, const char* src, unsigned int nrOfInts, unsigned int width)
+{
+#ifdef FST_SSE2
+  WidenInt64SSE2(int64Vec, src, nrOfInts, width);
+#else
+  switch (width)
+  {
+    case 1:
+      WidenInt64Scalar<signed char>(int64Vec, src, nrOfInts);
+      break;
+
+    case 2:
+      WidenInt64Scalar<short>(int64Vec, src, nrOfInts);
+      break;
+
+    default:
+      WidenInt64Scalar<int>(int64Vec, src, nrOfInts);
+  }
+#endif
+}
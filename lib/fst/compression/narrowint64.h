@@ -0,0 +1,53 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+
+#ifndef NARROW_INT64_H
+#define NARROW_INT64_H
+
+
+#define NARROW_HEADER_SIZE   8   // block header: 1 byte element width (1, 2, 4 or 8) and 7 reserved bytes
+
+
+// Narrowing of an integer64 vector.
+//
+// Integer64 columns (for example from bit64 or Arrow) often hold values that fit in 32 bits or less. Blocks whose
+// values fit in a signed 8, 16 or 32 bit integer are stored with that width. The smallest value of the narrow type
+// is reserved for NA, so widening is a sign extension followed by a mapping of that value to the integer64 NA.
+
+
+// Smallest width in bytes (1, 2, 4 or 8) that holds all values of int64Vec
+unsigned int NarrowWidthInt64(const long long* int64Vec, unsigned int nrOfInts);
+
+
+// Store nrOfInts integers in dst with width (1, 2 or 4) bytes per integer. All values should fit in width bytes,
+// see NarrowWidthInt64.
+void NarrowInt64(char* dst, const long long* int64Vec, unsigned int nrOfInts, unsigned int width);
+
+
+// Sign extend nrOfInts integers of width (1, 2 or 4) bytes to integer64
+void WidenInt64(long long* int64Vec, const char* src, unsigned int nrOfInts, unsigned int width);
+
+
+#endif  // NARROW_INT64_H
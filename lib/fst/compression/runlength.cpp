@@ -0,0 +1,123 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+
+#include <cstring>
+
+#include <compression/runlength.h>
+
+
+unsigned int RunCountInt(const int* intVec, unsigned int nrOfInts, unsigned int maxRuns)
+{
+  if (nrOfInts == 0) return 0;
+
+  unsigned int nrOfRuns = 1;
+  int value = intVec[0];
+
+  for (unsigned int pos = 1; pos < nrOfInts; ++pos)
+  {
+    if (intVec[pos] == value) continue;
+
+    value = intVec[pos];
+    if (++nrOfRuns > maxRuns) break;
+  }
+
+  return nrOfRuns;
+}
+
+
+unsigned int RunLengthCompressInt(char* dst, const int* intVec, unsigned int nrOfInts)
+{
+  unsigned int* header = reinterpret_cast<unsigned int*>(dst);
+  unsigned int maxRuns = nrOfInts / 2;  // 2 integers per run
+  unsigned int nrOfRuns = RunCountInt(intVec, nrOfInts, maxRuns);
+
+  memset(dst, 0, RLE_HEADER_SIZE);
+
+  if (nrOfRuns > maxRuns || nrOfInts == 0)
+  {
+    dst[0] = RLE_MODE_RAW;
+    memcpy(&dst[RLE_HEADER_SIZE], intVec, 4 * nrOfInts);
+    return RLE_HEADER_SIZE + 4 * nrOfInts;
+  }
+
+  dst[0] = RLE_MODE_RUNS;
+  header[1] = nrOfRuns;
+
+  int* runValues = reinterpret_cast<int*>(&dst[RLE_HEADER_SIZE]);
+  unsigned int* runEnds = reinterpret_cast<unsigned int*>(&dst[RLE_HEADER_SIZE + 4 * nrOfRuns]);
+
+  unsigned int run = 0;
+  int value = intVec[0];
+
+  for (unsigned int pos = 1; pos < nrOfInts; ++pos)
+  {
+    if (intVec[pos] == value) continue;
+
+    runValues[run] = value;
+    runEnds[run++] = pos;
+    value = intVec[pos];
+  }
+
+  runValues[run] = value;
+  runEnds[run] = nrOfInts;
+
+  return RLE_HEADER_SIZE + 8 * nrOfRuns;
+}
+
+
+unsigned int RunLengthDecompressInt(int* intVec, const char* src, unsigned int compressedSize, unsigned int nrOfInts)
+{
+  if (compressedSize < RLE_HEADER_SIZE) return 1;
+
+  const unsigned int* header = reinterpret_cast<const unsigned int*>(src);
+
+  if (src[0] == RLE_MODE_RAW)
+  {
+    if (compressedSize != RLE_HEADER_SIZE + 4 * nrOfInts) return 1;
+
+    memcpy(intVec, &src[RLE_HEADER_SIZE], 4 * nrOfInts);
+    return 0;
+  }
+
+  unsigned int nrOfRuns = header[1];
+  if (compressedSize != RLE_HEADER_SIZE + 8 * static_cast<unsigned long long>(nrOfRuns)) return 1;
+
+  const int* runValues = reinterpret_cast<const int*>(&src[RLE_HEADER_SIZE]);
+  const unsigned int* runEnds = reinterpret_cast<const unsigned int*>(&src[RLE_HEADER_SIZE + 4 * nrOfRuns]);
+
+  unsigned int pos = 0;
+
+  for (unsigned int run = 0; run < nrOfRuns; ++run)
+  {
+    unsigned int runEnd = runEnds[run];
+    if (runEnd > nrOfInts || runEnd < pos) return 1;
+
+    // branch free fill loop, vectorized by the compiler
+    int value = runValues[run];
+    for (; pos < runEnd; ++pos) intVec[pos] = value;
+  }
+
+  return pos != nrOfInts;
+}
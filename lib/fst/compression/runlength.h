@@ -0,0 +1,55 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+#ifndef RUNLENGTH_H
+#define RUNLENGTH_H
+
+
+#define RLE_HEADER_SIZE      8   // block header: 1 byte mode, 3 reserved bytes and the number of runs
+#define RLE_MODE_RAW         0   // integers are stored as-is
+#define RLE_MODE_RUNS        1   // integers are stored as runs
+#define RLE_MIN_RUN_LENGTH   64  // minimum average run length for automatic selection of the RLE codec
+
+
+// Run-length encoding of an integer vector.
+//
+// A run of identical values is stored as the value followed by the (exclusive) end position of the run. All run values
+// are stored first, followed by all end positions, so that decoding is a sequence of simple fill loops. Logical,
+// factor and sorted integer vectors often have long runs.
+
+
+// Count the number of runs in intVec. Counting stops when more than maxRuns runs are found.
+unsigned int RunCountInt(const int* intVec, unsigned int nrOfInts, unsigned int maxRuns);
+
+
+// Compress nrOfInts integers into dst. Buffer dst should hold at least RLE_HEADER_SIZE + 4 * nrOfInts bytes. When the
+// runs take more space than the source, the block is stored unpacked. Returns the compressed size.
+unsigned int RunLengthCompressInt(char* dst, const int* intVec, unsigned int nrOfInts);
+
+
+// Decompress nrOfInts integers, returns 0 on success
+unsigned int RunLengthDecompressInt(int* intVec, const char* src, unsigned int compressedSize, unsigned int nrOfInts);
+
+
+#endif  // RUNLENGTH_H
@@ -0,0 +1,92 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+
+#ifndef SCRATCH_BUFFER_H
+#define SCRATCH_BUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+#include <interface/fstdefines.h>
+
+
+// Per-thread scratch buffers for the compression and decompression of a single block.
+//
+// The block size of a column is set at write time, so buffers that depend on it can't live on the stack. Each
+// thread keeps one growing buffer per slot, which is reused for all following blocks. A slot is used by a single
+// layer of the call stack, so nested layers (block streamer -> decimal codec -> integer codec) never share memory.
+// Requests above SCRATCH_RETAIN_SIZE (custom block sizes up to BLOCKSIZE_MAX) get a buffer of their own that is
+// freed with the ScratchBuffer, so threads don't keep large blocks alive after the write or read has finished.
+enum ScratchSlot
+{
+  SCRATCH_STREAM_COMP = 0,  // compressed block data in the block streamer
+  SCRATCH_STREAM_BLOCK,     // decompressed block data for partial block decompression
+  SCRATCH_ADAPTIVE,         // trial compression of a block sample in the adaptive compressor
+  SCRATCH_DECIMAL,          // integer representation of a decimal double block
+  SCRATCH_CODEC,            // shuffle, pack or compaction buffer of a single codec
+  SCRATCH_CODEC_AUX,        // second buffer of codecs with two transformation stages
+  NR_OF_SCRATCH_SLOTS
+};
+
+
+#define SCRATCH_RETAIN_SIZE   (16 * BLOCKSIZE)  // largest buffer kept by a thread, covers default (character) blocks
+
+
+/**
+ * @brief (8-byte aligned) scratch buffer of at least 'size' bytes for the current thread.
+ *
+ * Small buffers are taken from the thread's slot and stay valid until the next ScratchBuffer with the same slot
+ * is created on this thread. Larger buffers are owned by the object and released when it goes out of scope.
+ */
+class ScratchBuffer
+{
+  std::vector<unsigned long long> ownBuffer;  // buffer of a request larger than SCRATCH_RETAIN_SIZE
+  char* data;
+
+public:
+  /**
+   * @param slot Slot of the buffer, see ScratchSlot.
+   * @param size Required size in bytes.
+   */
+  ScratchBuffer(ScratchSlot slot, size_t size)
+  {
+    thread_local std::vector<unsigned long long> buffers[NR_OF_SCRATCH_SLOTS];
+
+    size_t nrOfLongs = 1 + size / 8;
+    std::vector<unsigned long long>& buffer = size > SCRATCH_RETAIN_SIZE ? ownBuffer : buffers[slot];
+
+    if (buffer.size() < nrOfLongs) buffer.resize(nrOfLongs);
+
+    data = reinterpret_cast<char*>(buffer.data());
+  }
+
+  ScratchBuffer(const ScratchBuffer&) = delete;
+  ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+  char* Data() const { return data; }
+};
+
+
+#endif  // SCRATCH_BUFFER_H
@@ -0,0 +1,72 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+
+#include <atomic>
+
+#include <compression/simd.h>
+
+
+static SimdLevel DetectSimdLevel()
+{
+#ifdef FST_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return SimdLevel::SIMD_AVX2;
+#endif
+
+#ifdef FST_SSE2
+  return SimdLevel::SIMD_SSE2;
+#else
+  return SimdLevel::SIMD_SCALAR;
+#endif
+}
+
+
+static std::atomic<int>& ActiveLevel()
+{
+  static std::atomic<int> activeLevel(static_cast<int>(SimdMaxLevel()));
+  return activeLevel;
+}
+
+
+SimdLevel SimdMaxLevel()
+{
+  static const SimdLevel maxLevel = DetectSimdLevel();
+  return maxLevel;
+}
+
+
+SimdLevel SimdActiveLevel()
+{
+  return static_cast<SimdLevel>(ActiveLevel().load(std::memory_order_relaxed));
+}
+
+
+void SimdSetLevel(SimdLevel level)
+{
+  int maxLevel = static_cast<int>(SimdMaxLevel());
+  int newLevel = static_cast<int>(level);
+
+  ActiveLevel().store(newLevel < maxLevel ? newLevel : maxLevel, std::memory_order_relaxed);
+}
@@ -0,0 +1,63 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+#ifndef SIMD_H
+#define SIMD_H
+
+
+// SSE2 is part of the x86-64 baseline, so it can be used without runtime detection
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define FST_SSE2
+#endif
+
+// AVX2 kernels are compiled with a function target attribute and selected at runtime (GCC and Clang)
+#if defined(FST_SSE2) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+  #define FST_AVX2
+  #define FST_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+
+// Instruction sets for kernels with runtime dispatch, from slow to fast
+enum SimdLevel
+{
+  SIMD_SCALAR,
+  SIMD_SSE2,
+  SIMD_AVX2
+};
+
+
+// Fastest instruction set supported by both the build and the processor
+SimdLevel SimdMaxLevel();
+
+
+// Instruction set used by kernels with runtime dispatch. Defaults to SimdMaxLevel().
+SimdLevel SimdActiveLevel();
+
+
+// Limit the instruction set used by kernels with runtime dispatch (for testing and benchmarking). Levels above
+// SimdMaxLevel() are lowered to SimdMaxLevel().
+void SimdSetLevel(SimdLevel level);
+
+
+#endif  // SIMD_H
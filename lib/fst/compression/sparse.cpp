@@ -0,0 +1,256 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+
+#include <algorithm>
+#include <cstring>
+
+#include <compression/sparse.h>
+
+
+void FillRepeat(char* dst, unsigned long long dstSize, const char* value, unsigned int valueSize)
+{
+  if (dstSize == 0) return;
+
+  memcpy(dst, value, valueSize);
+
+  // double the filled range with each copy
+  unsigned long long filled = valueSize;
+  while (filled < dstSize)
+  {
+    unsigned long long copySize = std::min(filled, dstSize - filled);
+    memcpy(&dst[filled], dst, copySize);
+    filled += copySize;
+  }
+}
+
+
+bool IsConstantBlock(const char* vec, unsigned long long vecSize, unsigned int elementSize)
+{
+  if (vecSize <= elementSize) return true;
+
+  // the vector equals itself shifted by one element
+  return memcmp(vec, &vec[elementSize], vecSize - elementSize) == 0;
+}
+
+
+unsigned int ConstantCompress(char* dst, const char* src, unsigned int srcSize)
+{
+  memset(dst, 0, CONST_HEADER_SIZE);
+
+  for (unsigned int valueSize = 1; valueSize <= 8; valueSize *= 2)
+  {
+    if (srcSize % valueSize != 0 || srcSize == 0 || !IsConstantBlock(src, srcSize, valueSize)) continue;
+
+    dst[0] = SPARSE_MODE_PACKED;
+    dst[1] = static_cast<char>(valueSize);
+    memcpy(&dst[CONST_HEADER_SIZE], src, valueSize);
+
+    return CONST_HEADER_SIZE + valueSize;
+  }
+
+  dst[0] = SPARSE_MODE_RAW;
+  memcpy(&dst[CONST_HEADER_SIZE], src, srcSize);
+
+  return CONST_HEADER_SIZE + srcSize;
+}
+
+
+unsigned int ConstantDecompress(char* dst, unsigned int dstSize, const char* src, unsigned int compressedSize)
+{
+  if (compressedSize < CONST_HEADER_SIZE) return 1;
+
+  if (src[0] == SPARSE_MODE_RAW)
+  {
+    if (compressedSize != CONST_HEADER_SIZE + dstSize) return 1;
+
+    memcpy(dst, &src[CONST_HEADER_SIZE], dstSize);
+    return 0;
+  }
+
+  unsigned int valueSize = static_cast<unsigned char>(src[1]);
+  if (compressedSize != CONST_HEADER_SIZE + valueSize || valueSize == 0 || dstSize % valueSize != 0) return 1;
+
+  FillRepeat(dst, dstSize, &src[CONST_HEADER_SIZE], valueSize);
+
+  return 0;
+}
+
+
+// Count exceptions with respect to background, stops when more than maxExceptions are found
+template<typename T>
+inline unsigned int ExceptionCount(const T* vec, unsigned int nrOfElements, T background, unsigned int maxExceptions)
+{
+  unsigned int nrOfExceptions = 0;
+
+  for (unsigned int pos = 0; pos < nrOfElements; ++pos)
+  {
+    if (vec[pos] != background && ++nrOfExceptions > maxExceptions) break;
+  }
+
+  return nrOfExceptions;
+}
+
+
+// The background value is found at the start or at the end of a sparse block
+template<typename T>
+inline unsigned int SparseBackground(const T* vec, unsigned int nrOfElements, unsigned int maxExceptions, T& background)
+{
+  background = vec[0];
+  unsigned int nrOfExceptions = ExceptionCount(vec, nrOfElements, background, maxExceptions);
+
+  if (nrOfExceptions <= maxExceptions || vec[nrOfElements - 1] == vec[0]) return nrOfExceptions;
+
+  background = vec[nrOfElements - 1];
+  return ExceptionCount(vec, nrOfElements, background, maxExceptions);
+}
+
+
+// Exception positions are followed by the exception values at the next 8 byte boundary
+inline unsigned int SparseValueOffset(unsigned int nrOfExceptions)
+{
+  return SPARSE_HEADER_SIZE + ((2 * nrOfExceptions + 7) & ~7u);
+}
+
+
+template<typename T>
+inline unsigned int SparseCompress(char* dst, const T* vec, unsigned int nrOfElements)
+{
+  unsigned int rawSize = static_cast<unsigned int>(sizeof(T)) * nrOfElements;
+
+  memset(dst, 0, SPARSE_HEADER_SIZE);
+
+  // largest number of exceptions for which the sparse block is smaller than the source
+  unsigned int maxExceptions = (rawSize - std::min(rawSize, 8u)) / (2 + sizeof(T));
+
+  T background = 0;
+  unsigned int nrOfExceptions = maxExceptions + 1;
+
+  if (nrOfElements > 0 && nrOfElements <= SPARSE_MAX_ELEMENTS)
+  {
+    nrOfExceptions = SparseBackground(vec, nrOfElements, maxExceptions, background);
+  }
+
+  if (nrOfExceptions > maxExceptions)
+  {
+    dst[0] = SPARSE_MODE_RAW;
+    memcpy(&dst[SPARSE_HEADER_SIZE], vec, rawSize);
+    return SPARSE_HEADER_SIZE + rawSize;
+  }
+
+  dst[0] = SPARSE_MODE_PACKED;
+  memcpy(&dst[4], &nrOfExceptions, 4);
+  memcpy(&dst[8], &background, sizeof(T));
+
+  unsigned short* positions = reinterpret_cast<unsigned short*>(&dst[SPARSE_HEADER_SIZE]);
+  char* values = &dst[SparseValueOffset(nrOfExceptions)];
+
+  unsigned int exception = 0;
+  for (unsigned int pos = 0; pos < nrOfElements; ++pos)
+  {
+    if (vec[pos] == background) continue;
+
+    positions[exception] = static_cast<unsigned short>(pos);
+    memcpy(&values[sizeof(T) * exception++], &vec[pos], sizeof(T));
+  }
+
+  return SparseValueOffset(nrOfExceptions) + static_cast<unsigned int>(sizeof(T)) * nrOfExceptions;
+}
+
+
+template<typename T>
+inline unsigned int SparseDecompress(T* vec, const char* src, unsigned int compressedSize, unsigned int nrOfElements)
+{
+  if (compressedSize < SPARSE_HEADER_SIZE) return 1;
+
+  if (src[0] == SPARSE_MODE_RAW)
+  {
+    if (compressedSize != SPARSE_HEADER_SIZE + sizeof(T) * nrOfElements) return 1;
+
+    memcpy(vec, &src[SPARSE_HEADER_SIZE], sizeof(T) * nrOfElements);
+    return 0;
+  }
+
+  unsigned int nrOfExceptions;
+  T background;
+  memcpy(&nrOfExceptions, &src[4], 4);
+  memcpy(&background, &src[8], sizeof(T));
+
+  if (nrOfExceptions > nrOfElements) return 1;
+  if (compressedSize != SparseValueOffset(nrOfExceptions) + sizeof(T) * nrOfExceptions) return 1;
+
+  const unsigned short* positions = reinterpret_cast<const unsigned short*>(&src[SPARSE_HEADER_SIZE]);
+  const char* values = &src[SparseValueOffset(nrOfExceptions)];
+
+  // fill and scatter
+  std::fill_n(vec, nrOfElements, background);
+
+  for (unsigned int exception = 0; exception < nrOfExceptions; ++exception)
+  {
+    unsigned int pos = positions[exception];
+    if (pos >= nrOfElements) return 1;
+
+    memcpy(&vec[pos], &values[sizeof(T) * exception], sizeof(T));
+  }
+
+  return 0;
+}
+
+
+unsigned int SparseExceptionCountInt(const int* intVec, unsigned int nrOfInts, unsigned int maxExceptions)
+{
+  int background;
+  return nrOfInts == 0 ? 0 : SparseBackground(intVec, nrOfInts, maxExceptions, background);
+}
+
+
+unsigned int SparseExceptionCountInt64(const long long* intVec, unsigned int nrOfInts, unsigned int maxExceptions)
+{
+  long long background;
+  return nrOfInts == 0 ? 0 : SparseBackground(intVec, nrOfInts, maxExceptions, background);
+}
+
+
+unsigned int SparseCompressInt(char* dst, const int* intVec, unsigned int nrOfInts)
+{
+  return SparseCompress(dst, intVec, nrOfInts);
+}
+
+
+unsigned int SparseCompressInt64(char* dst, const long long* intVec, unsigned int nrOfInts)
+{
+  return SparseCompress(dst, intVec, nrOfInts);
+}
+
+
+unsigned int SparseDecompressInt(int* intVec, const char* src, unsigned int compressedSize, unsigned int nrOfInts)
+{
+  return SparseDecompress(intVec, src, compressedSize, nrOfInts);
+}
+
+
+unsigned int SparseDecompressInt64(long long* intVec, const char* src, unsigned int compressedSize, unsigned int nrOfInts)
+{
+  return SparseDecompress(intVec, src, compressedSize, nrOfInts);
+}
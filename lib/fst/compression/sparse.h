@@ -0,0 +1,81 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+#ifndef SPARSE_H
+#define SPARSE_H
+
+
+#define CONST_HEADER_SIZE     8   // block header: 1 byte mode, 1 byte value size and 6 reserved bytes
+#define SPARSE_HEADER_SIZE    16  // block header: 1 byte mode, 3 reserved bytes, number of exceptions and background value
+#define SPARSE_MODE_RAW       0   // elements are stored as-is
+#define SPARSE_MODE_PACKED    1   // elements are stored as a constant value or as background value and exceptions
+#define SPARSE_MAX_ELEMENTS   65536  // exception positions are stored as 16-bit integers
+#define SPARSE_MIN_RATIO      64  // automatic sparse encoding when at most 1 / 64 of the elements is an exception
+
+
+// Constant and sparse block encodings.
+//
+// A constant block (for example, an all-NA block) is stored as a single value of 1, 2, 4 or 8 bytes that is repeated
+// during decompression. A sparse block is stored as a background value (the most common value, typically NA), the
+// 16-bit positions of all other elements and their values. Decompression is a fill followed by a scatter.
+
+
+// Fill dst with copies of a value of valueSize bytes. Parameter dstSize must be a multiple of valueSize.
+void FillRepeat(char* dst, unsigned long long dstSize, const char* value, unsigned int valueSize);
+
+
+// Returns true if vec consists of identical elements of elementSize bytes
+bool IsConstantBlock(const char* vec, unsigned long long vecSize, unsigned int elementSize);
+
+
+// Compress srcSize bytes into dst. Blocks that do not consist of a single repeated value of 1, 2, 4 or 8 bytes are
+// stored unpacked. Buffer dst should hold at least CONST_HEADER_SIZE + srcSize bytes. Returns the compressed size.
+unsigned int ConstantCompress(char* dst, const char* src, unsigned int srcSize);
+
+
+// Decompress dstSize bytes, returns 0 on success
+unsigned int ConstantDecompress(char* dst, unsigned int dstSize, const char* src, unsigned int compressedSize);
+
+
+// Count the elements that differ from the most common value in the first and last position. Counting stops when
+// more than maxExceptions exceptions are found.
+unsigned int SparseExceptionCountInt(const int* intVec, unsigned int nrOfInts, unsigned int maxExceptions);
+
+unsigned int SparseExceptionCountInt64(const long long* intVec, unsigned int nrOfInts, unsigned int maxExceptions);
+
+
+// Compress nrOfInts integers into dst. Buffer dst should hold at least SPARSE_HEADER_SIZE + 4 * nrOfInts bytes. When
+// the sparse representation is not smaller than the source, the block is stored unpacked. Returns the compressed size.
+unsigned int SparseCompressInt(char* dst, const int* intVec, unsigned int nrOfInts);
+
+unsigned int SparseCompressInt64(char* dst, const long long* intVec, unsigned int nrOfInts);
+
+
+// Decompress nrOfInts integers, returns 0 on success
+unsigned int SparseDecompressInt(int* intVec, const char* src, unsigned int compressedSize, unsigned int nrOfInts);
+
+unsigned int SparseDecompressInt64(long long* intVec, const char* src, unsigned int compressedSize, unsigned int nrOfInts);
+
+
+#endif  // SPARSE_H
@@ -0,0 +1,313 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+#include <cstring>
+
+#include <compression/xordouble.h>
+
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
+
+
+#define XOR_TRAIL_THRESHOLD 6  // minimum number of trailing zeros for storing only the significant bits
+
+
+// Leading zero classes, a XOR result is stored with at least this number of leading zeros omitted
+static const unsigned int leadValue[8] = { 0, 8, 12, 16, 18, 20, 22, 24 };
+
+// Leading zero count to class
+static const unsigned char leadClass[65] = {
+  0, 0, 0, 0, 0, 0, 0, 0,
+  1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 7, 7, 7, 7, 7, 7,
+  7, 7, 7, 7, 7, 7, 7, 7,
+  7, 7, 7, 7, 7, 7, 7, 7,
+  7, 7, 7, 7, 7, 7, 7, 7,
+  7, 7, 7, 7, 7, 7, 7, 7,
+  7
+};
+
+
+// value should be non-zero
+inline unsigned int LeadingZeros64(uint64_t value)
+{
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  return 63 - static_cast<unsigned int>(index);
+#else
+  return static_cast<unsigned int>(__builtin_clzll(value));
+#endif
+}
+
+
+// value should be non-zero
+inline unsigned int TrailingZeros64(uint64_t value)
+{
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return static_cast<unsigned int>(index);
+#else
+  return static_cast<unsigned int>(__builtin_ctzll(value));
+#endif
+}
+
+
+// Writes bits to a buffer of 64-bit words (least significant bits first)
+class BitWriter
+{
+  char* out;
+  unsigned int maxWords;
+  unsigned int nrOfWords;
+  uint64_t acc;
+  unsigned int nrOfBits;
+
+public:
+
+  BitWriter(char* out, unsigned int maxWords) : out(out), maxWords(maxWords), nrOfWords(0), acc(0), nrOfBits(0) { }
+
+  // Write the lowest bitCount bits of value (1 - 64 bits). Returns false when the buffer is full.
+  bool Write(uint64_t value, unsigned int bitCount)
+  {
+    acc |= value << nrOfBits;
+
+    if (nrOfBits + bitCount < 64)
+    {
+      nrOfBits += bitCount;
+      return true;
+    }
+
+    if (nrOfWords == maxWords) return false;
+
+    memcpy(&out[8 * nrOfWords++], &acc, 8);
+    acc = nrOfBits == 0 ? 0 : value >> (64 - nrOfBits);
+    nrOfBits = nrOfBits + bitCount - 64;
+
+    return true;
+  }
+
+  // Flush the last partial word, returns the number of words written or 0 when the buffer is full
+  unsigned int Finish()
+  {
+    if (nrOfBits != 0)
+    {
+      if (nrOfWords == maxWords) return 0;
+      memcpy(&out[8 * nrOfWords++], &acc, 8);
+    }
+
+    return nrOfWords;
+  }
+};
+
+
+class BitReader
+{
+  const char* in;
+  unsigned int nrOfWords;
+  unsigned int wordPos;
+  uint64_t cur;
+  unsigned int bitPos;
+
+  uint64_t Word(unsigned int pos)
+  {
+    uint64_t word = 0;
+    if (pos < nrOfWords) memcpy(&word, &in[8 * pos], 8);
+    return word;
+  }
+
+public:
+
+  BitReader(const char* in, unsigned int nrOfWords) : in(in), nrOfWords(nrOfWords), wordPos(0), bitPos(0)
+  {
+    cur = Word(0);
+  }
+
+  // Read bitCount bits (1 - 64 bits)
+  uint64_t Read(unsigned int bitCount)
+  {
+    uint64_t value = cur >> bitPos;
+
+    if (bitPos + bitCount >= 64)
+    {
+      cur = Word(++wordPos);
+
+      if (bitPos + bitCount > 64)
+      {
+        value |= cur << (64 - bitPos);
+      }
+
+      bitPos = bitPos + bitCount - 64;
+    }
+    else
+    {
+      bitPos += bitCount;
+    }
+
+    return bitCount == 64 ? value : value & ((1ULL << bitCount) - 1);
+  }
+
+  bool Overrun() { return wordPos > nrOfWords; }
+};
+
+
+inline bool XorEncode(BitWriter& writer, const uint64_t* values, unsigned int nrOfValues)
+{
+  uint64_t prev = values[0];
+  unsigned int prevLead = 65;  // no leading class available
+
+  if (!writer.Write(prev, 64)) return false;
+
+  for (unsigned int pos = 1; pos < nrOfValues; ++pos)
+  {
+    uint64_t cur = values[pos];
+    uint64_t xorVal = cur ^ prev;
+    prev = cur;
+
+    if (xorVal == 0)
+    {
+      if (!writer.Write(0, 2)) return false;
+      prevLead = 65;
+      continue;
+    }
+
+    unsigned int lClass = leadClass[LeadingZeros64(xorVal)];
+    unsigned int lead = leadValue[lClass];
+    unsigned int trail = TrailingZeros64(xorVal);
+
+    if (trail > XOR_TRAIL_THRESHOLD)
+    {
+      unsigned int significant = 64 - lead - trail;  // at most 57 bits
+
+      if (!writer.Write(1 | (lClass << 2) | (significant << 5), 11)) return false;
+      if (!writer.Write(xorVal >> trail, significant)) return false;
+      prevLead = 65;
+      continue;
+    }
+
+    if (lead == prevLead)
+    {
+      if (!writer.Write(2, 2)) return false;
+      if (!writer.Write(xorVal, 64 - lead)) return false;
+      continue;
+    }
+
+    if (!writer.Write(3 | (lClass << 2), 5)) return false;
+    if (!writer.Write(xorVal, 64 - lead)) return false;
+    prevLead = lead;
+  }
+
+  return true;
+}
+
+
+unsigned int XorCompressDouble(char* dst, const double* doubleVec, unsigned int nrOfDoubles)
+{
+  memset(dst, 0, XOR_HEADER_SIZE);
+
+  if (nrOfDoubles != 0)
+  {
+    const uint64_t* values = reinterpret_cast<const uint64_t*>(doubleVec);
+
+    // the bit stream may use at most the space of the unpacked data
+    BitWriter writer(&dst[XOR_HEADER_SIZE], nrOfDoubles);
+
+    if (XorEncode(writer, values, nrOfDoubles))
+    {
+      unsigned int nrOfWords = writer.Finish();
+
+      if (nrOfWords != 0)
+      {
+        dst[0] = XOR_MODE_STREAM;
+        return XOR_HEADER_SIZE + 8 * nrOfWords;
+      }
+    }
+  }
+
+  // incompressible block
+  dst[0] = XOR_MODE_RAW;
+  memcpy(&dst[XOR_HEADER_SIZE], doubleVec, 8 * nrOfDoubles);
+
+  return XOR_HEADER_SIZE + 8 * nrOfDoubles;
+}
+
+
+unsigned int XorDecompressDouble(double* doubleVec, const char* src, unsigned int compressedSize, unsigned int nrOfDoubles)
+{
+  if (compressedSize < XOR_HEADER_SIZE) return 1;
+
+  unsigned int payloadSize = compressedSize - XOR_HEADER_SIZE;
+
+  if (src[0] == XOR_MODE_RAW)
+  {
+    if (payloadSize != 8 * nrOfDoubles) return 1;
+
+    memcpy(doubleVec, &src[XOR_HEADER_SIZE], payloadSize);
+    return 0;
+  }
+
+  if (src[0] != XOR_MODE_STREAM || nrOfDoubles == 0) return 1;
+
+  BitReader reader(&src[XOR_HEADER_SIZE], payloadSize / 8);
+  uint64_t* values = reinterpret_cast<uint64_t*>(doubleVec);
+
+  uint64_t prev = reader.Read(64);
+  unsigned int prevLead = 0;
+  memcpy(&values[0], &prev, 8);
+
+  for (unsigned int pos = 1; pos < nrOfDoubles; ++pos)
+  {
+    unsigned int flag = static_cast<unsigned int>(reader.Read(2));
+    uint64_t xorVal = 0;
+
+    switch (flag)
+    {
+      case 1:
+      {
+        unsigned int lead = leadValue[reader.Read(3)];
+        unsigned int significant = static_cast<unsigned int>(reader.Read(6));
+        if (significant == 0 || lead + significant > 64) return 1;
+
+        xorVal = reader.Read(significant) << (64 - lead - significant);
+        break;
+      }
+
+      case 2:
+        xorVal = reader.Read(64 - prevLead);
+        break;
+
+      case 3:
+        prevLead = leadValue[reader.Read(3)];
+        xorVal = reader.Read(64 - prevLead);
+        break;
+    }
+
+    prev ^= xorVal;
+    memcpy(&values[pos], &prev, 8);
+  }
+
+  return reader.Overrun() ? 1 : 0;
+}
@@ -0,0 +1,59 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+#ifndef XORDOUBLE_H
+#define XORDOUBLE_H
+
+#include <stdint.h>
+
+
+#define XOR_HEADER_SIZE  8  // block header: 1 byte mode and 7 reserved bytes
+#define XOR_MODE_RAW     0  // doubles are stored as-is
+#define XOR_MODE_STREAM  1  // doubles are stored as a XOR bit stream
+
+
+// XOR based double compression (Gorilla / Chimp style).
+//
+// Each value is XOR-ed with its predecessor. The number of leading zeros of the result is rounded down to one of 8
+// classes, and the remaining bits are written using a 2 bit flag:
+//
+//  00 | identical value
+//  01 | 3 bit leading class, 6 bit significant length, significant bits (more than 6 trailing zeros)
+//  10 | (64 - lead) bits, using the leading class of the previous value
+//  11 | 3 bit leading class, (64 - lead) bits
+//
+// The bit stream is written in little-endian 64-bit words. Since only the bit patterns are used, NaN payloads (such as
+// R's NA) and negative zero are restored exactly.
+
+
+// Compress nrOfDoubles doubles into dst. Buffer dst should hold at least XOR_HEADER_SIZE + 8 * nrOfDoubles bytes.
+// When the bit stream is larger than the source, the block is stored unpacked. Returns the compressed size.
+unsigned int XorCompressDouble(char* dst, const double* doubleVec, unsigned int nrOfDoubles);
+
+
+// Decompress nrOfDoubles doubles, returns 0 on success
+unsigned int XorDecompressDouble(double* doubleVec, const char* src, unsigned int compressedSize, unsigned int nrOfDoubles);
+
+
+#endif  // XORDOUBLE_H
@@ -30,35 +30,96 @@
 using namespace std;
 
 void fdsWriteRealVec_v9(ofstream &myfile, double* doubleVector, unsigned long long nrOfRows, unsigned int compression,
-  std::string annotation, bool hasAnnotation)
+  const FstColumnWriteOptions &options, std::string annotation, bool hasAnnotation)
 {
-  int blockSize = 8 * BLOCKSIZE_REAL;  // block size in bytes
+  int blockSizeElems = options.BlockSizeElements(8, BLOCKSIZE_REAL);  // number of elements per block
+  int blockSize = 8 * blockSizeElems;  // block size in bytes
 
-  if (compression == 0)
+  if (options.codec == FstColumnCodec::LZ4 || options.codec == FstColumnCodec::ZSTD)  // codec set for the column
   {
-    return fdsStreamUncompressed_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, BLOCKSIZE_REAL, nullptr, annotation, hasAnnotation);
+    return fdsStreamCodec_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, options.codec, compression, blockSizeElems,
+      annotation, hasAnnotation);
   }
 
+  if (compression == 0)  // no compression requested, also with throughput targets
+  {
+    return fdsStreamUncompressed_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, blockSizeElems, nullptr, annotation, hasAnnotation);
+  }
+
+  if (options.autotune.IsSet())  // throughput targets: measured selection from fast to strong codecs
+  {
+    Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4, 100);
+    Compressor* compress2 = new SingleCompressor(CompAlgo::LZ4_SHUF8, 100);
+    Compressor* compress3 = new SingleCompressor(CompAlgo::ZSTD, 0);
+    Compressor* compress4 = new SingleCompressor(CompAlgo::ZSTD_SHUF8, 100);
+    Compressor* decimal1 = new DecimalDoubleCompressor(compress1, CompAlgo::DEC_DOUBLE, 0);
+    Compressor* decimal3 = new DecimalDoubleCompressor(compress3, CompAlgo::ZSTD_DEC_DOUBLE, 0);
+    Compressor* integral2 = new IntegralDoubleCompressor(compress2, CompAlgo::LZ4_INT_DOUBLE, 100);
+    Compressor* integral4 = new IntegralDoubleCompressor(compress4, CompAlgo::ZSTD_INT_DOUBLE, 100);
+    Compressor* xor1 = new SingleCompressor(CompAlgo::XOR_DOUBLE, 0);  // slowly varying series
+
+    Compressor* candidates[] = { decimal1, integral2, xor1, decimal3, integral4 };
+    fdsStreamAutotune_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, candidates, 5, options.autotune, blockSizeElems,
+      annotation, hasAnnotation);
+
+    delete compress1;
+    delete compress2;
+    delete compress3;
+    delete compress4;
+    delete decimal1;
+    delete decimal3;
+    delete integral2;
+    delete integral4;
+    delete xor1;
+    return;
+  }
+
+  // blocks with fixed-point values (all values equal k / 10^scale) are stored as bit-packed integers and blocks with
+  // whole numbers only (counts and identifiers) use the same narrowing codecs as integer64 columns
+
   if (compression <= 50)  // low compression: linear mix of uncompressed and LZ4
   {
     Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4, 50);
-    StreamCompressor* streamCompressor = new StreamLinearCompressor(compress1, 2 * compression);
+    Compressor* decimal1 = new DecimalDoubleCompressor(compress1, CompAlgo::DEC_DOUBLE, 0);
+    Compressor* integral1 = new IntegralDoubleCompressor(decimal1, CompAlgo::LZ4_INT_DOUBLE, 2 * compression);
+    StreamCompressor* streamCompressor = new StreamLinearCompressor(integral1, 2 * compression);
     streamCompressor->CompressBufferSize(blockSize);
-    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, streamCompressor, BLOCKSIZE_REAL, annotation, hasAnnotation);
+    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, streamCompressor, blockSizeElems, annotation, hasAnnotation);
 
     delete compress1;
+    delete decimal1;
+    delete integral1;
     delete streamCompressor;
     return;
   }
 
+  // high compression: per block selection from the candidates, incompressible blocks are stored as-is
   Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4, compression);
   Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD, compression - 50);
-  StreamCompressor* streamCompressor = new StreamCompositeCompressor(compress1, compress2, 2 * (compression - 50));
+  Compressor* decimal1 = new DecimalDoubleCompressor(compress1, CompAlgo::DEC_DOUBLE, 0);
+  Compressor* decimal2 = new DecimalDoubleCompressor(compress2, CompAlgo::ZSTD_DEC_DOUBLE, compression - 50);
+  Compressor* shuffle1 = new SingleCompressor(CompAlgo::LZ4_SHUF8, compression);
+  Compressor* shuffle2 = new SingleCompressor(CompAlgo::ZSTD_SHUF8, compression - 50);
+  Compressor* integral1 = new IntegralDoubleCompressor(shuffle1, CompAlgo::LZ4_INT_DOUBLE, 100);
+  Compressor* integral2 = new IntegralDoubleCompressor(shuffle2, CompAlgo::ZSTD_INT_DOUBLE, compression - 50);
+  Compressor* xor1 = new SingleCompressor(CompAlgo::XOR_DOUBLE, 0);  // slowly varying series
+
+  Compressor* candidates[] = { decimal1, integral1, xor1, decimal2, integral2 };
+  Compressor* adaptive = new AdaptiveCompressor(candidates, 5, 8, 2 * (compression - 50));
+  StreamCompressor* streamCompressor = new StreamSingleCompressor(adaptive);
   streamCompressor->CompressBufferSize(blockSize);
-  fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, streamCompressor, BLOCKSIZE_REAL, annotation, hasAnnotation);
+  fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, streamCompressor, blockSizeElems, annotation, hasAnnotation);
 
   delete compress1;
   delete compress2;
+  delete decimal1;
+  delete decimal2;
+  delete shuffle1;
+  delete shuffle2;
+  delete integral1;
+  delete integral2;
+  delete xor1;
+  delete adaptive;
   delete streamCompressor;
 
   return;
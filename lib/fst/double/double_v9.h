@@ -28,9 +28,11 @@
 #include <ostream>
 #include <istream>
 
+#include <interface/fstwriteoptions.h>
+
 
 void fdsWriteRealVec_v9(std::ofstream &myfile, double* doubleVector, unsigned long long nrOfRows, unsigned int compression,
-  std::string annotation, bool hasAnnotation);
+  const FstColumnWriteOptions &options, std::string annotation, bool hasAnnotation);
 
 void fdsReadRealVec_v9(std::istream &myfile, double* doubleVector, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size, std::string &annotation, bool &hasAnnotation);
@@ -35,6 +35,7 @@
 #include <character/character_v6.h>
 
 #include <compression/compressor.h>
+#include <compression/runlength.h>
 
 using namespace std;
 
@@ -63,7 +64,7 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
   {
 	  myfile.write(meta, HEADER_SIZE_FACTOR);  // number of levels
 	  *nrOfLevels = nrOfFactorLevels;
-	  fdsWriteCharVec_v6(myfile, blockRunner, compression, stringEncoding);   // factor levels
+	  fdsWriteCharVec_v6(myfile, blockRunner, compression, FstColumnCodec::DEFAULT, stringEncoding);   // factor levels
 
 	  // Rewrite meta-data
 	  *versionNr = VERSION_NUMBER_FACTOR;
@@ -128,13 +129,18 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
     {
       Compressor* defaultCompress = new SingleCompressor(CompAlgo::INT_TO_BYTE, 0);  // just pack the bytes
       Compressor* compress2 = new SingleCompressor(CompAlgo::LZ4_INT_TO_BYTE, compression);  // maximum compression of 80
-      StreamCompressor* streamCompressor = new StreamCompositeCompressor(defaultCompress, compress2, 2 * compression);
+      // blocks with long runs, such as sorted categories, are run-length encoded
+      Compressor* runCompress1 = new RunLengthCompressor(defaultCompress, RLE_MIN_RUN_LENGTH);
+      Compressor* runCompress2 = new RunLengthCompressor(compress2, RLE_MIN_RUN_LENGTH);
+      StreamCompressor* streamCompressor = new StreamCompositeCompressor(runCompress1, runCompress2, 2 * compression);
 
       streamCompressor->CompressBufferSize(blockSize);
 
       fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(intP), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, hasAnnotation);
 
       delete streamCompressor;
+      delete runCompress1;
+      delete runCompress2;
       delete compress2;
       delete defaultCompress;
 
@@ -143,13 +149,17 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
 
     Compressor* defaultCompress = new SingleCompressor(CompAlgo::LZ4_INT_TO_BYTE, compression);  // maximum LZ4 compression on smaller vectors
     Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD_INT_TO_BYTE, compression - 50);  // maximum compression of 80
-    StreamCompressor* streamCompressor = new StreamCompositeCompressor(defaultCompress, compress2, 2 * (compression - 50));
+    Compressor* runCompress1 = new RunLengthCompressor(defaultCompress, RLE_MIN_RUN_LENGTH);
+    Compressor* runCompress2 = new RunLengthCompressor(compress2, RLE_MIN_RUN_LENGTH);
+    StreamCompressor* streamCompressor = new StreamCompositeCompressor(runCompress1, runCompress2, 2 * (compression - 50));
 
     streamCompressor->CompressBufferSize(blockSize);
 
     fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(intP), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, hasAnnotation);
 
     delete streamCompressor;
+    delete runCompress1;
+    delete runCompress2;
     delete compress2;
     delete defaultCompress;
 
@@ -162,13 +172,17 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
     {
       Compressor* defaultCompress = new SingleCompressor(CompAlgo::LZ4_INT_TO_SHORT_SHUF2, 0);  // just pack the bytes
       Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD_INT_TO_SHORT_SHUF2, 0);  // maximum compression of 80
-      StreamCompressor* streamCompressor = new StreamCompositeCompressor(defaultCompress, compress2, 2 * compression);
+      Compressor* runCompress1 = new RunLengthCompressor(defaultCompress, RLE_MIN_RUN_LENGTH);
+      Compressor* runCompress2 = new RunLengthCompressor(compress2, RLE_MIN_RUN_LENGTH);
+      StreamCompressor* streamCompressor = new StreamCompositeCompressor(runCompress1, runCompress2, 2 * compression);
 
       streamCompressor->CompressBufferSize(blockSize);
 
       fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(intP), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, hasAnnotation);
 
       delete streamCompressor;
+      delete runCompress1;
+      delete runCompress2;
       delete compress2;
       delete defaultCompress;
 
@@ -177,13 +191,17 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
 
     Compressor* defaultCompress = new SingleCompressor(CompAlgo::ZSTD_INT_TO_SHORT_SHUF2, 0);  // maximum LZ4 compression on smaller vectors
     Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD_INT_TO_SHORT_SHUF2, compression - 50);  // maximum compression of 80
-    StreamCompressor* streamCompressor = new StreamCompositeCompressor(defaultCompress, compress2, 2 * (compression - 50));
+    Compressor* runCompress1 = new RunLengthCompressor(defaultCompress, RLE_MIN_RUN_LENGTH);
+    Compressor* runCompress2 = new RunLengthCompressor(compress2, RLE_MIN_RUN_LENGTH);
+    StreamCompressor* streamCompressor = new StreamCompositeCompressor(runCompress1, runCompress2, 2 * (compression - 50));
 
     streamCompressor->CompressBufferSize(blockSize);
 
     fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(intP), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, hasAnnotation);
 
     delete streamCompressor;
+    delete runCompress1;
+    delete runCompress2;
     delete compress2;
     delete defaultCompress;
 
@@ -195,25 +213,31 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
   if (compression <= 50)  // low compression: linear mix of uncompressed and LZ4_SHUF
   {
     Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_SHUF4, 0);
-    StreamCompressor* streamCompressor = new StreamLinearCompressor(compress1, 2 * compression);
+    Compressor* runCompress1 = new RunLengthCompressor(compress1, RLE_MIN_RUN_LENGTH);
+    StreamCompressor* streamCompressor = new StreamLinearCompressor(runCompress1, 2 * compression);
 
     streamCompressor->CompressBufferSize(blockSize);
     fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(intP), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, hasAnnotation);
 
     delete compress1;
     delete streamCompressor;
+    delete runCompress1;
     return;
   }
 
   Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_SHUF4, 0);
   Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD_SHUF4, 2 * (compression - 50));
-  StreamCompressor* streamCompressor = new StreamCompositeCompressor(compress1, compress2, 2 * (compression - 50));
+  Compressor* runCompress1 = new RunLengthCompressor(compress1, RLE_MIN_RUN_LENGTH);
+  Compressor* runCompress2 = new RunLengthCompressor(compress2, RLE_MIN_RUN_LENGTH);
+  StreamCompressor* streamCompressor = new StreamCompositeCompressor(runCompress1, runCompress2, 2 * (compression - 50));
   streamCompressor->CompressBufferSize(blockSize);
   fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(intP), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, hasAnnotation);
 
   delete compress1;
   delete compress2;
   delete streamCompressor;
+  delete runCompress1;
+  delete runCompress2;
 
   return;
 }
@@ -26,41 +26,92 @@
 #include <integer/integer_v8.h>
 #include <blockstreamer/blockstreamer_v2.h>
 #include <compression/compressor.h>
+#include <compression/runlength.h>
 
 using namespace std;
 
 
 void fdsWriteIntVec_v8(ofstream &myfile, int* integerVector, unsigned long long nrOfRows, unsigned int compression,
-  std::string annotation, bool hasAnnotation)
+  const FstColumnWriteOptions &options, std::string annotation, bool hasAnnotation)
 {
-  int blockSize = 4 * BLOCKSIZE_INT;  // block size in bytes
+  int blockSizeElems = options.BlockSizeElements(4, BLOCKSIZE_INT);  // number of elements per block
+  int blockSize = 4 * blockSizeElems;  // block size in bytes
 
-  if (compression == 0)
+  if (options.codec == FstColumnCodec::LZ4 || options.codec == FstColumnCodec::ZSTD)  // codec set for the column
   {
-    return fdsStreamUncompressed_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, BLOCKSIZE_INT, nullptr, annotation, hasAnnotation);
+    return fdsStreamCodec_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, options.codec, compression, blockSizeElems,
+      annotation, hasAnnotation);
+  }
+
+  if (compression == 0)  // no compression requested, also with throughput targets
+  {
+    return fdsStreamUncompressed_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, blockSizeElems, nullptr, annotation, hasAnnotation);
+  }
+
+  if (options.autotune.IsSet())  // throughput targets: measured selection from fast to strong codecs
+  {
+    Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_SHUF4, 0);
+    Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD_SHUF4, 0);
+    Compressor* compress3 = new SingleCompressor(CompAlgo::ZSTD_SHUF4, 50);
+    Compressor* compress4 = new SingleCompressor(CompAlgo::ZSTD_SHUF4, 100);
+    Compressor* runCompress1 = new RunLengthCompressor(compress1, RLE_MIN_RUN_LENGTH);
+    Compressor* runCompress2 = new RunLengthCompressor(compress2, RLE_MIN_RUN_LENGTH);
+    Compressor* runCompress3 = new RunLengthCompressor(compress3, RLE_MIN_RUN_LENGTH);
+    Compressor* runCompress4 = new RunLengthCompressor(compress4, RLE_MIN_RUN_LENGTH);
+    Compressor* frame1 = new SingleCompressor(CompAlgo::LZ4_FOR_INT, 100);  // small value ranges
+
+    Compressor* candidates[] = { runCompress1, frame1, runCompress2, runCompress3, runCompress4 };
+    fdsStreamAutotune_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, candidates, 5, options.autotune, blockSizeElems,
+      annotation, hasAnnotation);
+
+    delete frame1;
+    delete compress1;
+    delete compress2;
+    delete compress3;
+    delete compress4;
+    delete runCompress1;
+    delete runCompress2;
+    delete runCompress3;
+    delete runCompress4;
+    return;
   }
 
   if (compression <= 50)  // low compression: linear mix of uncompressed and LZ4_SHUF
   {
     Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_SHUF4, 0);
-    StreamCompressor* streamCompressor = new StreamLinearCompressor(compress1, 2 * compression);
+    Compressor* runCompress1 = new RunLengthCompressor(compress1, RLE_MIN_RUN_LENGTH);  // sorted or constant blocks
+    StreamCompressor* streamCompressor = new StreamLinearCompressor(runCompress1, 2 * compression);
 
     streamCompressor->CompressBufferSize(blockSize);
-    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, hasAnnotation);
+    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, streamCompressor, blockSizeElems, annotation, hasAnnotation);
 
     delete compress1;
+    delete runCompress1;
     delete streamCompressor;
     return;
   }
 
-  Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_SHUF4, 0);
+  // high compression: per block selection from the candidates, incompressible blocks are stored as-is
+  Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_SHUF4, 100);  // no acceleration, so a sample trial predicts the block
   Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD_SHUF4, 2 * (compression - 50));
-  StreamCompressor* streamCompressor = new StreamCompositeCompressor(compress1, compress2, 2 * (compression - 50));
+  Compressor* runCompress1 = new RunLengthCompressor(compress1, RLE_MIN_RUN_LENGTH);
+  Compressor* runCompress2 = new RunLengthCompressor(compress2, RLE_MIN_RUN_LENGTH);
+  Compressor* frame1 = new SingleCompressor(CompAlgo::LZ4_FOR_INT, 100);
+  Compressor* frame2 = new SingleCompressor(CompAlgo::ZSTD_FOR_INT, 2 * (compression - 50));
+
+  Compressor* candidates[] = { runCompress1, frame1, runCompress2, frame2 };
+  Compressor* adaptive = new AdaptiveCompressor(candidates, 4, 4, 2 * (compression - 50));
+  StreamCompressor* streamCompressor = new StreamSingleCompressor(adaptive);
   streamCompressor->CompressBufferSize(blockSize);
-  fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, hasAnnotation);
+  fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, streamCompressor, blockSizeElems, annotation, hasAnnotation);
 
   delete compress1;
   delete compress2;
+  delete runCompress1;
+  delete runCompress2;
+  delete frame1;
+  delete frame2;
+  delete adaptive;
   delete streamCompressor;
 
   return;
@@ -28,9 +28,11 @@
 #include <ostream>
 #include <istream>
 
+#include <interface/fstwriteoptions.h>
+
 
 void fdsWriteIntVec_v8(std::ofstream &myfile, int* integerVector, unsigned long long nrOfRows, unsigned int compression,
-  std::string annotation, bool hasAnnotation);
+  const FstColumnWriteOptions &options, std::string annotation, bool hasAnnotation);
 
 void fdsReadIntVec_v8(std::istream &myfile, int* integerVector, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size, std::string &annotation, bool &hasAnnotation);
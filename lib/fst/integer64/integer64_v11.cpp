@@ -31,37 +31,69 @@ using namespace std;
 
 
 void fdsWriteInt64Vec_v11(ofstream &myfile, long long* int64Vector, unsigned long long nrOfRows, unsigned int compression,
-  std::string annotation, bool hasAnnotation)
+  const FstColumnWriteOptions &options, std::string annotation, bool hasAnnotation)
 {
-  int blockSize = 8 * BLOCKSIZE_INT64;  // block size in bytes
+  int blockSizeElems = options.BlockSizeElements(8, BLOCKSIZE_INT64);  // number of elements per block
+  int blockSize = 8 * blockSizeElems;  // block size in bytes
 
-  if (compression == 0)
+  if (options.codec == FstColumnCodec::LZ4 || options.codec == FstColumnCodec::ZSTD)  // codec set for the column
   {
-    return fdsStreamUncompressed_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, BLOCKSIZE_INT64, nullptr, annotation, hasAnnotation);
+    return fdsStreamCodec_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, options.codec, compression, blockSizeElems,
+      annotation, hasAnnotation);
   }
 
-  if (compression <= 50)  // low compression: linear mix of uncompressed and LZ4_SHUF8
+  if (compression == 0)  // no compression requested, also with throughput targets
   {
-    Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_SHUF8, 2 * compression);
+    return fdsStreamUncompressed_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, blockSizeElems, nullptr, annotation, hasAnnotation);
+  }
+
+  if (options.autotune.IsSet())  // throughput targets: measured selection from fast to strong codecs
+  {
+    Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_NARROW_INT64, 100);
+    Compressor* compress2 = new SingleCompressor(CompAlgo::LZ4_FOR_INT64, 100);
+    Compressor* compress3 = new SingleCompressor(CompAlgo::ZSTD_NARROW_INT64, 0);
+    Compressor* compress4 = new SingleCompressor(CompAlgo::ZSTD_NARROW_INT64, 100);
+
+    Compressor* candidates[] = { compress1, compress2, compress3, compress4 };
+    fdsStreamAutotune_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, candidates, 4, options.autotune, blockSizeElems,
+      annotation, hasAnnotation);
+
+    delete compress1;
+    delete compress2;
+    delete compress3;
+    delete compress4;
+    return;
+  }
+
+  if (compression <= 50)  // low compression: linear mix of uncompressed and LZ4_NARROW_INT64
+  {
+    Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_NARROW_INT64, 2 * compression);
     StreamCompressor* streamCompressor = new StreamLinearCompressor(compress1, 2 * compression);
     streamCompressor->CompressBufferSize(blockSize);
-    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, streamCompressor, BLOCKSIZE_INT64, annotation, hasAnnotation);
+    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, streamCompressor, blockSizeElems, annotation, hasAnnotation);
 
     delete compress1;
     delete streamCompressor;
     return;
   }
 
-  // higher compression: linear mix of LZ4_SHUF8 and ZSTD_SHUF8
+  // high compression: per block selection from the candidates, incompressible blocks are stored as-is
+  Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_NARROW_INT64, 100);
+  Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD_NARROW_INT64, compression - 50);
+  Compressor* frame1 = new SingleCompressor(CompAlgo::LZ4_FOR_INT64, 100);
+  Compressor* frame2 = new SingleCompressor(CompAlgo::ZSTD_FOR_INT64, compression - 50);
 
-  Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_SHUF8, 100);
-  Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD_SHUF8, compression - 50);
-  StreamCompressor* streamCompressor = new StreamCompositeCompressor(compress1, compress2, 2 * (compression - 50));
+  Compressor* candidates[] = { compress1, frame1, compress2, frame2 };
+  Compressor* adaptive = new AdaptiveCompressor(candidates, 4, 8, 2 * (compression - 50));
+  StreamCompressor* streamCompressor = new StreamSingleCompressor(adaptive);
   streamCompressor->CompressBufferSize(blockSize);
-  fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, streamCompressor, BLOCKSIZE_INT64, annotation, hasAnnotation);
+  fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, streamCompressor, blockSizeElems, annotation, hasAnnotation);
 
   delete compress1;
   delete compress2;
+  delete frame1;
+  delete frame2;
+  delete adaptive;
   delete streamCompressor;
 
   return;
@@ -27,9 +27,11 @@
 // System libraries
 #include <ostream>
 
+#include <interface/fstwriteoptions.h>
+
 
 void fdsWriteInt64Vec_v11(std::ofstream &myfile, long long* int64Vector, unsigned long long nrOfRows, unsigned int compression,
-  std::string annotation, bool hasAnnotation);
+  const FstColumnWriteOptions &options, std::string annotation, bool hasAnnotation);
 
 void fdsReadInt64Vec_v11(std::istream &myfile, long long* int64Vector, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size);
@@ -0,0 +1,51 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+#ifndef FST_AUTOTUNE_H
+#define FST_AUTOTUNE_H
+
+
+/**
+ * \brief Throughput targets for writing a dataset. When a target is set, integer, integer64 and double columns
+ * measure the speed and ratio of a range of codecs on the first blocks of the column and use the codec with the best
+ * ratio that meets the targets, instead of the codec mix set by the compression factor. Columns at compression level 0
+ * or with codec NONE are stored uncompressed.
+ */
+struct FstAutotune
+{
+  double writeSpeed;  // target compression speed in MB/s of uncompressed data, 0 for no target
+  double readSpeed;  // target decompression speed in MB/s of uncompressed data, 0 for no target
+
+  FstAutotune() : writeSpeed(0.0), readSpeed(0.0) { }
+
+  FstAutotune(double writeSpeed, double readSpeed) : writeSpeed(writeSpeed), readSpeed(readSpeed) { }
+
+  /**
+   * \brief Check if any throughput target is set.
+   */
+  bool IsSet() const { return writeSpeed > 0.0 || readSpeed > 0.0; }
+};
+
+
+#endif  // FST_AUTOTUNE_H
@@ -30,7 +30,7 @@
 
 // Version of fst format
 #define FST_VERSION_MAJOR    0                  // for breaking interface changes
-#define FST_VERSION_MINOR    1                  // for new (non-breaking) interface capabilities
+#define FST_VERSION_MINOR    2                  // for new (non-breaking) interface capabilities
 #define FST_VERSION_RELEASE  5                  // for tweaks, bug-fixes, or development
 
 // Note that the release version number can change without affecting read/write cycles
@@ -46,10 +46,18 @@
 #define DATA_INDEX_SIZE      24                 // size of data index header
 #define CHAR_HEADER_SIZE     8                  // meta data header size
 #define CHAR_INDEX_SIZE      16                 // size of 1 index entry
+#define CHAR_DICT_HEADER_SIZE 16                // dictionary header: number of levels, reserved and code vector offset
+#define CHAR_ZSTD_DICT_HEADER_SIZE 8            // trained ZSTD dictionary header: dictionary size and reserved
 #define BASIC_HEAP_SIZE      1048576            // starting size of heap buffer
 
 // Format flags
 #define FLAG_INDIRECT_HEADER 1                  // Next value is the absolute position of the extended header
+#define CHAR_FLAG_DICTIONARY 16                 // Character column is stored as a level vector and integer codes
+#define CHAR_FLAG_ZSTD_DICT  32                 // ZSTD blocks of the character column use a trained dictionary
+#define CHAR_FLAG_COMPACT_META 64               // String lengths are stored instead of cumulative sizes, NA bits only when present
+#define CHAR_INDEX_FLAG_NA   0x8000             // Set in the integer algorithm of a compact block index entry when NA bits are stored
+#define CHAR_FLAG_BYTE_BLOCKS 128               // Blocks close on a byte budget, the header holds the number of blocks and a row index follows the block index
+#define CHAR_INDEX_FLAG_FRONT_CODED 0x4000      // Set in the integer algorithm of a compact block index entry when strings are front coded
 
 // Read batch sizes per type
 #define BATCH_SIZE_READ_INT             25
@@ -58,6 +66,7 @@
 #define BATCH_SIZE_READ_FACTOR          25
 #define BATCH_SIZE_READ_DOUBLE          25
 #define BATCH_SIZE_READ_BYTE            25
+#define BATCH_SIZE_READ_CHAR            4                             // number of character blocks per thread
 
 // Cache-size related defines
 #define CACHEFACTOR                     1
@@ -67,6 +76,16 @@
 #define HASH_SIZE                       4096                          // number of bytes in default compression block
 #define MAX_CHAR_STACK_SIZE             32768                         // number of characters in default compression block
 #define BLOCKSIZE_CHAR                  2047                          // number of characters in default compression block
+#define CHAR_BLOCK_BYTE_BUDGET          65536                         // number of bytes of string data in a byte budgeted character block
+#define CHAR_BLOCK_MAX_ELEMENTS         16384                         // maximum number of strings in a byte budgeted character block
+#define CHAR_FRONT_RESTART              16                            // front coded strings are stored in full at every 16th string of a block
+#define CHAR_FRONT_MIN_RATIO            8                             // front code a block when shared prefixes hold at least 1 / 8 of the string data
+#define CHAR_DICT_MAX_RATIO             8                             // dictionary encode when the number of distinct strings is at most 1 / 8 of the rows
+#define CHAR_ZSTD_DICT_CAPACITY         16384                         // maximum size of a trained ZSTD dictionary for character blocks
+#define CHAR_ZSTD_DICT_RATIO            64                            // size of a trained ZSTD dictionary is at most 1 / 64 of the column
+#define CHAR_ZSTD_DICT_MIN_BLOCKS       4                             // minimum number of character blocks to train a ZSTD dictionary
+#define CHAR_ZSTD_DICT_SAMPLE_BLOCKS    16                            // number of character blocks sampled for dictionary training
+#define CHAR_ZSTD_DICT_SAMPLE_SIZE      256                           // minimum number of bytes in a single training sample
 #define BLOCK_SIZE_BYTE_BLOCK           2048                          // number of bytes in byte block compression block
 #define PREF_BLOCK_SIZE                 (16384 * CACHEFACTOR)         // BlockStreamer
 #define MAX_SIZE_COMPRESS_BLOCK         (16384 * CACHEFACTOR)         // Compression
@@ -80,6 +99,8 @@
 #define BLOCKSIZE_INT64                 (2048 * CACHEFACTOR)          // number of long long in default compression block
 #define BLOCKSIZE_INT                   (4096 * CACHEFACTOR)          // number of integers in default compression block
 #define BLOCKSIZE_BYTE                  (16384 * CACHEFACTOR)         // number of bytes in default compression block
+#define BLOCKSIZE_MIN                   1024                          // minimum number of bytes in a custom compression block
+#define BLOCKSIZE_MAX                   (16 * 1048576)                // maximum number of bytes in a custom compression block
 
 // fst specific errors
 #define FSTERROR_NOT_IMPLEMENTED     "Feature not implemented yet"
@@ -102,5 +123,6 @@
 #define FSTERROR_COMP_FUTURE_VERSION "Data has been compressed with a newer version than the current."
 
 #define FST_NA_INT					         0x80000000
+#define FST_NA_INT64                 0x8000000000000000ULL
 
 #endif // FSTDEFINES_H
@@ -36,6 +36,7 @@
 #include <interface/fststore.h>
 
 #include <character/character_v6.h>
+#include <character/chardict_v6.h>
 #include <factor/factor_v7.h>
 #include <integer/integer_v8.h>
 #include <double/double_v9.h>
@@ -212,6 +213,30 @@ inline void SetKeyIndex(vector<int> &keyIndex, const int keyLength, const int nr
  * \param compress compression factor in the range 0 - 100
  */
 void FstStore::fstWrite(IFstTable &fstTable, const int compress) const
+{
+  fstWrite(fstTable, compress, std::vector<FstColumnWriteOptions>());
+}
+
+
+/**
+ * \brief Write a dataset to a fst file
+ * \param fstTable interface to a dataset
+ * \param compress compression factor in the range 0 - 100
+ * \param autotune throughput targets for integer, integer64 and double columns
+ */
+void FstStore::fstWrite(IFstTable &fstTable, const int compress, const FstAutotune &autotune) const
+{
+  fstWrite(fstTable, compress, std::vector<FstColumnWriteOptions>(fstTable.NrOfColumns(), FstColumnWriteOptions(autotune)));
+}
+
+
+/**
+ * \brief Write a dataset to a fst file
+ * \param fstTable interface to a dataset
+ * \param compress compression factor in the range 0 - 100
+ * \param columnOptions write options per column
+ */
+void FstStore::fstWrite(IFstTable &fstTable, const int compress, const std::vector<FstColumnWriteOptions> &columnOptions) const
 {
   // Meta on dataset
   const int nrOfCols =  fstTable.NrOfColumns();  // number of columns in table
@@ -370,7 +395,7 @@ void FstStore::fstWrite(IFstTable &fstTable, const int compress) const
   {
     std::unique_ptr<IStringWriter> blockRunnerP(fstTable.GetColNameWriter());
     IStringWriter* blockRunner = blockRunnerP.get();
-    fdsWriteCharVec_v6(myfile, blockRunner, 0, blockRunner->Encoding());   // column names
+    fdsWriteCharVec_v6(myfile, blockRunner, 0, FstColumnCodec::DEFAULT, blockRunner->Encoding());   // column names
   }
 
   // Size of chunkset index header plus data chunk header
@@ -434,6 +459,10 @@ void FstStore::fstWrite(IFstTable &fstTable, const int compress) const
   	// get type and add annotation
     const FstColumnType colType = fstTable.ColumnType(colNr, colAttribute, scale, annotation, hasAnnotation);
 
+    // column specific codec and compression level
+    FstColumnWriteOptions options = static_cast<size_t>(colNr) < columnOptions.size() ? columnOptions[colNr] : FstColumnWriteOptions();
+    const int colCompress = options.Compression(compress);
+
     colBaseTypes[colNr] = static_cast<unsigned short int>(colType);
   	colAttributeTypes[colNr] = static_cast<unsigned short int>(colAttribute);
     colScales[colNr] = scale;
@@ -445,7 +474,10 @@ void FstStore::fstWrite(IFstTable &fstTable, const int compress) const
         colTypes[colNr] = 6;
         std::unique_ptr<IStringWriter> stringWriterP(fstTable.GetStringWriter(colNr));
      		IStringWriter* stringWriter = stringWriterP.get();  // TODO: keep writer as part of fstTable (don't create)
-        fdsWriteCharVec_v6(myfile, stringWriter, compress, stringWriter->Encoding());   // column names
+
+        // key columns are sorted, so neighbouring strings share prefixes
+        bool isKey = std::find(keyColPos, keyColPos + keyLength, colNr) != keyColPos + keyLength;
+        fdsWriteCharVec_v6(myfile, stringWriter, colCompress, options.codec, stringWriter->Encoding(), isKey);
         break;
       }
 
@@ -456,7 +488,7 @@ void FstStore::fstWrite(IFstTable &fstTable, const int compress) const
 
         std::unique_ptr<IStringWriter> stringWriterP(fstTable.GetLevelWriter(colNr));
      		IStringWriter* stringWriter = stringWriterP.get();
-        fdsWriteFactorVec_v7(myfile, intP, stringWriter, nrOfRows, compress, stringWriter->Encoding(), annotation, hasAnnotation);
+        fdsWriteFactorVec_v7(myfile, intP, stringWriter, nrOfRows, colCompress, stringWriter->Encoding(), annotation, hasAnnotation);
         break;
       }
 
@@ -464,7 +496,7 @@ void FstStore::fstWrite(IFstTable &fstTable, const int compress) const
       {
         colTypes[colNr] = 8;
         int* intP = fstTable.GetIntWriter(colNr);
-        fdsWriteIntVec_v8(myfile, intP, nrOfRows, compress, annotation, hasAnnotation);
+        fdsWriteIntVec_v8(myfile, intP, nrOfRows, colCompress, options, annotation, hasAnnotation);
         break;
       }
 
@@ -472,7 +504,7 @@ void FstStore::fstWrite(IFstTable &fstTable, const int compress) const
       {
         colTypes[colNr] = 9;
         double* doubleP = fstTable.GetDoubleWriter(colNr);
-        fdsWriteRealVec_v9(myfile, doubleP, nrOfRows, compress, annotation, hasAnnotation);
+        fdsWriteRealVec_v9(myfile, doubleP, nrOfRows, colCompress, options, annotation, hasAnnotation);
         break;
       }
 
@@ -480,7 +512,7 @@ void FstStore::fstWrite(IFstTable &fstTable, const int compress) const
       {
         colTypes[colNr] = 10;
         int* intP = fstTable.GetLogicalWriter(colNr);
-        fdsWriteLogicalVec_v10(myfile, intP, nrOfRows, compress, annotation, hasAnnotation);
+        fdsWriteLogicalVec_v10(myfile, intP, nrOfRows, colCompress, annotation, hasAnnotation);
         break;
       }
 
@@ -488,7 +520,7 @@ void FstStore::fstWrite(IFstTable &fstTable, const int compress) const
       {
         colTypes[colNr] = 11;
         long long* intP = fstTable.GetInt64Writer(colNr);
-        fdsWriteInt64Vec_v11(myfile, intP, nrOfRows, compress, annotation, hasAnnotation);
+        fdsWriteInt64Vec_v11(myfile, intP, nrOfRows, colCompress, options, annotation, hasAnnotation);
         break;
       }
 
@@ -496,7 +528,7 @@ void FstStore::fstWrite(IFstTable &fstTable, const int compress) const
 	  {
 		  colTypes[colNr] = 12;
 		  char* byteP = fstTable.GetByteWriter(colNr);
-		  fdsWriteByteVec_v12(myfile, byteP, nrOfRows, compress, annotation, hasAnnotation);
+		  fdsWriteByteVec_v12(myfile, byteP, nrOfRows, colCompress, annotation, hasAnnotation);
 		  break;
 	  }
 
@@ -504,7 +536,7 @@ void FstStore::fstWrite(IFstTable &fstTable, const int compress) const
     {
         colTypes[colNr] = 13;
         IByteBlockColumn* p_byte_block = fstTable.GetByteBlockWriter(colNr);
-        fdsWriteByteBlockVec_v13(myfile, p_byte_block, nrOfRows, static_cast<uint32_t>(compress));
+        fdsWriteByteBlockVec_v13(myfile, p_byte_block, nrOfRows, static_cast<uint32_t>(colCompress));
         break;
     }
 
@@ -898,7 +930,22 @@ void FstStore::fstRead(IFstTable &tableReader, IStringArray* columnSelection, co
     // Character vector
       case 6:
       {
-        std::unique_ptr<IStringColumn> stringColumnP(columnFactory->CreateStringColumn(length, static_cast<FstColumnAttribute>(colAttributeTypes[colNr])));
+        FstColumnAttribute col_attribute = static_cast<FstColumnAttribute>(colAttributeTypes[colNr]);
+        unsigned int nrOfLevels;
+
+        // hand codes and levels of a dictionary encoded column to a factor column if requested
+        if (length > 0 && columnFactory->CharDictionaryAsFactor(col_attribute) && fdsCharVecIsDictionary_v6(myfile, pos, nrOfLevels))
+        {
+          std::unique_ptr<IFactorColumn> factorColumnP(columnFactory->CreateFactorColumn(length, nrOfLevels, FstColumnAttribute::FACTOR_BASE));
+          IFactorColumn* factorColumn = factorColumnP.get();
+
+          tableReader.SetFactorColumn(factorColumn, colSel);
+          fdsReadCharDictFactor_v6(myfile, factorColumn, pos, firstRow, length, nrOfRows);
+
+          break;
+        }
+
+        std::unique_ptr<IStringColumn> stringColumnP(columnFactory->CreateStringColumn(length, col_attribute));
         IStringColumn* stringColumn = stringColumnP.get();
 
         stringColumn->AllocateVec(static_cast<uint64_t>(length));
@@ -29,6 +29,7 @@
 #include <vector>
 #include <memory>
 
+#include <interface/fstwriteoptions.h>
 #include <interface/icolumnfactory.h>
 #include <interface/ifsttable.h>
 
@@ -64,6 +65,23 @@ class FstStore
      */
     void fstWrite(IFstTable &fstTable, int compress) const;
 
+	/**
+     * \brief Stream a data table with throughput targets
+     * \param fstTable Table to stream, implementation of IFstTable interface
+     * \param compress Compression factor with a value 0-100, used for columns without autotuning. At 0 all columns
+     * are stored uncompressed and the targets are ignored
+     * \param autotune Write and read throughput targets for integer, integer64 and double columns
+     */
+    void fstWrite(IFstTable &fstTable, int compress, const FstAutotune &autotune) const;
+
+	/**
+     * \brief Stream a data table with per column write options
+     * \param fstTable Table to stream, implementation of IFstTable interface
+     * \param compress Compression factor with a value 0-100, used for columns without a compression level
+     * \param columnOptions Write options per column, columns without an element use the default options
+     */
+    void fstWrite(IFstTable &fstTable, int compress, const std::vector<FstColumnWriteOptions> &columnOptions) const;
+
     void fstMeta(IColumnFactory* columnFactory, IStringColumn* col_names);
 
     void fstRead(IFstTable &tableReader, IStringArray* columnSelection, long long startRow, long long endRow,
@@ -0,0 +1,93 @@
+/*
+  fstlib - A C++ library for ultra fast storage and retrieval of datasets
+
+  Copyright (C) 2017-present, Mark AJ Klik
+
+  This file is part of fstlib.
+
+  fstlib is free software: you can redistribute it and/or modify it under the
+  terms of the GNU Affero General Public License version 3 as published by the
+  Free Software Foundation.
+
+  fstlib is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU Affero General Public License for more
+  details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with fstlib. If not, see <http://www.gnu.org/licenses/>.
+
+  You can contact the author at:
+  - fstlib source repository : https://github.com/fstpackage/fstlib
+*/
+
+
+#ifndef FST_WRITE_OPTIONS_H
+#define FST_WRITE_OPTIONS_H
+
+
+#include <interface/fstautotune.h>
+#include <interface/fstdefines.h>
+
+
+/**
+ * \brief Codec family used for all blocks of a column.
+ */
+enum class FstColumnCodec
+{
+  DEFAULT = 0,  // codec mix determined by the compression level
+  NONE,         // uncompressed
+  LZ4,          // LZ4 (byte shuffled for integer, integer64 and double columns)
+  ZSTD          // ZSTD (byte shuffled for integer, integer64 and double columns)
+};
+
+
+/**
+ * \brief Write options for a single column. Default options use the compression level of the table write.
+ * The LZ4 and ZSTD codecs are used by integer, integer64, double and character columns; other columns use
+ * the compression level only and store NONE columns at compression level 0.
+ * The block size is used by integer, integer64 and double columns: large blocks give better compression ratios
+ * and smaller block indices for full column scans, small blocks are faster for reading a few rows.
+ */
+struct FstColumnWriteOptions
+{
+  FstColumnCodec codec;
+  int compression;  // compression level 0 - 100, -1 to use the compression level of the table write
+  FstAutotune autotune;  // throughput targets for compressed integer, integer64 and double columns without a codec
+  unsigned int blockSize;  // block size in bytes, 0 to use the default block size of the column type
+
+  FstColumnWriteOptions() : codec(FstColumnCodec::DEFAULT), compression(-1), blockSize(0) { }
+
+  FstColumnWriteOptions(FstColumnCodec codec, int compression, unsigned int blockSize = 0) : codec(codec),
+    compression(compression), blockSize(blockSize) { }
+
+  explicit FstColumnWriteOptions(const FstAutotune &autotune) : codec(FstColumnCodec::DEFAULT), compression(-1),
+    autotune(autotune), blockSize(0) { }
+
+  /**
+   * \brief Compression level of the column.
+   * \param tableCompression compression level of the table write.
+   */
+  int Compression(int tableCompression) const
+  {
+    if (codec == FstColumnCodec::NONE) return 0;
+
+    return compression < 0 ? tableCompression : compression;
+  }
+
+  /**
+   * \brief Number of elements in a block of the column, the block size is limited to BLOCKSIZE_MIN - BLOCKSIZE_MAX bytes.
+   * \param elementSize size of a single element in bytes.
+   * \param defaultElements number of elements in a default block of the column type.
+   */
+  int BlockSizeElements(int elementSize, int defaultElements) const
+  {
+    if (blockSize == 0) return defaultElements;
+
+    unsigned int size = blockSize < BLOCKSIZE_MIN ? BLOCKSIZE_MIN : (blockSize > BLOCKSIZE_MAX ? BLOCKSIZE_MAX : blockSize);
+    return static_cast<int>(size / elementSize);
+  }
+};
+
+
+#endif  // FST_WRITE_OPTIONS_H
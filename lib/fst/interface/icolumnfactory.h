@@ -40,6 +40,10 @@ public:
   virtual IInt64Column* CreateInt64Column(uint64_t nrOfRows, FstColumnAttribute columnAttribute, short int scale) = 0;
   virtual IStringColumn* CreateStringColumn(uint64_t nrOfRows, FstColumnAttribute columnAttribute) = 0;
   virtual IStringArray* CreateStringArray() = 0;
+
+  // Dictionary encoded character columns are read as a factor column (codes and levels) when true, which avoids the
+  // creation of a string per row. By default the codes are expanded to a character column.
+  virtual bool CharDictionaryAsFactor(FstColumnAttribute columnAttribute) { return false; }
 };
 
 #endif // IFST_COLUMN_FACTORY_H
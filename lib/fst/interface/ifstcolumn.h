@@ -151,6 +151,13 @@ public:
 
   virtual StringEncoding GetEncoding() = 0;
 
+  /**
+   * \brief Receive elements [startElem, endElem] of a decoded character block. Blocks are delivered from the calling
+   * thread in increasing vecOffset order, so an implementation can append the block data to offset and data buffers.
+   * \param nrOfElements number of elements in the block.
+   * \param sizeMeta cumulative string lengths (string offsets) followed by the NA bits of the block.
+   * \param buf string data of the block, only valid during the call.
+   */
   virtual void BufferToVec(uint64_t nrOfElements, uint64_t startElem, uint64_t endElem,
 	  uint64_t vecOffset, unsigned int* sizeMeta, char* buf) = 0;
 
@@ -47,6 +47,20 @@ public:
   virtual StringEncoding Encoding() = 0;
 
   virtual void SetBuffersFromVec(uint64_t startCount, uint64_t endCount) = 0;
+
+  /**
+   * \brief Set pointers to and sizes of elements [startCount, endCount) and the NA bits of that range. The caller
+   * copies the strings directly, so writers implementing this method need no intermediate string buffer.
+   * \param elements array of endCount - startCount pointers to the string data.
+   * \param sizes array of endCount - startCount string sizes (not cumulative).
+   * \param naInts NA bits, with the NA present flag after the last element, as set by SetBuffersFromVec.
+   * \return false if element access is not supported, SetBuffersFromVec is used instead.
+   */
+  virtual bool SetElementViews(uint64_t startCount, uint64_t endCount, const char** elements, unsigned int* sizes,
+    unsigned int* naInts)
+  {
+    return false;
+  }
 };
 
 
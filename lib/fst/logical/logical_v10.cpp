@@ -24,6 +24,7 @@
 #include <logical/logical_v10.h>
 #include <blockstreamer/blockstreamer_v2.h>
 #include <compression/compressor.h>
+#include <compression/runlength.h>
 
 #define BLOCKSIZE_LOGICAL 4096  // number of logicals in default compression block
 
@@ -42,13 +43,19 @@ void fdsWriteLogicalVec_v10(ofstream &myfile, int* boolVector, unsigned long lon
   {
     Compressor* defaultCompress = new SingleCompressor(CompAlgo::LOGIC64, 0);  // compression not relevant here
     Compressor* compress2 = new SingleCompressor(CompAlgo::LZ4_LOGIC64, 100);  // use maximum compression for LZ4 algorithm
-    StreamCompressor* streamCompressor = new StreamCompositeCompressor(defaultCompress, compress2, 2 * compression);
+
+    // blocks with long runs are run-length encoded
+    Compressor* runCompress1 = new RunLengthCompressor(defaultCompress, RLE_MIN_RUN_LENGTH);
+    Compressor* runCompress2 = new RunLengthCompressor(compress2, RLE_MIN_RUN_LENGTH);
+    StreamCompressor* streamCompressor = new StreamCompositeCompressor(runCompress1, runCompress2, 2 * compression);
     streamCompressor->CompressBufferSize(blockSize);
 
     fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(boolVector), nrOfLogicals, 4, streamCompressor, BLOCKSIZE_LOGICAL, annotation, hasAnnotation);
 
     delete defaultCompress;
     delete compress2;
+    delete runCompress1;
+    delete runCompress2;
     delete streamCompressor;
 
     return;
@@ -57,12 +64,16 @@ void fdsWriteLogicalVec_v10(ofstream &myfile, int* boolVector, unsigned long lon
   {
     Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_LOGIC64, 100);
     Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD_LOGIC64, 2 * (compression - 50));
-    StreamCompressor* streamCompressor = new StreamCompositeCompressor(compress1, compress2, 2 * (compression - 50));
+    Compressor* runCompress1 = new RunLengthCompressor(compress1, RLE_MIN_RUN_LENGTH);
+    Compressor* runCompress2 = new RunLengthCompressor(compress2, RLE_MIN_RUN_LENGTH);
+    StreamCompressor* streamCompressor = new StreamCompositeCompressor(runCompress1, runCompress2, 2 * (compression - 50));
     streamCompressor->CompressBufferSize(blockSize);
     fdsStreamcompressed_v2(myfile, (char*) boolVector, nrOfLogicals, 4, streamCompressor, BLOCKSIZE_LOGICAL, annotation, hasAnnotation);
 
     delete compress1;
     delete compress2;
+    delete runCompress1;
+    delete runCompress2;
     delete streamCompressor;
   }
 
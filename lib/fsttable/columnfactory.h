@@ -10,6 +10,17 @@
 
 class ColumnFactory : public IColumnFactory
 {
+	bool charDictionaryAsFactor;
+	bool charAsBuffers;
+
+public:
+	// with charAsBuffers, character columns are read into Arrow compatible offset and data buffers
+	ColumnFactory(bool charDictionaryAsFactor = false, bool charAsBuffers = false) :
+		charDictionaryAsFactor(charDictionaryAsFactor), charAsBuffers(charAsBuffers)
+	{
+	}
+
+private:
 	// Inherited via IColumnFactory
 	IFactorColumn* CreateFactorColumn(uint64_t nrOfRows, uint64_t nrOfLevels, FstColumnAttribute columnAttribute)
 	{
@@ -43,6 +54,8 @@ class ColumnFactory : public IColumnFactory
 
 	IStringColumn* CreateStringColumn(uint64_t nrOfRows, FstColumnAttribute columnAttribute)
 	{
+		if (charAsBuffers) return new StringBufferColumn();
+
 		return new StringColumn();
 	}
 
@@ -50,6 +63,11 @@ class ColumnFactory : public IColumnFactory
 	{
 		return nullptr;
 	}
+
+	bool CharDictionaryAsFactor(FstColumnAttribute columnAttribute)
+	{
+		return charDictionaryAsFactor;
+	}
 };
 
 
@@ -170,3 +170,57 @@ const char * StringColumn::GetElement(uint64_t elementNr)
 	return (*shared_data->StrVec())[elementNr].c_str();
 }
 
+
+void StringBufferColumn::AllocateVec(uint64_t vecLength)
+{
+	shared_data = make_shared<StringBufferVector>(vecLength);
+	vecPos = 0;
+}
+
+void StringBufferColumn::BufferToVec(uint64_t nrOfElements, uint64_t startElem, uint64_t endElem,
+	uint64_t vecOffset, unsigned int* sizeMeta, char* buf)
+{
+	// data is appended, so blocks should arrive in order
+	if (vecOffset != vecPos)
+	{
+		throw(runtime_error("Character blocks should be appended in order"));
+	}
+
+	unsigned int blockStart = startElem == 0 ? 0 : sizeMeta[startElem - 1];
+	unsigned int blockEnd = sizeMeta[endElem];
+
+	std::vector<char>& data = shared_data->Data();
+	int64_t base = static_cast<int64_t>(data.size()) - blockStart;
+	data.insert(data.end(), buf + blockStart, buf + blockEnd);
+
+	// cumulative string sizes are offsets relative to the block start
+	int64_t* offsets = &shared_data->Offsets()[vecOffset + 1 - startElem];
+	for (unsigned long long blockElem = startElem; blockElem <= endElem; ++blockElem)
+	{
+		offsets[blockElem] = base + sizeMeta[blockElem];
+	}
+
+	vecPos += endElem - startElem + 1;
+
+	unsigned int nrOfNAInts = 1 + nrOfElements / 32;  // last bit is NA flag
+	unsigned int* bitsNA = &sizeMeta[nrOfElements];
+
+	if ((bitsNA[nrOfNAInts - 1] & (1 << (nrOfElements % 32))) == 0) return;  // no NA's in block
+
+	for (unsigned long long blockElem = startElem; blockElem <= endElem; ++blockElem)
+	{
+		if ((bitsNA[blockElem / 32] & (1u << (blockElem % 32))) != 0)
+		{
+			shared_data->SetNA(vecOffset + blockElem - startElem);
+		}
+	}
+}
+
+const char * StringBufferColumn::GetElement(uint64_t elementNr)
+{
+	std::vector<int64_t>& offsets = shared_data->Offsets();
+	element.assign(shared_data->Data().data() + offsets[elementNr], offsets[elementNr + 1] - offsets[elementNr]);
+
+	return element.c_str();
+}
+
@@ -79,6 +79,84 @@ public:
 };
 
 
+// Character vector stored as Arrow (large string) compatible buffers: 64-bit offsets into a single data buffer and a
+// validity bitmap with the least significant bit first.
+class StringBufferVector : public DestructableObject
+{
+	std::vector<int64_t> offsets;  // vecLength + 1 offsets into data
+	std::vector<char> data;
+	std::vector<uint8_t> validity;  // bit is set for non-NA elements
+	uint64_t nullCount = 0;
+	StringEncoding encoding = StringEncoding::UTF8;
+
+public:
+	StringBufferVector(uint64_t vecLength) : offsets(vecLength + 1, 0), validity((vecLength + 7) / 8, 0xff)
+	{
+	}
+
+	uint64_t Length() const { return offsets.size() - 1; }
+
+	std::vector<int64_t>& Offsets() { return offsets; }
+
+	std::vector<char>& Data() { return data; }
+
+	std::vector<uint8_t>& Validity() { return validity; }
+
+	uint64_t NullCount() const { return nullCount; }
+
+	StringEncoding Encoding() const { return encoding; }
+
+	void SetEncoding(StringEncoding stringEncoding) { encoding = stringEncoding; }
+
+	bool IsNA(uint64_t elementNr) const { return (validity[elementNr / 8] & (1 << (elementNr % 8))) == 0; }
+
+	void SetNA(uint64_t elementNr)
+	{
+		if (IsNA(elementNr)) return;
+
+		validity[elementNr / 8] &= ~(1 << (elementNr % 8));
+		++nullCount;
+	}
+
+	// Append a string, elements are set in order
+	void Append(uint64_t elementNr, const char* str, uint64_t length)
+	{
+		data.insert(data.end(), str, str + length);
+		offsets[elementNr + 1] = static_cast<int64_t>(data.size());
+	}
+};
+
+
+// String column that receives decoded character blocks as-is: cumulative string lengths are converted to offsets and
+// the string data of a block is appended with a single copy, no string objects are created.
+class StringBufferColumn : public IStringColumn
+{
+	std::shared_ptr<StringBufferVector> shared_data = nullptr;
+	uint64_t vecPos = 0;  // number of elements set
+	std::string element;  // holds the result of GetElement
+
+public:
+	void AllocateVec(uint64_t vecLength);
+
+	void SetEncoding(StringEncoding stringEncoding)
+	{
+		shared_data->SetEncoding(stringEncoding);
+	}
+
+	StringEncoding GetEncoding()
+	{
+		return shared_data->Encoding();
+	}
+
+	void BufferToVec(uint64_t nrOfElements, uint64_t startElem, uint64_t endElem, uint64_t vecOffset,
+		uint32_t* sizeMeta, char* buf);
+
+	const char* GetElement(uint64_t elementNr);
+
+	std::shared_ptr<StringBufferVector> Buffers() const { return shared_data; }
+};
+
+
 class IntVector : public DestructableObject
 {
 	int* data = nullptr;
@@ -572,7 +650,7 @@ public:
 
 		for (unsigned long long count = startCount; count != endCount; ++count)
 		{
-			std::string strElem = (*strVecP)[count];
+			const std::string& strElem = (*strVecP)[count];
 
 			// Skip NA string concept for now
 			//if (strElem == NA_STRING)  // set NA bit
@@ -617,15 +695,32 @@ public:
 
 		for (unsigned long long count = startCount; count < endCount; ++count)
 		{
-			const char* str = (*strVecP)[count].c_str();
+			const char* str = (*strVecP)[count].data();
 			pos = strSizes[++sizeCount];
-			strncpy(activeBuf + lastPos, str, pos - lastPos);
+			memcpy(activeBuf + lastPos, str, pos - lastPos);
 			lastPos = pos;
 		}
 
 		bufSize = totSize;
 	}
 
+	bool SetElementViews(uint64_t startCount, uint64_t endCount, const char** elements, uint32_t* sizes, uint32_t* naInts)
+	{
+		const uint64_t nrOfElements = endCount - startCount;
+		const uint64_t nrOfNAInts = 1 + nrOfElements / 32;  // add 1 bit for NA present flag
+
+		for (uint64_t elem = 0; elem < nrOfElements; ++elem)
+		{
+			const std::string& strElem = (*strVecP)[startCount + elem];
+			elements[elem] = strElem.data();
+			sizes[elem] = static_cast<uint32_t>(strElem.size());
+		}
+
+		memset(naInts, 0, nrOfNAInts * 4);  // no NA strings
+
+		return true;
+	}
+
 	StringEncoding Encoding()
 	{
 		return StringEncoding::LATIN1;
@@ -633,6 +728,97 @@ public:
 };
 
 
+// String writer that uses the data buffer of a StringBufferVector directly, only string sizes and NA bits are set
+class StringBufferWriter : public IStringWriter
+{
+	StringBufferVector* strBuffers;
+
+public:
+	uint32_t naIntsBuf[1 + BLOCKSIZE_CHAR / 32];  // we have 32 NA bits per integer
+	uint32_t strSizesBuf[BLOCKSIZE_CHAR];
+
+	StringBufferWriter(StringBufferVector& strBuffers)
+	{
+		this->strBuffers = &strBuffers;
+
+		this->naInts = naIntsBuf;
+		this->strSizes = strSizesBuf;
+		this->vecLength = strBuffers.Length();
+	}
+
+	void SetBuffersFromVec(uint64_t startCount, uint64_t endCount)
+	{
+		const uint64_t nrOfElements = endCount - startCount;  // the string at position endCount is not included
+		const uint64_t nrOfNAInts = 1 + nrOfElements / 32;  // add 1 bit for NA present flag
+		const int64_t* offsets = strBuffers->Offsets().data();
+		const int64_t blockStart = offsets[startCount];
+
+		for (uint64_t elem = 0; elem < nrOfElements; ++elem)
+		{
+			strSizes[elem] = static_cast<uint32_t>(offsets[startCount + elem + 1] - blockStart);
+		}
+
+		memset(naInts, 0, nrOfNAInts * 4);
+
+		if (strBuffers->NullCount() > 0)
+		{
+			bool hasNA = false;
+
+			for (uint64_t elem = 0; elem < nrOfElements; ++elem)
+			{
+				if (!strBuffers->IsNA(startCount + elem)) continue;
+
+				naInts[elem / 32] |= 1u << (elem % 32);
+				hasNA = true;
+			}
+
+			if (hasNA) naInts[nrOfNAInts - 1] |= 1u << (nrOfElements % 32);  // NA flag
+		}
+
+		activeBuf = strBuffers->Data().data() + blockStart;
+		bufSize = static_cast<uint32_t>(offsets[endCount] - blockStart);
+	}
+
+	bool SetElementViews(uint64_t startCount, uint64_t endCount, const char** elements, uint32_t* sizes, uint32_t* naInts)
+	{
+		const uint64_t nrOfElements = endCount - startCount;
+		const uint64_t nrOfNAInts = 1 + nrOfElements / 32;  // add 1 bit for NA present flag
+		const int64_t* offsets = strBuffers->Offsets().data();
+		const char* data = strBuffers->Data().data();
+
+		for (uint64_t elem = 0; elem < nrOfElements; ++elem)
+		{
+			elements[elem] = data + offsets[startCount + elem];
+			sizes[elem] = static_cast<uint32_t>(offsets[startCount + elem + 1] - offsets[startCount + elem]);
+		}
+
+		memset(naInts, 0, nrOfNAInts * 4);
+
+		if (strBuffers->NullCount() > 0)
+		{
+			bool hasNA = false;
+
+			for (uint64_t elem = 0; elem < nrOfElements; ++elem)
+			{
+				if (!strBuffers->IsNA(startCount + elem)) continue;
+
+				naInts[elem / 32] |= 1u << (elem % 32);
+				hasNA = true;
+			}
+
+			if (hasNA) naInts[nrOfNAInts - 1] |= 1u << (nrOfElements % 32);  // NA flag
+		}
+
+		return true;
+	}
+
+	StringEncoding Encoding()
+	{
+		return strBuffers->Encoding();
+	}
+};
+
+
 class FstTable : public IFstTable
 {
 	std::vector<std::shared_ptr<DestructableObject>>* columns = nullptr;
@@ -641,6 +827,7 @@ class FstTable : public IFstTable
 	std::vector<std::string>* colAnnotations = nullptr;
 	std::vector<std::string>* colNames = nullptr;
 	std::vector<short int>* colScales = nullptr;
+	std::vector<int> keyColumns;  // key column indexes, the table is sorted on these columns
 	unsigned long long nrOfRows;
 
 public:
@@ -757,8 +944,17 @@ public:
 
 	void SetStringColumn(IStringColumn * stringColumn, int colNr)
 	{
-		StringColumn* strCol = static_cast<StringColumn*>(stringColumn);
-		(*columns)[colNr] = strCol->StrVector();
+		StringBufferColumn* bufCol = dynamic_cast<StringBufferColumn*>(stringColumn);
+		if (bufCol != nullptr)
+		{
+			(*columns)[colNr] = bufCol->Buffers();
+		}
+		else
+		{
+			StringColumn* strCol = static_cast<StringColumn*>(stringColumn);
+			(*columns)[colNr] = strCol->StrVector();
+		}
+
 		(*columnTypes)[colNr] = FstColumnType::CHARACTER;
 	}
 
@@ -839,6 +1035,7 @@ public:
 
 	void SetKeyColumns(int * keyColPos, uint32_t nrOfKeys)
 	{
+		keyColumns.assign(keyColPos, keyColPos + nrOfKeys);
 	}
 
 	FstColumnType ColumnType(uint32_t colNr, FstColumnAttribute &columnAttribute, short int &scale, std::string &annotation, bool &hasAnnotation)
@@ -855,6 +1052,10 @@ public:
 	{
 		// TODO: Add colType checker
 		std::shared_ptr<DestructableObject> sp = (*columns)[colNr];
+
+		StringBufferVector* strBuffers = dynamic_cast<StringBufferVector*>(&(*sp));
+		if (strBuffers != nullptr) return new StringBufferWriter(*strBuffers);
+
 		StringVector* strVec = static_cast<StringVector*>(&(*sp));
 		std::vector<std::string>* strVecP = strVec->StrVec();
 		return new BlockWriter(*strVecP);
@@ -941,11 +1142,14 @@ public:
 		return new BlockWriter(*colNames);
 	}
 
-	void GetKeyColumns(int* keyColPos) {}
+	void GetKeyColumns(int* keyColPos)
+	{
+		std::copy(keyColumns.begin(), keyColumns.end(), keyColPos);
+	}
 
 	uint32_t NrOfKeys()
 	{
-		return 0;
+		return static_cast<uint32_t>(keyColumns.size());
 	}
 
 	uint32_t NrOfColumns()
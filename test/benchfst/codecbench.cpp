@@ -0,0 +1,393 @@
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <compression/compressor.h>
+#include <compression/simd.h>
+#include <interface/fstdefines.h>
+
+
+// Benchmark results for a single codec and data set
+struct CodecResult
+{
+	double ratio;
+	double compressSpeed;  // MB/s
+	double decompressSpeed;  // MB/s
+	bool identical;
+};
+
+
+// Compress vec in blocks of blockSize bytes and decompress the result again
+CodecResult BenchCompressor(Compressor& compressor, const char* vec, unsigned long long vecSize, int blockSize, int repeats)
+{
+	int bufSize = compressor.CompressBufferSize(blockSize);
+	unsigned long long nrOfBlocks = (vecSize + blockSize - 1) / blockSize;
+
+	std::vector<char> compBuf(nrOfBlocks * bufSize);
+	std::vector<unsigned int> compSizes(nrOfBlocks);
+	std::vector<CompAlgo> compAlgos(nrOfBlocks);
+	std::vector<char> result(vecSize);
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (int repeat = 0; repeat < repeats; ++repeat)
+	{
+		for (unsigned long long block = 0; block < nrOfBlocks; ++block)
+		{
+			unsigned int srcSize = static_cast<unsigned int>(std::min<unsigned long long>(blockSize, vecSize - block * blockSize));
+			compSizes[block] = compressor.Compress(&compBuf[block * bufSize], bufSize, &vec[block * blockSize], srcSize, compAlgos[block]);
+		}
+	}
+
+	auto middle = std::chrono::high_resolution_clock::now();
+
+	for (int repeat = 0; repeat < repeats; ++repeat)
+	{
+		for (unsigned long long block = 0; block < nrOfBlocks; ++block)
+		{
+			unsigned int srcSize = static_cast<unsigned int>(std::min<unsigned long long>(blockSize, vecSize - block * blockSize));
+			if (compAlgos[block] == CompAlgo::UNCOMPRESS)
+			{
+				std::memcpy(&result[block * blockSize], &compBuf[block * bufSize], srcSize);
+				continue;
+			}
+
+			Decompressor::Decompress(compAlgos[block], &result[block * blockSize], srcSize, &compBuf[block * bufSize], compSizes[block]);
+		}
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+
+	unsigned long long totCompSize = 0;
+	for (unsigned int compSize : compSizes) totCompSize += compSize;
+
+	double megaBytes = static_cast<double>(vecSize) * repeats / 1e6;
+
+	CodecResult res;
+	res.ratio = static_cast<double>(vecSize) / totCompSize;
+	res.compressSpeed = megaBytes / std::chrono::duration<double>(middle - start).count();
+	res.decompressSpeed = megaBytes / std::chrono::duration<double>(end - middle).count();
+	res.identical = std::memcmp(vec, result.data(), vecSize) == 0;
+
+	return res;
+}
+
+
+CodecResult BenchCodec(CompAlgo algo, int level, const char* vec, unsigned long long vecSize, int blockSize, int repeats)
+{
+	SingleCompressor compressor(algo, level);
+	return BenchCompressor(compressor, vec, vecSize, blockSize, repeats);
+}
+
+
+// Per block selection between the shuffled, decimal and integral codecs, as used by the double column writer
+CodecResult BenchAdaptive(int level, const char* vec, unsigned long long vecSize, int blockSize, int repeats)
+{
+	SingleCompressor compress1(CompAlgo::LZ4, 100);
+	SingleCompressor compress2(CompAlgo::ZSTD, level / 2);
+	DecimalDoubleCompressor decimal1(&compress1, CompAlgo::DEC_DOUBLE, 0);
+	DecimalDoubleCompressor decimal2(&compress2, CompAlgo::ZSTD_DEC_DOUBLE, level / 2);
+	SingleCompressor shuffle1(CompAlgo::LZ4_SHUF8, 100);
+	SingleCompressor shuffle2(CompAlgo::ZSTD_SHUF8, level / 2);
+	IntegralDoubleCompressor integral1(&shuffle1, CompAlgo::LZ4_INT_DOUBLE, 100);
+	IntegralDoubleCompressor integral2(&shuffle2, CompAlgo::ZSTD_INT_DOUBLE, level / 2);
+	SingleCompressor xor1(CompAlgo::XOR_DOUBLE, 0);
+
+	Compressor* candidates[] = { &decimal1, &integral1, &xor1, &decimal2, &integral2 };
+	AdaptiveCompressor adaptive(candidates, 5, 8, level);
+
+	return BenchCompressor(adaptive, vec, vecSize, blockSize, repeats);
+}
+
+
+void PrintResult(const std::string& dataSet, const std::string& codec, int level, const CodecResult& res)
+{
+	printf("%-12s %-18s %5d %8.2f %12.1f %12.1f %s\n", dataSet.c_str(), codec.c_str(), level, res.ratio,
+		res.compressSpeed, res.decompressSpeed, res.identical ? "" : "MISMATCH");
+}
+
+
+// Double codecs: XOR_DOUBLE, DEC_DOUBLE and INT_DOUBLE against the shuffled and plain block codecs over the compression level range
+void BenchDoubleCodecs(unsigned long long nrOfDoubles, int repeats)
+{
+	std::mt19937 rng(42);
+	std::normal_distribution<double> noise(0.0, 1.0);
+
+	std::vector<std::pair<std::string, std::vector<double>>> dataSets;
+
+	// price series with 2 decimals
+	std::vector<double> prices(nrOfDoubles);
+	long long cents = 1000000;
+	for (unsigned long long pos = 0; pos < nrOfDoubles; ++pos)
+	{
+		cents += static_cast<long long>(std::lround(noise(rng) * 5));
+		prices[pos] = cents / 100.0;
+	}
+	dataSets.push_back(std::make_pair(std::string("prices"), prices));
+
+	// noisy sensor measurements with some NA's
+	const unsigned long long naBits = 0x7ff00000000007a2ULL;
+	double naReal;
+	std::memcpy(&naReal, &naBits, 8);
+
+	std::vector<double> sensor(nrOfDoubles);
+	for (unsigned long long pos = 0; pos < nrOfDoubles; ++pos)
+	{
+		sensor[pos] = (pos % 997 == 0) ? naReal : 20.0 + 5.0 * std::sin(pos / 500.0) + 0.01 * noise(rng);
+	}
+	dataSets.push_back(std::make_pair(std::string("sensor"), sensor));
+
+	// slowly increasing time stamps
+	std::vector<double> timeStamps(nrOfDoubles);
+	double timeStamp = 1.5e9;
+	for (unsigned long long pos = 0; pos < nrOfDoubles; ++pos)
+	{
+		timeStamp += (rng() % 4) * 0.25;
+		timeStamps[pos] = timeStamp;
+	}
+	dataSets.push_back(std::make_pair(std::string("timestamps"), timeStamps));
+
+	// counts with a skewed distribution
+	std::vector<double> counts(nrOfDoubles);
+	for (unsigned long long pos = 0; pos < nrOfDoubles; ++pos)
+	{
+		counts[pos] = std::floor(std::exp(3.0 + 1.5 * noise(rng)));
+	}
+	dataSets.push_back(std::make_pair(std::string("counts"), counts));
+
+	// hashes, incompressible
+	std::vector<double> hashes(nrOfDoubles);
+	for (unsigned long long pos = 0; pos < nrOfDoubles; ++pos)
+	{
+		unsigned long long hash = (static_cast<unsigned long long>(rng()) << 32) | rng();
+		std::memcpy(&hashes[pos], &hash, 8);
+	}
+	dataSets.push_back(std::make_pair(std::string("hashes"), hashes));
+
+	int levels[] = { 0, 25, 50, 75, 100 };
+	int blockSize = 8 * BLOCKSIZE_REAL;
+
+	printf("%-12s %-18s %5s %8s %12s %12s\n", "data", "codec", "level", "ratio", "comp MB/s", "decomp MB/s");
+
+	for (auto& dataSet : dataSets)
+	{
+		const char* vec = reinterpret_cast<const char*>(dataSet.second.data());
+		unsigned long long vecSize = 8 * nrOfDoubles;
+
+		PrintResult(dataSet.first, "XOR_DOUBLE", 0, BenchCodec(CompAlgo::XOR_DOUBLE, 0, vec, vecSize, blockSize, repeats));
+		PrintResult(dataSet.first, "DEC_DOUBLE", 0, BenchCodec(CompAlgo::DEC_DOUBLE, 0, vec, vecSize, blockSize, repeats));
+		PrintResult(dataSet.first, "INT_DOUBLE", 0, BenchCodec(CompAlgo::INT_DOUBLE, 0, vec, vecSize, blockSize, repeats));
+
+		for (int level : levels)
+		{
+			PrintResult(dataSet.first, "LZ4_SHUF8", level, BenchCodec(CompAlgo::LZ4_SHUF8, level, vec, vecSize, blockSize, repeats));
+			PrintResult(dataSet.first, "ZSTD_SHUF8", level, BenchCodec(CompAlgo::ZSTD_SHUF8, level, vec, vecSize, blockSize, repeats));
+			PrintResult(dataSet.first, "ZSTD", level, BenchCodec(CompAlgo::ZSTD, level, vec, vecSize, blockSize, repeats));
+			PrintResult(dataSet.first, "ZSTD_DEC_DOUBLE", level, BenchCodec(CompAlgo::ZSTD_DEC_DOUBLE, level, vec, vecSize, blockSize, repeats));
+			PrintResult(dataSet.first, "LZ4_INT_DOUBLE", level, BenchCodec(CompAlgo::LZ4_INT_DOUBLE, level, vec, vecSize, blockSize, repeats));
+			PrintResult(dataSet.first, "ZSTD_INT_DOUBLE", level, BenchCodec(CompAlgo::ZSTD_INT_DOUBLE, level, vec, vecSize, blockSize, repeats));
+			PrintResult(dataSet.first, "ADAPTIVE", level, BenchAdaptive(level, vec, vecSize, blockSize, repeats));
+		}
+	}
+}
+
+
+// Integer64 codecs: narrowing against the shuffled and frame-of-reference codecs
+void BenchInt64Codecs(unsigned long long nrOfInts, int repeats)
+{
+	std::mt19937 rng(42);
+	const long long naInt64 = static_cast<long long>(FST_NA_INT64);
+
+	std::vector<std::pair<std::string, std::vector<long long>>> dataSets;
+
+	// small counts with some NA's (8 bit)
+	std::vector<long long> counts(nrOfInts);
+	for (unsigned long long pos = 0; pos < nrOfInts; ++pos) counts[pos] = (pos % 101 == 0) ? naInt64 : static_cast<long long>(rng() % 100);
+	dataSets.push_back(std::make_pair(std::string("counts"), counts));
+
+	// identifiers (32 bit)
+	std::vector<long long> ids(nrOfInts);
+	for (unsigned long long pos = 0; pos < nrOfInts; ++pos) ids[pos] = static_cast<long long>(rng() % 2000000000);
+	dataSets.push_back(std::make_pair(std::string("ids"), ids));
+
+	// nanosecond time stamps (64 bit)
+	std::vector<long long> nanoTime(nrOfInts);
+	long long nanos = 1500000000000000000LL;
+	for (unsigned long long pos = 0; pos < nrOfInts; ++pos)
+	{
+		nanos += rng() % 1000000;
+		nanoTime[pos] = nanos;
+	}
+	dataSets.push_back(std::make_pair(std::string("nanotime"), nanoTime));
+
+	int levels[] = { 0, 50, 100 };
+	int blockSize = 8 * BLOCKSIZE_INT64;
+
+	printf("%-12s %-18s %5s %8s %12s %12s\n", "data", "codec", "level", "ratio", "comp MB/s", "decomp MB/s");
+
+	for (auto& dataSet : dataSets)
+	{
+		const char* vec = reinterpret_cast<const char*>(dataSet.second.data());
+		unsigned long long vecSize = 8 * nrOfInts;
+
+		PrintResult(dataSet.first, "NARROW_INT64", 0, BenchCodec(CompAlgo::NARROW_INT64, 0, vec, vecSize, blockSize, repeats));
+
+		for (int level : levels)
+		{
+			PrintResult(dataSet.first, "LZ4_SHUF8", level, BenchCodec(CompAlgo::LZ4_SHUF8, level, vec, vecSize, blockSize, repeats));
+			PrintResult(dataSet.first, "LZ4_NARROW_INT64", level, BenchCodec(CompAlgo::LZ4_NARROW_INT64, level, vec, vecSize, blockSize, repeats));
+			PrintResult(dataSet.first, "LZ4_FOR_INT64", level, BenchCodec(CompAlgo::LZ4_FOR_INT64, level, vec, vecSize, blockSize, repeats));
+			PrintResult(dataSet.first, "ZSTD_SHUF8", level, BenchCodec(CompAlgo::ZSTD_SHUF8, level, vec, vecSize, blockSize, repeats));
+			PrintResult(dataSet.first, "ZSTD_NARROW_INT64", level, BenchCodec(CompAlgo::ZSTD_NARROW_INT64, level, vec, vecSize, blockSize, repeats));
+		}
+	}
+}
+
+
+// Codecs with SIMD kernels at each instruction set supported by the processor
+void BenchSimdKernels(unsigned long long nrOfInts, int repeats)
+{
+	std::mt19937 rng(42);
+
+	// logicals with NA's
+	const int logicalValues[] = { 0, 1, static_cast<int>(FST_NA_INT) };
+	std::vector<int> logicals(nrOfInts);
+	for (int& value : logicals) value = logicalValues[rng() % 3];
+
+	// factor codes with NA's, for the byte and short compaction
+	std::vector<int> smallCodes(nrOfInts), largeCodes(nrOfInts);
+	for (unsigned long long pos = 0; pos < nrOfInts; ++pos)
+	{
+		bool isNA = rng() % 50 == 0;
+		smallCodes[pos] = isNA ? static_cast<int>(FST_NA_INT) : static_cast<int>(rng() % 100);
+		largeCodes[pos] = isNA ? static_cast<int>(FST_NA_INT) : static_cast<int>(rng() % 30000);
+	}
+
+	struct KernelBench
+	{
+		const char* dataSet;
+		const char* codec;
+		CompAlgo algo;
+		const int* vec;
+	};
+
+	KernelBench benches[] =
+	{
+		{ "logicals", "LOGIC64", CompAlgo::LOGIC64, logicals.data() },
+		{ "codes", "INT_TO_BYTE", CompAlgo::INT_TO_BYTE, smallCodes.data() },
+		{ "codes", "INT_TO_SHORT", CompAlgo::INT_TO_SHORT, largeCodes.data() }
+	};
+
+	const char* levelNames[] = { "scalar", "sse2", "avx2" };
+	int blockSize = 4 * BLOCKSIZE_INT;
+
+	printf("%-12s %-18s %5s %8s %12s %12s\n", "data", "codec", "simd", "ratio", "comp MB/s", "decomp MB/s");
+
+	for (int level = SimdLevel::SIMD_SCALAR; level <= SimdMaxLevel(); ++level)
+	{
+		SimdSetLevel(static_cast<SimdLevel>(level));
+
+		for (const KernelBench& bench : benches)
+		{
+			CodecResult res = BenchCodec(bench.algo, 0, reinterpret_cast<const char*>(bench.vec), 4 * nrOfInts, blockSize, repeats);
+			printf("%-12s %-18s %5s %8.2f %12.1f %12.1f %s\n", bench.dataSet, bench.codec, levelNames[level], res.ratio,
+				res.compressSpeed, res.decompressSpeed, res.identical ? "" : "MISMATCH");
+		}
+	}
+
+	SimdSetLevel(SimdMaxLevel());
+}
+
+
+// Thread scaling of a single DualCompressor shared by all threads of a parallel block loop
+void BenchDualThreads(unsigned long long nrOfInts, int repeats)
+{
+	std::mt19937 rng(42);
+	std::vector<int> vec(nrOfInts);
+	for (int& value : vec) value = static_cast<int>(rng() % 1000);
+
+	int blockSize = 4 * BLOCKSIZE_INT;
+	const char* src = reinterpret_cast<const char*>(vec.data());
+	int nrOfBlocks = static_cast<int>((4 * nrOfInts) / blockSize);
+
+	printf("%-8s %12s %8s\n", "threads", "comp MB/s", "speedup");
+
+	double singleSpeed = 0.0;
+
+	for (int threads = 1; threads <= 64; threads *= 2)
+	{
+#ifdef _OPENMP
+		int maxThreads = omp_get_max_threads();
+		omp_set_num_threads(threads);  // one adaptation state per thread
+#endif
+
+		DualCompressor compressor(CompAlgo::LZ4_SHUF4, CompAlgo::ZSTD_SHUF4, 100, 0);
+		int bufSize = compressor.CompressBufferSize(blockSize);
+		std::vector<char> compBuf(static_cast<unsigned long long>(threads) * bufSize);
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		for (int repeat = 0; repeat < repeats; ++repeat)
+		{
+#pragma omp parallel for num_threads(threads) schedule(static)
+			for (int block = 0; block < nrOfBlocks; ++block)
+			{
+				int thread = 0;
+#ifdef _OPENMP
+				thread = omp_get_thread_num();
+#endif
+				CompAlgo compAlgo;
+				compressor.Compress(&compBuf[static_cast<unsigned long long>(thread) * bufSize], bufSize,
+					&src[static_cast<unsigned long long>(block) * blockSize], blockSize, compAlgo);
+			}
+		}
+
+		auto end = std::chrono::high_resolution_clock::now();
+
+#ifdef _OPENMP
+		omp_set_num_threads(maxThreads);
+#endif
+
+		double speed = static_cast<double>(nrOfBlocks) * blockSize * repeats / 1e6 / std::chrono::duration<double>(end - start).count();
+		if (threads == 1) singleSpeed = speed;
+
+		printf("%-8d %12.1f %8.2f\n", threads, speed, speed / singleSpeed);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	std::string bench = argc > 1 ? argv[1] : "all";
+
+	if (bench == "all" || bench == "double")
+	{
+		BenchDoubleCodecs(1000000, 3);
+	}
+
+	if (bench == "all" || bench == "int64")
+	{
+		BenchInt64Codecs(1000000, 3);
+	}
+
+	if (bench == "all" || bench == "simd")
+	{
+		BenchSimdKernels(16000000, 5);
+	}
+
+	if (bench == "all" || bench == "threads")
+	{
+		BenchDualThreads(16000000, 3);
+	}
+
+	return 0;
+}
@@ -206,7 +206,8 @@ public:
 		EXPECT_TRUE(res);
 	}
 
-	static void WriteReadSingleColumns(FstTable &fstTable, const std::string fileName, const int compression)
+	static void WriteReadSingleColumns(FstTable &fstTable, const std::string fileName, const int compression,
+		const FstColumnWriteOptions &options = FstColumnWriteOptions())
 	{
 		// Get column names
 		vector<std::string>* colNames = fstTable.ColumnNames();
@@ -221,7 +222,7 @@ public:
 
 			// Write single column table to disk
 			FstStore fstStore(fileName);
-			fstStore.fstWrite(*subSet, compression);
+			fstStore.fstWrite(*subSet, compression, std::vector<FstColumnWriteOptions>(1, options));
 
 			//// Read single column table from disk
 			std::vector<int> keyIndex;
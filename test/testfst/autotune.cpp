@@ -0,0 +1,146 @@
+
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-filepath.h"
+
+#include <compression/compressor.h>
+#include <interface/fstautotune.h>
+#include <interface/fstdefines.h>
+#include <interface/fststore.h>
+
+#include <fsttable.h>
+
+#include "testhelpers.h"
+#include "ReadWriteTester.h"
+
+
+using namespace testing::internal;
+
+class AutotuneTest : public ::testing::Test
+{
+protected:
+	std::string filePath;
+	std::mt19937 rng;
+
+	virtual void SetUp()
+	{
+		filePath = GetFilePath("autotune.fst");
+		rng.seed(1234);
+	}
+
+	long long FileSize() const
+	{
+		std::ifstream fstFile(filePath, std::ios::binary | std::ios::ate);
+		return static_cast<long long>(fstFile.tellg());
+	}
+};
+
+
+TEST_F(AutotuneTest, Calibration)
+{
+	SingleCompressor lz4(CompAlgo::LZ4_SHUF4, 0);
+	SingleCompressor zstd(CompAlgo::ZSTD_SHUF4, 100);
+	Compressor* candidates[] = { &lz4, &zstd };
+
+	int blockSize = 4 * BLOCKSIZE_INT;
+	std::vector<int> vec(20 * BLOCKSIZE_INT);
+	for (int& value : vec) value = static_cast<int>(rng() % 1000);
+	const char* vecP = reinterpret_cast<const char*>(vec.data());
+
+	// a low target selects the strongest compressor
+	StreamAutotuneCompressor slowCompressor(candidates, 2, 0.001, 0.001);
+	slowCompressor.Calibrate(vecP, 4 * vec.size(), blockSize);
+	EXPECT_EQ(slowCompressor.Selected(), 1);
+
+	// no compressor is fast enough for an unreachable target
+	StreamAutotuneCompressor fastCompressor(candidates, 2, 1e12, 0.0);
+	fastCompressor.Calibrate(vecP, 4 * vec.size(), blockSize);
+	EXPECT_EQ(fastCompressor.Selected(), -1);
+
+	std::vector<char> compBuf(fastCompressor.CompressBufferSize(blockSize));
+	CompAlgo compAlgo;
+	int compSize = fastCompressor.Compress(const_cast<char*>(vecP), blockSize, compBuf.data(), compAlgo, 0);
+	EXPECT_EQ(compAlgo, CompAlgo::UNCOMPRESS);
+	EXPECT_EQ(compSize, blockSize);
+}
+
+
+TEST_F(AutotuneTest, WriteRead)
+{
+	int nrOfRows = 100000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(3, nrOfRows);
+
+	vector<std::string> colNames{ "Integer", "Double", "Integer64" };
+	fstTable.SetColumnNames(colNames);
+
+	IntVectorAdapter intVec(nrOfRows, FstColumnAttribute::INT_32_BASE, 0);
+	int* intP = intVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) intP[pos] = static_cast<int>(rng() % 100);
+	fstTable.SetIntegerColumn(&intVec, 0);
+
+	DoubleVectorAdapter doubleVec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	double* doubleP = doubleVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) doubleP[pos] = (rng() % 10000) / 100.0;
+	fstTable.SetDoubleColumn(&doubleVec, 1);
+
+	Int64VectorAdapter int64Vec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	long long* int64P = int64Vec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) int64P[pos] = 1000000000000LL + pos * 7;
+	fstTable.SetInt64Column(&int64Vec, 2);
+
+	// low targets (strong codecs), high targets (uncompressed) and a read target only
+	FstAutotune targets[] = { FstAutotune(0.001, 0.001), FstAutotune(1e12, 0.0), FstAutotune(0.0, 100.0) };
+	for (FstAutotune& autotune : targets)
+	{
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 50, FstColumnWriteOptions(autotune));
+	}
+}
+
+
+TEST_F(AutotuneTest, Uncompressed)
+{
+	int nrOfRows = 50000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(3, nrOfRows);
+
+	vector<std::string> colNames{ "Integer", "Double", "Integer64" };
+	fstTable.SetColumnNames(colNames);
+
+	IntVectorAdapter intVec(nrOfRows, FstColumnAttribute::INT_32_BASE, 0);
+	int* intP = intVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) intP[pos] = static_cast<int>(rng() % 100);
+	fstTable.SetIntegerColumn(&intVec, 0);
+
+	DoubleVectorAdapter doubleVec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	double* doubleP = doubleVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) doubleP[pos] = (rng() % 10000) / 100.0;
+	fstTable.SetDoubleColumn(&doubleVec, 1);
+
+	Int64VectorAdapter int64Vec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	long long* int64P = int64Vec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) int64P[pos] = pos;
+	fstTable.SetInt64Column(&int64Vec, 2);
+
+	FstStore fstStore(filePath);
+	fstStore.fstWrite(fstTable, 0);
+	long long uncompressedSize = FileSize();
+
+	// throughput targets don't override a request for uncompressed columns
+	FstAutotune autotune(0.001, 0.001);
+	ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 0, FstColumnWriteOptions(autotune));
+	fstStore.fstWrite(fstTable, 0, autotune);
+	EXPECT_EQ(FileSize(), uncompressedSize);
+
+	FstColumnWriteOptions noneOptions(FstColumnCodec::NONE, -1);
+	noneOptions.autotune = autotune;
+	fstStore.fstWrite(fstTable, 50, std::vector<FstColumnWriteOptions>(3, noneOptions));
+	EXPECT_EQ(FileSize(), uncompressedSize);
+
+	fstStore.fstWrite(fstTable, 50, autotune);
+	EXPECT_LT(FileSize(), uncompressedSize / 2);
+}
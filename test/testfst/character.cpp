@@ -0,0 +1,694 @@
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-filepath.h"
+
+#include <interface/fststore.h>
+#include <interface/openmphelper.h>
+#include <character/character_v6.h>
+
+#include <fsttable.h>
+#include <columnfactory.h>
+
+#include "testhelpers.h"
+#include "ReadWriteTester.h"
+
+
+using namespace testing::internal;
+
+class CharacterTest : public ::testing::Test
+{
+protected:
+	FilePath testDataDir;
+	std::string filePath;
+
+	virtual void SetUp()
+	{
+		filePath = GetFilePath("character.fst");
+	}
+
+	// Fill a character column with nrOfLevels distinct strings
+	static void FillColumn(StringColumn& strColumn, int nrOfRows, int nrOfLevels)
+	{
+		strColumn.AllocateVec(nrOfRows);
+		strColumn.SetEncoding(StringEncoding::UTF8);
+		std::vector<std::string>* strVec = strColumn.StrVector()->StrVec();
+
+		for (int pos = 0; pos < nrOfRows; ++pos)
+		{
+			int level = (pos * 7919) % nrOfLevels;
+			(*strVec)[pos] = level == 0 ? "" : "level_" + std::to_string(level);
+		}
+	}
+
+	static void ReadTable(FstStore& fstStore, FstTable& tableRead, IColumnFactory* columnFactory, int fromRow, int toRow = -1)
+	{
+		std::vector<int> keyIndex;
+		StringArray selectedCols;
+		std::unique_ptr<StringColumn> col_names(new StringColumn());
+
+		fstStore.fstRead(tableRead, nullptr, fromRow, toRow, columnFactory, keyIndex, &selectedCols, &*col_names);
+	}
+
+	// Get the single column of a table that was read back
+	static std::shared_ptr<DestructableObject> ReadColumn(FstTable& tableRead, FstColumnType& type)
+	{
+		std::shared_ptr<DestructableObject> column;
+		std::string colName;
+		std::string annotation;
+		short int scale;
+		tableRead.GetColumn(0, column, type, colName, scale, annotation);
+
+		return column;
+	}
+
+	// Compare the strings read back with rows fromRow to toRow (1-based) of the original vector
+	static void CompareStrings(FstTable& tableRead, std::vector<std::string>* strVec, int fromRow, int toRow)
+	{
+		FstColumnType type;
+		std::shared_ptr<DestructableObject> column = ReadColumn(tableRead, type);
+
+		std::vector<std::string>* strRead = static_cast<StringVector*>(&(*column))->StrVec();
+		ASSERT_EQ(strRead->size(), static_cast<size_t>(toRow - fromRow + 1));
+
+		for (int pos = fromRow - 1; pos < toRow; ++pos)
+		{
+			EXPECT_EQ((*strRead)[pos - fromRow + 1], (*strVec)[pos]);
+		}
+	}
+
+	// Compare the offset and data buffers read back with rows fromRow to toRow (1-based) of the original buffers
+	static void CompareBuffers(FstTable& tableRead, StringBufferVector* buffers, int fromRow, int toRow)
+	{
+		FstColumnType type;
+		std::shared_ptr<DestructableObject> column = ReadColumn(tableRead, type);
+
+		StringBufferVector* bufRead = static_cast<StringBufferVector*>(&(*column));
+		ASSERT_EQ(bufRead->Length(), static_cast<uint64_t>(toRow - fromRow + 1));
+		EXPECT_EQ(bufRead->Offsets()[0], 0);
+		EXPECT_EQ(bufRead->Offsets()[toRow - fromRow + 1], static_cast<int64_t>(bufRead->Data().size()));
+
+		for (int pos = fromRow - 1; pos < toRow; ++pos)
+		{
+			int readPos = pos - fromRow + 1;
+			int64_t start = bufRead->Offsets()[readPos];
+			int64_t length = bufRead->Offsets()[readPos + 1] - start;
+			int64_t orgStart = buffers->Offsets()[pos];
+
+			EXPECT_EQ(bufRead->IsNA(readPos), buffers->IsNA(pos));
+			ASSERT_EQ(length, buffers->Offsets()[pos + 1] - orgStart);
+			EXPECT_EQ(0, memcmp(bufRead->Data().data() + start, buffers->Data().data() + orgStart, length));
+		}
+	}
+};
+
+
+TEST_F(CharacterTest, LowCardinality)
+{
+	int nrOfRows = 100000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Character" };
+	fstTable.SetColumnNames(colNames);
+
+	StringColumn strColumn{};
+	FillColumn(strColumn, nrOfRows, 50);
+	fstTable.SetStringColumn(static_cast<IStringColumn*>(&strColumn), 0);
+
+	int compressionLevels[] = { 0, 30, 50, 80 };
+	for (int compression : compressionLevels)
+	{
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, compression);
+	}
+}
+
+
+TEST_F(CharacterTest, HighCardinality)
+{
+	int nrOfRows = 20000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Character" };
+	fstTable.SetColumnNames(colNames);
+
+	// the number of distinct values only becomes too large after the sample block
+	StringColumn strColumn{};
+	FillColumn(strColumn, nrOfRows, 40);
+	std::vector<std::string>* strVec = strColumn.StrVector()->StrVec();
+	for (int pos = 10000; pos < nrOfRows; ++pos) (*strVec)[pos] = std::to_string(pos);
+
+	fstTable.SetStringColumn(static_cast<IStringColumn*>(&strColumn), 0);
+
+	ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 60);
+}
+
+
+TEST_F(CharacterTest, DictionaryAsFactor)
+{
+	int nrOfRows = 10000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Character" };
+	fstTable.SetColumnNames(colNames);
+
+	StringColumn strColumn{};
+	FillColumn(strColumn, nrOfRows, 12);
+	fstTable.SetStringColumn(static_cast<IStringColumn*>(&strColumn), 0);
+
+	FstStore fstStore(filePath);
+	fstStore.fstWrite(fstTable, 50);
+
+	ColumnFactory columnFactory(true);
+	FstTable tableRead;
+	ReadTable(fstStore, tableRead, &columnFactory, 101);
+
+	FstColumnType type;
+	std::shared_ptr<DestructableObject> column = ReadColumn(tableRead, type);
+
+	ASSERT_EQ(type, FstColumnType::FACTOR);
+
+	FactorVector* factorVec = static_cast<FactorVector*>(&(*column));
+	std::vector<std::string>* levels = factorVec->Levels()->StrVector()->StrVec();
+	std::vector<std::string>* strVec = strColumn.StrVector()->StrVec();
+
+	EXPECT_EQ(levels->size(), 12u);
+
+	for (int pos = 100; pos < nrOfRows; ++pos)
+	{
+		EXPECT_EQ((*levels)[factorVec->Data()[pos - 100] - 1], (*strVec)[pos]);
+	}
+
+	// without the factor request the strings are expanded
+	ColumnFactory stringFactory;
+	FstTable tableRead2;
+	ReadTable(fstStore, tableRead2, &stringFactory, 1);
+
+	column = ReadColumn(tableRead2, type);
+	EXPECT_EQ(type, FstColumnType::CHARACTER);
+	EXPECT_EQ(*static_cast<StringVector*>(&(*column))->StrVec(), *strVec);
+}
+
+
+TEST_F(CharacterTest, TrainedDictionary)
+{
+	int nrOfRows = 100000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Character" };
+	fstTable.SetColumnNames(colNames);
+
+	// short strings composed from a shared vocabulary
+	std::vector<std::string> words{ "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel", "india",
+		"juliett", "kilo", "lima", "mike", "november", "oscar", "papa", "quebec", "romeo", "sierra", "tango" };
+
+	StringColumn strColumn{};
+	strColumn.AllocateVec(nrOfRows);
+	strColumn.SetEncoding(StringEncoding::UTF8);
+	std::vector<std::string>* strVec = strColumn.StrVector()->StrVec();
+
+	unsigned int seed = 12345;
+	for (int pos = 0; pos < nrOfRows; ++pos)
+	{
+		seed = seed * 1103515245 + 12345;
+		(*strVec)[pos] = words[(seed >> 16) % 20] + "-" + words[(seed >> 8) % 20] + "-" + std::to_string(seed % 1000);
+	}
+
+	fstTable.SetStringColumn(static_cast<IStringColumn*>(&strColumn), 0);
+
+	int compressionLevels[] = { 60, 100 };
+	for (int compression : compressionLevels)
+	{
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, compression);
+	}
+
+	// read a range starting in a middle block
+	FstStore fstStore(filePath);
+	ColumnFactory columnFactory;
+	FstTable tableRead;
+	ReadTable(fstStore, tableRead, &columnFactory, 5001);
+
+	CompareStrings(tableRead, strVec, 5001, nrOfRows);
+}
+
+
+TEST_F(CharacterTest, ParallelWrite)
+{
+	int nrOfRows = 50000;  // 25 blocks
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Character" };
+	fstTable.SetColumnNames(colNames);
+
+	StringColumn strColumn{};
+	strColumn.AllocateVec(nrOfRows);
+	strColumn.SetEncoding(StringEncoding::UTF8);
+	std::vector<std::string>* strVec = strColumn.StrVector()->StrVec();
+
+	unsigned int seed = 54321;
+	for (int pos = 0; pos < nrOfRows; ++pos)
+	{
+		seed = seed * 1103515245 + 12345;
+		(*strVec)[pos] = "value_" + std::to_string(seed % 100000) + std::string(seed % 13, 'x');
+	}
+
+	fstTable.SetStringColumn(static_cast<IStringColumn*>(&strColumn), 0);
+
+	std::vector<FstColumnWriteOptions> options{ FstColumnWriteOptions(), FstColumnWriteOptions(FstColumnCodec::LZ4, 50),
+		FstColumnWriteOptions(FstColumnCodec::ZSTD, 50) };
+
+	int prevThreads = ThreadsFst(1);
+
+	for (FstColumnWriteOptions option : options)
+	{
+		int compressionLevels[] = { 30, 80 };
+		for (int compression : compressionLevels)
+		{
+			// single threaded reference file
+			ThreadsFst(1);
+			ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, compression, option);
+
+			std::ifstream refFile(filePath, std::ios::binary);
+			std::vector<char> refBytes((std::istreambuf_iterator<char>(refFile)), std::istreambuf_iterator<char>());
+			refFile.close();
+
+			// multi-threaded writes produce identical files
+			ThreadsFst(4);
+			ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, compression, option);
+
+			std::ifstream parFile(filePath, std::ios::binary);
+			std::vector<char> parBytes((std::istreambuf_iterator<char>(parFile)), std::istreambuf_iterator<char>());
+			parFile.close();
+
+			EXPECT_TRUE(refBytes == parBytes);
+		}
+	}
+
+	// read a range starting in a middle block
+	FstStore fstStore(filePath);
+	ColumnFactory columnFactory;
+	FstTable tableRead;
+	ReadTable(fstStore, tableRead, &columnFactory, 10001);
+
+	ThreadsFst(prevThreads);
+
+	CompareStrings(tableRead, strVec, 10001, nrOfRows);
+}
+
+
+TEST_F(CharacterTest, ParallelRead)
+{
+	int nrOfRows = 60000;  // 30 blocks
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Character" };
+	fstTable.SetColumnNames(colNames);
+
+	StringColumn strColumn{};
+	strColumn.AllocateVec(nrOfRows);
+	strColumn.SetEncoding(StringEncoding::UTF8);
+	std::vector<std::string>* strVec = strColumn.StrVector()->StrVec();
+
+	unsigned int seed = 24680;
+	for (int pos = 0; pos < nrOfRows; ++pos)
+	{
+		seed = seed * 1103515245 + 12345;
+		(*strVec)[pos] = "row_" + std::to_string(seed % 50000) + std::string(seed % 7, 'y');
+	}
+
+	fstTable.SetStringColumn(static_cast<IStringColumn*>(&strColumn), 0);
+
+	int prevThreads = ThreadsFst(3);  // batches of 12 blocks
+
+	// ranges within a single block, across batch boundaries and up to the last block
+	std::vector<std::pair<int, int>> ranges{ { 1, 100 }, { 2040, 2060 }, { 5000, 30000 }, { 24000, 60000 }, { 1, 60000 } };
+
+	int compressionLevels[] = { 30, 100 };
+	for (int compression : compressionLevels)
+	{
+		FstStore fstStore(filePath);
+		fstStore.fstWrite(fstTable, compression);
+
+		for (std::pair<int, int> range : ranges)
+		{
+			ColumnFactory columnFactory;
+			FstTable tableRead;
+			ReadTable(fstStore, tableRead, &columnFactory, range.first, range.second);
+
+			CompareStrings(tableRead, strVec, range.first, range.second);
+		}
+	}
+
+	ThreadsFst(prevThreads);
+}
+
+
+TEST_F(CharacterTest, ArrowBuffers)
+{
+	int nrOfRows = 10000;
+
+	// low cardinality columns are dictionary encoded
+	int levelCounts[] = { 20, nrOfRows };
+	for (int nrOfLevels : levelCounts)
+	{
+		FstTable fstTable(nrOfRows);
+		fstTable.InitTable(1, nrOfRows);
+
+		vector<std::string> colNames{ "Character" };
+		fstTable.SetColumnNames(colNames);
+
+		StringBufferColumn bufColumn{};
+		bufColumn.AllocateVec(nrOfRows);
+		std::shared_ptr<StringBufferVector> buffers = bufColumn.Buffers();
+
+		for (int pos = 0; pos < nrOfRows; ++pos)
+		{
+			if (pos % 97 == 5)
+			{
+				buffers->Append(pos, "", 0);
+				buffers->SetNA(pos);
+				continue;
+			}
+
+			std::string str = "level_" + std::to_string((pos * 7919) % nrOfLevels);
+			buffers->Append(pos, str.c_str(), str.size());
+		}
+
+		fstTable.SetStringColumn(static_cast<IStringColumn*>(&bufColumn), 0);
+
+		int compressionLevels[] = { 0, 50, 100 };
+		for (int compression : compressionLevels)
+		{
+			FstStore fstStore(filePath);
+			fstStore.fstWrite(fstTable, compression);
+
+			// read a range into offset and data buffers
+			ColumnFactory bufferFactory(false, true);
+			FstTable tableRead;
+			ReadTable(fstStore, tableRead, &bufferFactory, 3001);
+
+			CompareBuffers(tableRead, buffers.get(), 3001, nrOfRows);
+
+			// string vectors hold "NA" for missing values
+			ColumnFactory columnFactory;
+			FstTable tableStr;
+			ReadTable(fstStore, tableStr, &columnFactory, 1);
+
+			FstColumnType type;
+			std::shared_ptr<DestructableObject> column = ReadColumn(tableStr, type);
+
+			std::vector<std::string>* strRead = static_cast<StringVector*>(&(*column))->StrVec();
+			EXPECT_EQ((*strRead)[5], "NA");
+			EXPECT_EQ((*strRead)[6], "level_" + std::to_string((6 * 7919) % nrOfLevels));
+		}
+	}
+}
+
+
+TEST_F(CharacterTest, ElementViews)
+{
+	std::vector<std::string> strVec(3000);
+	for (size_t pos = 0; pos < strVec.size(); ++pos)
+	{
+		strVec[pos] = pos % 11 == 0 ? "" : "element_" + std::to_string(pos * 31);
+	}
+
+	BlockWriter blockWriter(strVec);
+
+	std::vector<const char*> elements(BLOCKSIZE_CHAR);
+	std::vector<unsigned int> sizes(BLOCKSIZE_CHAR);
+	std::vector<unsigned int> naInts(1 + BLOCKSIZE_CHAR / 32);
+
+	// views match the block buffers
+	uint64_t ranges[][2] = { { 0, BLOCKSIZE_CHAR }, { BLOCKSIZE_CHAR, 3000 } };
+	for (auto& range : ranges)
+	{
+		uint64_t nrOfElements = range[1] - range[0];
+		ASSERT_TRUE(blockWriter.SetElementViews(range[0], range[1], elements.data(), sizes.data(), naInts.data()));
+		blockWriter.SetBuffersFromVec(range[0], range[1]);
+
+		unsigned int pos = 0;
+		for (uint64_t elem = 0; elem < nrOfElements; ++elem)
+		{
+			EXPECT_EQ(pos + sizes[elem], blockWriter.strSizes[elem]);
+			EXPECT_EQ(std::string(elements[elem], sizes[elem]), std::string(blockWriter.activeBuf + pos, sizes[elem]));
+			pos += sizes[elem];
+		}
+
+		EXPECT_EQ(pos, blockWriter.bufSize);
+		EXPECT_EQ(0, memcmp(naInts.data(), blockWriter.naInts, (1 + nrOfElements / 32) * 4));
+	}
+}
+
+
+TEST_F(CharacterTest, CompactMetadata)
+{
+	int nrOfRows = 9000;  // 5 blocks
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Character" };
+	fstTable.SetColumnNames(colNames);
+
+	// NA's in the second block only, lengths vary from empty to long strings
+	StringBufferColumn bufColumn{};
+	bufColumn.AllocateVec(nrOfRows);
+	std::shared_ptr<StringBufferVector> buffers = bufColumn.Buffers();
+
+	for (int pos = 0; pos < nrOfRows; ++pos)
+	{
+		std::string str = std::string((pos * 37) % 50, 'a' + pos % 26) + std::to_string(pos);
+		if (pos == 6000) str = std::string(100000, 'z');
+
+		buffers->Append(pos, str.c_str(), str.size());
+		if (pos >= 2500 && pos < 2510) buffers->SetNA(pos);
+	}
+
+	fstTable.SetStringColumn(static_cast<IStringColumn*>(&bufColumn), 0);
+
+	std::vector<FstColumnWriteOptions> options{ FstColumnWriteOptions(), FstColumnWriteOptions(FstColumnCodec::LZ4, 50),
+		FstColumnWriteOptions(FstColumnCodec::ZSTD, 50) };
+
+	for (FstColumnWriteOptions option : options)
+	{
+		int compressionLevels[] = { 20, 90 };
+		for (int compression : compressionLevels)
+		{
+			FstStore fstStore(filePath);
+			fstStore.fstWrite(fstTable, compression, std::vector<FstColumnWriteOptions>(1, option));
+
+			ColumnFactory bufferFactory(false, true);
+			FstTable tableRead;
+			ReadTable(fstStore, tableRead, &bufferFactory, 1001);
+
+			CompareBuffers(tableRead, buffers.get(), 1001, nrOfRows);
+
+			FstColumnType type;
+			EXPECT_EQ(static_cast<StringBufferVector*>(&(*ReadColumn(tableRead, type)))->NullCount(), 10u);
+		}
+	}
+}
+
+
+TEST_F(CharacterTest, ByteBudgetBlocks)
+{
+	// long strings give blocks of a few elements, short codes the maximum number of elements per block
+	std::vector<std::pair<int, int>> columns{ { 3000, 1500 }, { 60000, 4 } };
+
+	int prevThreads = ThreadsFst(2);
+
+	for (std::pair<int, int> column : columns)
+	{
+		int nrOfRows = column.first;
+		FstTable fstTable(nrOfRows);
+		fstTable.InitTable(1, nrOfRows);
+
+		vector<std::string> colNames{ "Character" };
+		fstTable.SetColumnNames(colNames);
+
+		StringColumn strColumn{};
+		strColumn.AllocateVec(nrOfRows);
+		strColumn.SetEncoding(StringEncoding::UTF8);
+		std::vector<std::string>* strVec = strColumn.StrVector()->StrVec();
+
+		unsigned int seed = 13579;
+		for (int pos = 0; pos < nrOfRows; ++pos)
+		{
+			seed = seed * 1103515245 + 12345;
+			std::string str = std::to_string(seed % 100000);
+			(*strVec)[pos] = str.size() > static_cast<size_t>(column.second) ? str.substr(0, column.second) :
+				str + std::string(seed % column.second, 'q');
+		}
+
+		fstTable.SetStringColumn(static_cast<IStringColumn*>(&strColumn), 0);
+
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 40);
+
+		// ranges starting and ending inside blocks
+		std::vector<std::pair<int, int>> ranges{ { 10, 20 }, { 77, nrOfRows / 2 }, { nrOfRows / 3, nrOfRows } };
+
+		FstStore fstStore(filePath);
+		fstStore.fstWrite(fstTable, 80);
+
+		for (std::pair<int, int> range : ranges)
+		{
+			ColumnFactory columnFactory;
+			FstTable tableRead;
+			ReadTable(fstStore, tableRead, &columnFactory, range.first, range.second);
+
+			CompareStrings(tableRead, strVec, range.first, range.second);
+		}
+	}
+
+	ThreadsFst(prevThreads);
+}
+
+
+TEST_F(CharacterTest, FrontCodedKeys)
+{
+	int nrOfRows = 20000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Url" };
+	fstTable.SetColumnNames(colNames);
+
+	// sorted URL's with long shared prefixes and a few NA's
+	StringBufferColumn bufColumn{};
+	bufColumn.AllocateVec(nrOfRows);
+	std::shared_ptr<StringBufferVector> buffers = bufColumn.Buffers();
+
+	for (int pos = 0; pos < nrOfRows; ++pos)
+	{
+		std::string str = "https://www.example.com/catalog/section" + std::to_string(1000 + pos / 500) + "/item" +
+			std::to_string(100000 + pos) + "/details";
+
+		buffers->Append(pos, str.c_str(), str.size());
+		if (pos % 1009 == 0) buffers->SetNA(pos);
+	}
+
+	fstTable.SetStringColumn(static_cast<IStringColumn*>(&bufColumn), 0);
+
+	// ranges starting and ending between restart points
+	std::vector<std::pair<int, int>> ranges{ { 1, nrOfRows }, { 7, 9 }, { 35, 12345 }, { 19990, nrOfRows } };
+
+	int compressionLevels[] = { 20, 90 };
+	for (int compression : compressionLevels)
+	{
+		FstStore fstStore(filePath);
+		fstStore.fstWrite(fstTable, compression);
+
+		std::ifstream plainFile(filePath, std::ios::binary | std::ios::ate);
+		long long plainSize = static_cast<long long>(plainFile.tellg());
+		plainFile.close();
+
+		int keyColPos = 0;
+		fstTable.SetKeyColumns(&keyColPos, 1);
+		fstStore.fstWrite(fstTable, compression);
+		fstTable.SetKeyColumns(&keyColPos, 0);
+
+		std::ifstream keyFile(filePath, std::ios::binary | std::ios::ate);
+		EXPECT_LT(static_cast<long long>(keyFile.tellg()), plainSize);
+		keyFile.close();
+
+		for (std::pair<int, int> range : ranges)
+		{
+			ColumnFactory bufferFactory(false, true);
+			FstTable tableRead;
+			std::vector<int> keyIndex;
+			StringArray selectedCols;
+			std::unique_ptr<StringColumn> col_names(new StringColumn());
+
+			fstStore.fstRead(tableRead, nullptr, range.first, range.second, &bufferFactory, keyIndex, &selectedCols, &*col_names);
+			ASSERT_EQ(keyIndex.size(), 1u);
+
+			CompareBuffers(tableRead, buffers.get(), range.first, range.second);
+		}
+	}
+}
+
+
+// String writer that fails after a number of element view requests
+class FailingBlockWriter : public BlockWriter
+{
+	int nrOfViews;
+
+public:
+	FailingBlockWriter(std::vector<std::string> &strVec, int nrOfViews) : BlockWriter(strVec), nrOfViews(nrOfViews) { }
+
+	bool SetElementViews(uint64_t startCount, uint64_t endCount, const char** elements, unsigned int* sizes,
+		unsigned int* naInts)
+	{
+		if (nrOfViews-- == 0) throw std::runtime_error("string writer failed");
+
+		return BlockWriter::SetElementViews(startCount, endCount, elements, sizes, naInts);
+	}
+};
+
+
+// String column that fails after a number of materialised blocks
+class FailingStringColumn : public StringColumn
+{
+	int nrOfBlocks;
+
+public:
+	explicit FailingStringColumn(int nrOfBlocks) : nrOfBlocks(nrOfBlocks) { }
+
+	void BufferToVec(uint64_t nrOfElements, uint64_t startElem, uint64_t endElem, uint64_t vecOffset,
+		unsigned int* sizeMeta, char* buf)
+	{
+		if (nrOfBlocks-- == 0) throw std::runtime_error("string column failed");
+
+		StringColumn::BufferToVec(nrOfElements, startElem, endElem, vecOffset, sizeMeta, buf);
+	}
+};
+
+
+TEST_F(CharacterTest, HostErrors)
+{
+	int nrOfRows = 200000;
+	std::vector<std::string> strVec(nrOfRows);
+	for (int pos = 0; pos < nrOfRows; ++pos) strVec[pos] = "host_error_" + std::to_string(pos);
+
+	int prevThreads = ThreadsFst(4);  // batches of 16 blocks
+
+	// the block pre-pass requests a view per BLOCKSIZE_CHAR elements, fail during the second batch
+	int nrOfPrepassViews = (nrOfRows + BLOCKSIZE_CHAR - 1) / BLOCKSIZE_CHAR;
+	{
+		FailingBlockWriter failingWriter(strVec, nrOfPrepassViews + 20);
+		std::ofstream myfile(filePath, std::ios::binary);
+		EXPECT_THROW(fdsWriteCharVec_v6(myfile, &failingWriter, 50, FstColumnCodec::DEFAULT, StringEncoding::UTF8),
+			std::runtime_error);
+	}
+
+	BlockWriter blockWriter(strVec);
+	{
+		std::ofstream myfile(filePath, std::ios::binary);
+		fdsWriteCharVec_v6(myfile, &blockWriter, 50, FstColumnCodec::DEFAULT, StringEncoding::UTF8);
+	}
+
+	std::ifstream myfile(filePath, std::ios::binary);
+
+	// fail while materialising the second batch
+	FailingStringColumn failingColumn(20);
+	failingColumn.AllocateVec(nrOfRows);
+	EXPECT_THROW(fdsReadCharVec_v6(myfile, &failingColumn, 0, 0, nrOfRows, nrOfRows), std::runtime_error);
+
+	StringColumn strColumn;
+	strColumn.AllocateVec(nrOfRows);
+	myfile.clear();
+	fdsReadCharVec_v6(myfile, &strColumn, 0, 0, nrOfRows, nrOfRows);
+	EXPECT_EQ(*strColumn.StrVector()->StrVec(), strVec);
+
+	ThreadsFst(prevThreads);
+}
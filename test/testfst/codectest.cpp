@@ -0,0 +1,804 @@
+
+#include <algorithm>
+#include <cstring>
+#include <climits>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <compression/compressor.h>
+#include <compression/bitpacking.h>
+#include <compression/decimaldouble.h>
+#include <compression/logicpack.h>
+#include <compression/narrowint64.h>
+#include <compression/runlength.h>
+#include <compression/scratchbuffer.h>
+#include <compression/simd.h>
+#include <compression/sparse.h>
+#include <interface/fstdefines.h>
+
+
+class CodecTest : public ::testing::Test
+{
+protected:
+	std::mt19937 rng;
+
+	virtual void SetUp()
+	{
+		rng.seed(1234);
+	}
+
+	// Compress and decompress a single block, returns the compressed size
+	static int RoundTrip(CompAlgo algo, const char* src, unsigned int srcSize)
+	{
+		SingleCompressor compressor(algo, 50);
+		int bufSize = compressor.CompressBufferSize(srcSize);
+		std::vector<char> compBuf(bufSize);
+
+		CompAlgo usedAlgo;
+		int compSize = compressor.Compress(compBuf.data(), bufSize, src, srcSize, usedAlgo);
+
+		EXPECT_EQ(usedAlgo, algo);
+		EXPECT_LE(compSize, bufSize);
+
+		std::vector<char> result(srcSize);
+		int errorCode = Decompressor::Decompress(algo, result.data(), srcSize, compBuf.data(), compSize);
+
+		EXPECT_EQ(errorCode, 0);
+		EXPECT_EQ(std::memcmp(src, result.data(), srcSize), 0);
+
+		return compSize;
+	}
+
+	std::vector<int> RandomInts(unsigned int length, int frame, unsigned int bitWidth)
+	{
+		std::vector<int> vec(length);
+		uint32_t mask = bitWidth == 32 ? 0xffffffffu : (1u << bitWidth) - 1;
+
+		for (unsigned int pos = 0; pos < length; ++pos)
+		{
+			vec[pos] = static_cast<int>(static_cast<uint32_t>(frame) + (rng() & mask));
+		}
+
+		return vec;
+	}
+};
+
+
+TEST_F(CodecTest, BitPackKernels)
+{
+	uint32_t codes[BITPACK_CHUNK];
+	uint32_t packed[4 * 32];
+	uint32_t packedScalar[4 * 32];
+	int unpacked[BITPACK_CHUNK];
+	int unpackedScalar[BITPACK_CHUNK];
+
+	for (unsigned int bitWidth = 0; bitWidth <= 32; ++bitWidth)
+	{
+		uint32_t mask = bitWidth == 32 ? 0xffffffffu : (1u << bitWidth) - 1;
+		for (int pos = 0; pos < BITPACK_CHUNK; ++pos) codes[pos] = rng() & mask;
+
+		std::memset(packed, 0, sizeof(packed));
+		std::memset(packedScalar, 0, sizeof(packedScalar));
+
+		BitPack128(codes, packed, bitWidth);
+		BitPack128Scalar(codes, packedScalar, bitWidth);
+		EXPECT_EQ(std::memcmp(packed, packedScalar, 16 * bitWidth), 0);
+
+		BitUnpack128(packed, unpacked, bitWidth, 0, false);
+		EXPECT_EQ(std::memcmp(unpacked, codes, sizeof(codes)), 0);
+
+		// frame and NA code
+		BitUnpack128(packed, unpacked, bitWidth, -17, true);
+		BitUnpack128Scalar(packed, unpackedScalar, bitWidth, -17, true);
+		EXPECT_EQ(std::memcmp(unpacked, unpackedScalar, sizeof(unpacked)), 0);
+
+		for (int pos = 0; pos < BITPACK_CHUNK; ++pos)
+		{
+			int expected = codes[pos] == mask ? static_cast<int>(FST_NA_INT) : static_cast<int>(codes[pos] - 17);
+			EXPECT_EQ(unpacked[pos], expected);
+		}
+	}
+}
+
+
+TEST_F(CodecTest, LogicPackKernels)
+{
+	const int nrOfGroups = 37;
+	const int nrOfLogicals = 32 * nrOfGroups;
+	const int values[] = { 0, 1, static_cast<int>(FST_NA_INT) };
+
+	// unaligned buffers
+	std::vector<int> logicalBuf(nrOfLogicals + 1);
+	std::vector<int> resultBuf(nrOfLogicals + 1);
+	int* logicals = &logicalBuf[1];
+	int* result = &resultBuf[1];
+
+	for (int pos = 0; pos < nrOfLogicals; ++pos) logicals[pos] = values[rng() % 3];
+
+	std::vector<unsigned long long> packedScalar(nrOfGroups);
+	LogicPack64Scalar(reinterpret_cast<char*>(logicals), packedScalar.data(), nrOfGroups);
+
+	SimdLevel levels[] = { SimdLevel::SIMD_SCALAR, SimdLevel::SIMD_SSE2, SimdLevel::SIMD_AVX2 };
+
+	for (SimdLevel level : levels)
+	{
+		SimdSetLevel(level);
+
+		std::vector<unsigned long long> packed(nrOfGroups);
+		LogicPack64(reinterpret_cast<char*>(logicals), packed.data(), nrOfGroups);
+		EXPECT_EQ(packed, packedScalar);
+
+		std::memset(result, 0xff, 4 * nrOfLogicals);
+		LogicUnpack64(reinterpret_cast<char*>(result), packed.data(), nrOfGroups);
+		EXPECT_EQ(std::memcmp(result, logicals, 4 * nrOfLogicals), 0);
+
+		// single value groups
+		for (int value : values)
+		{
+			std::vector<int> constant(32, value);
+			unsigned long long word, wordScalar;
+
+			LogicPack64(reinterpret_cast<char*>(constant.data()), &word, 1);
+			LogicPack64Scalar(reinterpret_cast<char*>(constant.data()), &wordScalar, 1);
+			EXPECT_EQ(word, wordScalar);
+
+			LogicUnpack64(reinterpret_cast<char*>(result), &word, 1);
+			EXPECT_EQ(std::memcmp(result, constant.data(), 4 * 32), 0);
+		}
+	}
+
+	SimdSetLevel(SimdMaxLevel());
+}
+
+
+TEST_F(CodecTest, IntCompactKernels)
+{
+	unsigned int lengths[] = { 1, 7, 8, 9, 16, 31, 33, 100, BLOCKSIZE_INT };
+	SimdLevel levels[] = { SimdLevel::SIMD_SSE2, SimdLevel::SIMD_AVX2 };
+
+	for (unsigned int length : lengths)
+	{
+		// byte and short ranges with NA's
+		std::vector<int> bytes = RandomInts(length, 0, 7);
+		std::vector<int> shorts = RandomInts(length, 0, 15);
+		for (unsigned int pos = 0; pos < length; pos += 11)
+		{
+			bytes[pos] = static_cast<int>(FST_NA_INT);
+			shorts[pos] = static_cast<int>(FST_NA_INT);
+		}
+
+		unsigned int byteSize = 8 * ((length + 7) / 8);
+		unsigned int shortSize = 8 * ((length + 3) / 4);
+
+		SimdSetLevel(SimdLevel::SIMD_SCALAR);
+		std::vector<char> byteScalar(byteSize), shortScalar(shortSize);
+		CompactIntToByte(byteScalar.data(), reinterpret_cast<char*>(bytes.data()), length);
+		CompactIntToShort(shortScalar.data(), reinterpret_cast<char*>(shorts.data()), length);
+
+		for (SimdLevel level : levels)
+		{
+			SimdSetLevel(level);
+
+			std::vector<char> byteVec(byteSize), shortVec(shortSize);
+			CompactIntToByte(byteVec.data(), reinterpret_cast<char*>(bytes.data()), length);
+			CompactIntToShort(shortVec.data(), reinterpret_cast<char*>(shorts.data()), length);
+			EXPECT_EQ(byteVec, byteScalar);
+			EXPECT_EQ(shortVec, shortScalar);
+
+			std::vector<int> result(length + 1, -1);
+			DecompactByteToInt(byteVec.data(), reinterpret_cast<char*>(result.data()), length);
+			EXPECT_EQ(std::memcmp(result.data(), bytes.data(), 4 * length), 0);
+			EXPECT_EQ(result[length], -1);
+
+			DecompactShortToInt(shortVec.data(), reinterpret_cast<char*>(result.data()), length);
+			EXPECT_EQ(std::memcmp(result.data(), shorts.data(), 4 * length), 0);
+			EXPECT_EQ(result[length], -1);
+		}
+	}
+
+	SimdSetLevel(SimdMaxLevel());
+}
+
+
+TEST_F(CodecTest, ForIntBitWidths)
+{
+	for (unsigned int bitWidth = 0; bitWidth < 32; ++bitWidth)
+	{
+		std::vector<int> vec = RandomInts(BLOCKSIZE_INT, -1000, bitWidth);
+		vec[7] = -1000;  // frame
+		vec[8] = static_cast<int>(-1000 + ((1LL << bitWidth) - 1));  // maximum code
+
+		int compSize = RoundTrip(CompAlgo::FOR_INT, reinterpret_cast<char*>(vec.data()), 4 * BLOCKSIZE_INT);
+		EXPECT_EQ(compSize, static_cast<int>(FOR_HEADER_SIZE_INT + 4 * bitWidth * BLOCKSIZE_INT / 32));
+
+		RoundTrip(CompAlgo::LZ4_FOR_INT, reinterpret_cast<char*>(vec.data()), 4 * BLOCKSIZE_INT);
+		RoundTrip(CompAlgo::ZSTD_FOR_INT, reinterpret_cast<char*>(vec.data()), 4 * BLOCKSIZE_INT);
+	}
+}
+
+
+TEST_F(CodecTest, ForIntNA)
+{
+	unsigned int lengths[] = { 1, 127, 128, 129, 1000, BLOCKSIZE_INT };
+
+	for (unsigned int length : lengths)
+	{
+		// sparse NA's
+		std::vector<int> vec = RandomInts(length, 25, 11);
+		for (unsigned int pos = 0; pos < length; pos += 7) vec[pos] = static_cast<int>(FST_NA_INT);
+
+		RoundTrip(CompAlgo::FOR_INT, reinterpret_cast<char*>(vec.data()), 4 * length);
+		RoundTrip(CompAlgo::LZ4_FOR_INT, reinterpret_cast<char*>(vec.data()), 4 * length);
+		RoundTrip(CompAlgo::ZSTD_FOR_INT, reinterpret_cast<char*>(vec.data()), 4 * length);
+
+		// full integer range and NA's
+		vec = RandomInts(length, 0, 32);
+		for (unsigned int pos = 0; pos < length; pos += 3) vec[pos] = static_cast<int>(FST_NA_INT);
+		vec[length - 1] = INT_MAX;
+		if (length > 2) vec[1] = INT_MIN + 1;
+
+		RoundTrip(CompAlgo::FOR_INT, reinterpret_cast<char*>(vec.data()), 4 * length);
+
+		// all NA
+		std::vector<int> naVec(length, static_cast<int>(FST_NA_INT));
+		int compSize = RoundTrip(CompAlgo::FOR_INT, reinterpret_cast<char*>(naVec.data()), 4 * length);
+		EXPECT_EQ(compSize, FOR_HEADER_SIZE_INT);
+		RoundTrip(CompAlgo::LZ4_FOR_INT, reinterpret_cast<char*>(naVec.data()), 4 * length);
+
+		// constant
+		std::vector<int> constVec(length, 42);
+		compSize = RoundTrip(CompAlgo::FOR_INT, reinterpret_cast<char*>(constVec.data()), 4 * length);
+		EXPECT_EQ(compSize, FOR_HEADER_SIZE_INT);
+		RoundTrip(CompAlgo::ZSTD_FOR_INT, reinterpret_cast<char*>(constVec.data()), 4 * length);
+	}
+}
+
+
+TEST_F(CodecTest, ForInt64)
+{
+	unsigned int lengths[] = { 1, 129, 1000, BLOCKSIZE_INT64 };
+	const long long naInt64 = static_cast<long long>(FST_NA_INT64);
+
+	for (unsigned int length : lengths)
+	{
+		// narrow range with a large frame
+		std::vector<long long> vec(length);
+		for (unsigned int pos = 0; pos < length; ++pos) vec[pos] = 5000000000LL + (rng() & 0xfff);
+		for (unsigned int pos = 0; pos < length; pos += 5) vec[pos] = naInt64;
+
+		RoundTrip(CompAlgo::FOR_INT64, reinterpret_cast<char*>(vec.data()), 8 * length);
+		RoundTrip(CompAlgo::LZ4_FOR_INT64, reinterpret_cast<char*>(vec.data()), 8 * length);
+		RoundTrip(CompAlgo::ZSTD_FOR_INT64, reinterpret_cast<char*>(vec.data()), 8 * length);
+
+		// range exceeds 32 bits, stored unpacked
+		for (unsigned int pos = 0; pos < length; ++pos) vec[pos] = static_cast<long long>(rng()) << 20;
+		vec[0] = LLONG_MAX;
+		vec[length - 1] = 0;
+
+		int compSize = RoundTrip(CompAlgo::FOR_INT64, reinterpret_cast<char*>(vec.data()), 8 * length);
+		if (length > 1) { EXPECT_EQ(compSize, static_cast<int>(FOR_HEADER_SIZE_INT64 + 8 * length)); }
+		RoundTrip(CompAlgo::ZSTD_FOR_INT64, reinterpret_cast<char*>(vec.data()), 8 * length);
+
+		// all NA
+		std::vector<long long> naVec(length, naInt64);
+		compSize = RoundTrip(CompAlgo::FOR_INT64, reinterpret_cast<char*>(naVec.data()), 8 * length);
+		EXPECT_EQ(compSize, FOR_HEADER_SIZE_INT64);
+	}
+}
+
+
+TEST_F(CodecTest, ForInt64WideRange)
+{
+	// large block with a range of 2^32 or more is stored unpacked in the pack buffer
+	unsigned int length = 1000000;
+	std::vector<long long> vec(length);
+	for (unsigned int pos = 0; pos < length; ++pos) vec[pos] = (static_cast<long long>(rng()) << 16) - pos;
+
+	// a new thread starts with empty scratch buffers
+	std::thread worker([&vec, length]()
+	{
+		RoundTrip(CompAlgo::LZ4_FOR_INT64, reinterpret_cast<char*>(vec.data()), 8 * length);
+		RoundTrip(CompAlgo::ZSTD_FOR_INT64, reinterpret_cast<char*>(vec.data()), 8 * length);
+	});
+
+	worker.join();
+}
+
+
+TEST_F(CodecTest, XorDouble)
+{
+	unsigned int lengths[] = { 1, 2, 100, BLOCKSIZE_REAL };
+
+	const unsigned long long naBits = 0x7ff00000000007a2ULL;  // R's NA_real_
+	double naReal;
+	std::memcpy(&naReal, &naBits, 8);
+
+	for (unsigned int length : lengths)
+	{
+		// price series with special values
+		std::vector<double> vec(length);
+		long long cents = 1000000;
+		for (unsigned int pos = 0; pos < length; ++pos)
+		{
+			cents += static_cast<long long>(rng() % 21) - 10;
+			vec[pos] = cents / 100.0;
+		}
+
+		vec[0] = -0.0;
+		if (length > 10)
+		{
+			vec[3] = naReal;
+			vec[4] = std::numeric_limits<double>::quiet_NaN();
+			vec[5] = -std::numeric_limits<double>::infinity();
+			vec[6] = vec[7];
+		}
+
+		int compSize = RoundTrip(CompAlgo::XOR_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+		if (length == BLOCKSIZE_REAL) { EXPECT_LT(compSize, static_cast<int>(8 * length)); }
+
+		// random bit patterns are stored unpacked
+		for (unsigned int pos = 0; pos < length; ++pos)
+		{
+			unsigned long long bits = (static_cast<unsigned long long>(rng()) << 32) | rng();
+			std::memcpy(&vec[pos], &bits, 8);
+		}
+
+		compSize = RoundTrip(CompAlgo::XOR_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+		if (length > 1) { EXPECT_EQ(compSize, static_cast<int>(8 + 8 * length)); }
+
+		// constant
+		std::vector<double> constVec(length, 3.25);
+		RoundTrip(CompAlgo::XOR_DOUBLE, reinterpret_cast<char*>(constVec.data()), 8 * length);
+	}
+}
+
+
+TEST_F(CodecTest, DecimalDouble)
+{
+	unsigned int lengths[] = { 1, 129, BLOCKSIZE_REAL };
+
+	const unsigned long long naBits = 0x7ff00000000007a2ULL;  // R's NA_real_
+	double naReal;
+	std::memcpy(&naReal, &naBits, 8);
+
+	for (unsigned int length : lengths)
+	{
+		// prices with 2 decimals and NA's
+		std::vector<double> vec(length);
+		for (unsigned int pos = 0; pos < length; ++pos) vec[pos] = (static_cast<int>(rng() % 200000) - 1000) / 100.0;
+		for (unsigned int pos = 1; pos < length; pos += 17) vec[pos] = naReal;
+
+		if (length > 1) { EXPECT_EQ(DecimalScaleDouble(vec.data(), length), 2); }
+
+		int compSize = RoundTrip(CompAlgo::DEC_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+		if (length == BLOCKSIZE_REAL) { EXPECT_LT(compSize, static_cast<int>(3 * length)); }
+
+		RoundTrip(CompAlgo::LZ4_DEC_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+		RoundTrip(CompAlgo::ZSTD_DEC_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+
+		// integral values
+		for (unsigned int pos = 0; pos < length; ++pos) vec[pos] = static_cast<double>(rng() % 1000);
+		EXPECT_EQ(DecimalScaleDouble(vec.data(), length), 0);
+		RoundTrip(CompAlgo::DEC_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+
+		// a single value with too many decimals, negative zero or a second NaN payload stores the block unpacked
+		vec[length - 1] = 1.0 / 3.0;
+		EXPECT_EQ(DecimalScaleDouble(vec.data(), length), -1);
+		compSize = RoundTrip(CompAlgo::DEC_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+		EXPECT_EQ(compSize, static_cast<int>(DEC_HEADER_SIZE + 8 * length));
+
+		vec[length - 1] = -0.0;
+		compSize = RoundTrip(CompAlgo::ZSTD_DEC_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+		EXPECT_EQ(compSize, static_cast<int>(DEC_HEADER_SIZE + 8 * length));
+
+		if (length > 1)
+		{
+			vec[length - 1] = std::numeric_limits<double>::quiet_NaN();
+			vec[0] = naReal;
+			compSize = RoundTrip(CompAlgo::DEC_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+			EXPECT_EQ(compSize, static_cast<int>(DEC_HEADER_SIZE + 8 * length));
+		}
+	}
+}
+
+
+TEST_F(CodecTest, RunLength)
+{
+	unsigned int lengths[] = { 1, 129, BLOCKSIZE_INT };
+
+	for (unsigned int length : lengths)
+	{
+		// sorted categories with NA's at the end
+		std::vector<int> vec(length);
+		for (unsigned int pos = 0; pos < length; ++pos) vec[pos] = static_cast<int>(pos / 100);
+		for (unsigned int pos = length - length / 10; pos < length; ++pos) vec[pos] = FST_NA_INT;
+
+		int compSize = RoundTrip(CompAlgo::RLE_INT, reinterpret_cast<char*>(vec.data()), 4 * length);
+		if (length == BLOCKSIZE_INT) { EXPECT_EQ(compSize, static_cast<int>(RLE_HEADER_SIZE + 8 * 38)); }  // 37 categories and NA
+
+		// many short runs are stored unpacked
+		std::vector<int> randomVec = RandomInts(length, 0, 2);
+		compSize = RoundTrip(CompAlgo::RLE_INT, reinterpret_cast<char*>(randomVec.data()), 4 * length);
+		if (length == BLOCKSIZE_INT) { EXPECT_EQ(compSize, static_cast<int>(RLE_HEADER_SIZE + 4 * length)); }
+	}
+
+	// the decorator only selects the RLE codec for blocks with long runs
+	SingleCompressor compressor(CompAlgo::LZ4_SHUF4, 0);
+	RunLengthCompressor runCompressor(&compressor, RLE_MIN_RUN_LENGTH);
+	int bufSize = runCompressor.CompressBufferSize(4 * BLOCKSIZE_INT);
+	std::vector<char> compBuf(bufSize);
+	CompAlgo usedAlgo;
+
+	std::vector<int> flags(BLOCKSIZE_INT, 0);
+	for (unsigned int pos = 1000; pos < 3000; ++pos) flags[pos] = 1;
+	runCompressor.Compress(compBuf.data(), bufSize, reinterpret_cast<char*>(flags.data()), 4 * BLOCKSIZE_INT, usedAlgo);
+	EXPECT_EQ(usedAlgo, CompAlgo::RLE_INT);
+
+	std::vector<int> randomVec = RandomInts(BLOCKSIZE_INT, 0, 1);
+	runCompressor.Compress(compBuf.data(), bufSize, reinterpret_cast<char*>(randomVec.data()), 4 * BLOCKSIZE_INT, usedAlgo);
+	EXPECT_EQ(usedAlgo, CompAlgo::LZ4_SHUF4);
+}
+
+
+TEST_F(CodecTest, ConstantAndSparse)
+{
+	unsigned int lengths[] = { 1, 129, BLOCKSIZE_INT64 };
+
+	for (unsigned int length : lengths)
+	{
+		// constant blocks of 4 and 8 byte elements
+		std::vector<int> intVec(length, FST_NA_INT);
+		int compSize = RoundTrip(CompAlgo::CONSTANT, reinterpret_cast<char*>(intVec.data()), 4 * length);
+		EXPECT_EQ(compSize, CONST_HEADER_SIZE + 4);
+
+		std::vector<double> doubleVec(length, 0.1);
+		compSize = RoundTrip(CompAlgo::CONSTANT, reinterpret_cast<char*>(doubleVec.data()), 8 * length);
+		EXPECT_EQ(compSize, CONST_HEADER_SIZE + 8);
+
+		// sparse blocks, the background value is found at the end of the block
+		for (unsigned int pos = 0; pos < length; pos += 61) intVec[pos] = static_cast<int>(rng());
+		compSize = RoundTrip(CompAlgo::SPARSE_INT, reinterpret_cast<char*>(intVec.data()), 4 * length);
+		if (length == BLOCKSIZE_INT64) { EXPECT_LT(compSize, static_cast<int>(length / 4)); }
+
+		std::vector<long long> int64Vec(length, 12);
+		for (unsigned int pos = 0; pos < length; pos += 61) int64Vec[pos] = static_cast<long long>(rng()) << 20;
+		compSize = RoundTrip(CompAlgo::SPARSE_INT64, reinterpret_cast<char*>(int64Vec.data()), 8 * length);
+		if (length == BLOCKSIZE_INT64) { EXPECT_LT(compSize, static_cast<int>(length / 2)); }
+
+		// dense blocks are stored unpacked
+		std::vector<int> randomVec = RandomInts(length, 0, 32);
+		compSize = RoundTrip(CompAlgo::CONSTANT, reinterpret_cast<char*>(randomVec.data()), 4 * length);
+		if (length > 1) { EXPECT_EQ(compSize, static_cast<int>(CONST_HEADER_SIZE + 4 * length)); }
+
+		compSize = RoundTrip(CompAlgo::SPARSE_INT, reinterpret_cast<char*>(randomVec.data()), 4 * length);
+		if (length > 1) { EXPECT_EQ(compSize, static_cast<int>(SPARSE_HEADER_SIZE + 4 * length)); }
+	}
+}
+
+
+TEST_F(CodecTest, NarrowInt64)
+{
+	unsigned int lengths[] = { 1, 15, 129, BLOCKSIZE_INT64 };
+	long long ranges[] = { 127, 32767, INT_MAX, 1LL << 40 };
+	unsigned int widths[] = { 1, 2, 4, 8 };
+	const long long naInt64 = static_cast<long long>(FST_NA_INT64);
+
+	for (unsigned int length : lengths)
+	{
+		for (int range = 0; range < 4; ++range)
+		{
+			// values span the full range of the narrow type, except for the NA sentinel
+			std::vector<long long> vec(length);
+			for (unsigned int pos = 0; pos < length; ++pos)
+			{
+				vec[pos] = static_cast<long long>(rng() % (2 * static_cast<unsigned long long>(ranges[range]) + 1)) - ranges[range];
+			}
+
+			vec[0] = -ranges[range];
+			if (length > 2) vec[1] = naInt64;
+			if (length > 3) vec[length - 1] = ranges[range];
+
+			EXPECT_EQ(NarrowWidthInt64(vec.data(), length), widths[range]);
+
+			int compSize = RoundTrip(CompAlgo::NARROW_INT64, reinterpret_cast<char*>(vec.data()), 8 * length);
+			EXPECT_EQ(compSize, static_cast<int>(NARROW_HEADER_SIZE + widths[range] * length));
+
+			RoundTrip(CompAlgo::LZ4_NARROW_INT64, reinterpret_cast<char*>(vec.data()), 8 * length);
+			RoundTrip(CompAlgo::ZSTD_NARROW_INT64, reinterpret_cast<char*>(vec.data()), 8 * length);
+
+			// the NA sentinel of the narrow type is not a valid value
+			if (range < 3 && length > 3)
+			{
+				vec[2] = -ranges[range] - 1;
+				EXPECT_EQ(NarrowWidthInt64(vec.data(), length), widths[range + 1]);
+				RoundTrip(CompAlgo::LZ4_NARROW_INT64, reinterpret_cast<char*>(vec.data()), 8 * length);
+			}
+		}
+	}
+}
+
+
+TEST_F(CodecTest, ShuffleMisalignedOutput)
+{
+	CompAlgo algos[] = { CompAlgo::LZ4_SHUF4, CompAlgo::ZSTD_SHUF4, CompAlgo::LZ4_SHUF8, CompAlgo::ZSTD_SHUF8,
+		CompAlgo::ZSTD_NARROW_INT64 };
+	unsigned int lengths[] = { 8, 62, 1024, BLOCKSIZE_INT };  // even lengths for the 8 byte codecs
+
+	for (unsigned int length : lengths)
+	{
+		std::vector<int> vec = RandomInts(length, -1000, 12);
+
+		for (CompAlgo algo : algos)
+		{
+			SingleCompressor compressor(algo, 50);
+			int bufSize = compressor.CompressBufferSize(4 * length);
+			std::vector<char> compBuf(bufSize);
+
+			CompAlgo usedAlgo;
+			int compSize = compressor.Compress(compBuf.data(), bufSize, reinterpret_cast<char*>(vec.data()), 4 * length, usedAlgo);
+
+			// decoded data is deshuffled directly into the misaligned output
+			std::vector<char> result(4 * length + 8);
+			for (int offset = 0; offset < 8; ++offset)
+			{
+				int errorCode = Decompressor::Decompress(algo, &result[offset], 4 * length, compBuf.data(), compSize);
+
+				EXPECT_EQ(errorCode, 0);
+				EXPECT_EQ(std::memcmp(vec.data(), &result[offset], 4 * length), 0);
+			}
+		}
+	}
+}
+
+
+TEST_F(CodecTest, DecompressRange)
+{
+	const unsigned int length = 1030;
+	std::vector<int> vec = RandomInts(length, -1000, 12);
+	vec[5] = FST_NA_INT;
+
+	std::vector<int> logicals(length);
+	for (unsigned int pos = 0; pos < length; ++pos) logicals[pos] = rng() % 3 == 0 ? FST_NA_INT : rng() % 2;
+
+	// range support for LZ4, shuffle, frame-of-reference and logical codecs, the others use the staging buffer
+	CompAlgo intAlgos[] = { CompAlgo::LZ4, CompAlgo::ZSTD, CompAlgo::LZ4_SHUF4, CompAlgo::ZSTD_SHUF4, CompAlgo::LZ4_SHUF8,
+		CompAlgo::ZSTD_SHUF8, CompAlgo::FOR_INT, CompAlgo::LZ4_FOR_INT, CompAlgo::ZSTD_FOR_INT, CompAlgo::RLE_INT };
+	CompAlgo logicalAlgos[] = { CompAlgo::LOGIC64, CompAlgo::LZ4_LOGIC64 };
+
+	unsigned int starts[] = { 0, 1, 7, 8, 31, 127, 128, 129, 514, 1000, length - 1 };
+	unsigned int sizes[] = { 1, 9, 33, 128, 300, length };
+
+	for (int type = 0; type < 2; ++type)
+	{
+		const char* src = reinterpret_cast<const char*>(type == 0 ? vec.data() : logicals.data());
+		std::vector<CompAlgo> algos;
+		if (type == 0) algos.assign(std::begin(intAlgos), std::end(intAlgos));
+		else algos.assign(std::begin(logicalAlgos), std::end(logicalAlgos));
+
+		for (CompAlgo algo : algos)
+		{
+			SingleCompressor compressor(algo, 50);
+			int bufSize = compressor.CompressBufferSize(4 * length);
+			std::vector<char> compBuf(bufSize);
+
+			CompAlgo usedAlgo;
+			int compSize = compressor.Compress(compBuf.data(), bufSize, src, 4 * length, usedAlgo);
+
+			std::vector<char> result(4 * length + 4);
+
+			// shuffled doubles are decoded in units of 8 bytes
+			unsigned int elementSize = (algo == CompAlgo::LZ4_SHUF8 || algo == CompAlgo::ZSTD_SHUF8) ? 8 : 4;
+			unsigned int nrOfElements = 4 * length / elementSize;
+
+			for (unsigned int start : starts)
+			{
+				for (unsigned int size : sizes)
+				{
+					if (start >= nrOfElements) continue;
+					size = std::min(size, nrOfElements - start);
+
+					// the output of a range is not 8-byte aligned in general
+					for (int offset = 0; offset < 8; offset += 4)
+					{
+						int errorCode = Decompressor::DecompressRange(usedAlgo, &result[offset], 4 * length, compBuf.data(), compSize,
+							elementSize * start, elementSize * size);
+
+						EXPECT_EQ(errorCode, 0) << "algo " << algo << ", start " << start << ", size " << size;
+						EXPECT_EQ(std::memcmp(&src[elementSize * start], &result[offset], elementSize * size), 0)
+							<< "algo " << algo << ", start " << start << ", size " << size;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+TEST_F(CodecTest, IntegralDouble)
+{
+	unsigned int lengths[] = { 1, 129, BLOCKSIZE_REAL };
+
+	const unsigned long long naBits = 0x7ff00000000007a2ULL;  // R's NA_real_
+	double naReal;
+	std::memcpy(&naReal, &naBits, 8);
+
+	for (unsigned int length : lengths)
+	{
+		// counts with NA's are stored with 2 bytes per value before entropy coding
+		std::vector<double> vec(length);
+		for (unsigned int pos = 0; pos < length; ++pos) vec[pos] = static_cast<double>(static_cast<int>(rng() % 20000) - 100);
+		for (unsigned int pos = 1; pos < length; pos += 17) vec[pos] = naReal;
+
+		EXPECT_EQ(DecimalScaleDouble(vec.data(), length, 0), 0);
+
+		int compSize = RoundTrip(CompAlgo::INT_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+		EXPECT_EQ(compSize, static_cast<int>(DEC_HEADER_SIZE + NARROW_HEADER_SIZE + 2 * length));
+
+		RoundTrip(CompAlgo::LZ4_INT_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+		RoundTrip(CompAlgo::ZSTD_INT_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+
+		// identifiers beyond the integer range
+		for (unsigned int pos = 0; pos < length; ++pos) vec[pos] = 1e12 + static_cast<double>(rng());
+		compSize = RoundTrip(CompAlgo::INT_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+		EXPECT_EQ(compSize, static_cast<int>(DEC_HEADER_SIZE + NARROW_HEADER_SIZE + 8 * length));
+
+		// fractional values and negative zero store the block unpacked
+		vec[length - 1] = 0.5;
+		EXPECT_EQ(DecimalScaleDouble(vec.data(), length, 0), -1);
+		compSize = RoundTrip(CompAlgo::LZ4_INT_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+		EXPECT_EQ(compSize, static_cast<int>(DEC_HEADER_SIZE + 8 * length));
+
+		vec[length - 1] = -0.0;
+		compSize = RoundTrip(CompAlgo::ZSTD_INT_DOUBLE, reinterpret_cast<char*>(vec.data()), 8 * length);
+		EXPECT_EQ(compSize, static_cast<int>(DEC_HEADER_SIZE + 8 * length));
+	}
+
+	// blocks with fractional values are passed to the wrapped compressor
+	SingleCompressor shuffle(CompAlgo::LZ4_SHUF8, 100);
+	IntegralDoubleCompressor integral(&shuffle, CompAlgo::LZ4_INT_DOUBLE, 100);
+
+	int bufSize = integral.CompressBufferSize(8 * BLOCKSIZE_REAL);
+	std::vector<char> compBuf(bufSize);
+	std::vector<double> vec(BLOCKSIZE_REAL);
+	CompAlgo usedAlgo;
+
+	for (unsigned int pos = 0; pos < BLOCKSIZE_REAL; ++pos) vec[pos] = static_cast<double>(pos % 500);
+	integral.Compress(compBuf.data(), bufSize, reinterpret_cast<char*>(vec.data()), 8 * BLOCKSIZE_REAL, usedAlgo);
+	EXPECT_EQ(usedAlgo, CompAlgo::LZ4_INT_DOUBLE);
+
+	vec[BLOCKSIZE_REAL / 2] = 0.25;
+	integral.Compress(compBuf.data(), bufSize, reinterpret_cast<char*>(vec.data()), 8 * BLOCKSIZE_REAL, usedAlgo);
+	EXPECT_EQ(usedAlgo, CompAlgo::LZ4_SHUF8);
+}
+
+
+TEST_F(CodecTest, Adaptive)
+{
+	SingleCompressor lz4(CompAlgo::LZ4_SHUF8, 100);
+	SingleCompressor zstd(CompAlgo::ZSTD_SHUF8, 50);
+	Compressor* candidates[] = { &lz4, &zstd };
+	AdaptiveCompressor adaptive(candidates, 2, 8, 100);
+
+	int bufSize = adaptive.CompressBufferSize(8 * BLOCKSIZE_REAL);
+	std::vector<char> compBuf(bufSize);
+	std::vector<double> result(BLOCKSIZE_REAL);
+	CompAlgo usedAlgo;
+
+	// hashes are stored without compression
+	std::vector<unsigned long long> randomVec(BLOCKSIZE_REAL);
+	for (unsigned long long& value : randomVec) value = (static_cast<unsigned long long>(rng()) << 32) | rng();
+
+	int compSize = adaptive.Compress(compBuf.data(), bufSize, reinterpret_cast<char*>(randomVec.data()), 8 * BLOCKSIZE_REAL, usedAlgo);
+	EXPECT_EQ(usedAlgo, CompAlgo::UNCOMPRESS);
+	EXPECT_EQ(compSize, 8 * BLOCKSIZE_REAL);
+	EXPECT_EQ(memcmp(compBuf.data(), randomVec.data(), compSize), 0);
+
+	// small integers stored as doubles are compressed with one of the candidates
+	std::vector<double> countVec(BLOCKSIZE_REAL);
+	for (double& value : countVec) value = static_cast<double>(rng() % 16);
+
+	compSize = adaptive.Compress(compBuf.data(), bufSize, reinterpret_cast<char*>(countVec.data()), 8 * BLOCKSIZE_REAL, usedAlgo);
+	EXPECT_TRUE(usedAlgo == CompAlgo::LZ4_SHUF8 || usedAlgo == CompAlgo::ZSTD_SHUF8);
+	EXPECT_LT(compSize, 2 * BLOCKSIZE_REAL);
+
+	Decompressor::Decompress(usedAlgo, reinterpret_cast<char*>(result.data()), 8 * BLOCKSIZE_REAL, compBuf.data(), compSize);
+	EXPECT_EQ(memcmp(result.data(), countVec.data(), 8 * BLOCKSIZE_REAL), 0);
+
+	// small blocks are sampled completely
+	compSize = adaptive.Compress(compBuf.data(), bufSize, reinterpret_cast<char*>(countVec.data()), 8 * 100, usedAlgo);
+	EXPECT_LE(compSize, 8 * 100);
+
+	// the runs of sorted integers are counted in the full block, as the sample slices add runs
+	SingleCompressor shuffle(CompAlgo::LZ4_SHUF4, 0);
+	RunLengthCompressor runCompressor(&shuffle, RLE_MIN_RUN_LENGTH);
+	SingleCompressor frame(CompAlgo::LZ4_FOR_INT, 100);
+	Compressor* intCandidates[] = { &runCompressor, &frame };
+	AdaptiveCompressor intAdaptive(intCandidates, 2, 4, 50);
+
+	int intBufSize = intAdaptive.CompressBufferSize(4 * BLOCKSIZE_INT);
+	std::vector<char> intBuf(intBufSize);
+	std::vector<int> sortedVec(BLOCKSIZE_INT);
+	std::mt19937 runRng(1234);
+	int value = 1000;
+
+	for (int block = 0; block < 20; ++block)
+	{
+		for (unsigned int pos = 0; pos < BLOCKSIZE_INT; ++pos)
+		{
+			if (runRng() % 150 == 0) value += 1 + runRng() % 3;  // average run length of 150
+			sortedVec[pos] = value;
+		}
+
+		CompAlgo runAlgo;
+		int runSize = runCompressor.Compress(intBuf.data(), intBufSize, reinterpret_cast<char*>(sortedVec.data()), 4 * BLOCKSIZE_INT, runAlgo);
+		compSize = intAdaptive.Compress(intBuf.data(), intBufSize, reinterpret_cast<char*>(sortedVec.data()), 4 * BLOCKSIZE_INT, usedAlgo);
+		EXPECT_EQ(usedAlgo, runAlgo);
+		EXPECT_EQ(compSize, runSize);
+	}
+}
+
+
+TEST_F(CodecTest, DualCompressor)
+{
+	DualCompressor compressor(CompAlgo::LZ4_SHUF4, CompAlgo::ZSTD_SHUF4, 100, 0);
+
+	const int nrOfBlocks = 64;
+	int bufSize = compressor.CompressBufferSize(4 * BLOCKSIZE_INT);
+	std::vector<int> vec = RandomInts(nrOfBlocks * BLOCKSIZE_INT, 0, 10);
+	std::vector<char> compBuf(static_cast<size_t>(nrOfBlocks) * bufSize);
+	std::vector<int> compSizes(nrOfBlocks);
+	std::vector<CompAlgo> compAlgos(nrOfBlocks);
+
+	// a single compressor is shared by all threads
+#pragma omp parallel for schedule(static, 1)
+	for (int block = 0; block < nrOfBlocks; ++block)
+	{
+		compSizes[block] = compressor.Compress(&compBuf[block * bufSize], bufSize,
+			reinterpret_cast<char*>(&vec[block * BLOCKSIZE_INT]), 4 * BLOCKSIZE_INT, compAlgos[block]);
+	}
+
+	int nrOfAlgo1 = 0;
+	std::vector<int> result(BLOCKSIZE_INT);
+
+	for (int block = 0; block < nrOfBlocks; ++block)
+	{
+		nrOfAlgo1 += compAlgos[block] == CompAlgo::LZ4_SHUF4;
+		Decompressor::Decompress(compAlgos[block], reinterpret_cast<char*>(result.data()), 4 * BLOCKSIZE_INT,
+			&compBuf[block * bufSize], compSizes[block]);
+		EXPECT_EQ(memcmp(result.data(), &vec[block * BLOCKSIZE_INT], 4 * BLOCKSIZE_INT), 0);
+	}
+
+	// both algorithms are used
+	EXPECT_GT(nrOfAlgo1, 0);
+	EXPECT_LT(nrOfAlgo1, nrOfBlocks);
+}
+
+
+TEST_F(CodecTest, ScratchBuffer)
+{
+	char* slotBuf;
+	{
+		ScratchBuffer scratch(SCRATCH_CODEC, 4 * BLOCKSIZE_INT);
+		slotBuf = scratch.Data();
+	}
+
+	// blocks up to the retain size reuse the buffer of the slot
+	{
+		ScratchBuffer scratch(SCRATCH_CODEC, 100);
+		EXPECT_EQ(scratch.Data(), slotBuf);
+	}
+
+	// larger blocks get a buffer of their own
+	{
+		ScratchBuffer scratch(SCRATCH_CODEC, BLOCKSIZE_MAX);
+		EXPECT_NE(scratch.Data(), slotBuf);
+		std::memset(scratch.Data(), 1, BLOCKSIZE_MAX);
+
+		ScratchBuffer slotScratch(SCRATCH_CODEC, 200);
+		EXPECT_EQ(slotScratch.Data(), slotBuf);
+	}
+}
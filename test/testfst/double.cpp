@@ -0,0 +1,248 @@
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-filepath.h"
+
+#include <interface/fststore.h>
+#include <interface/fstwriteoptions.h>
+#include <interface/openmphelper.h>
+
+#include <fsttable.h>
+
+#include "testhelpers.h"
+#include "ReadWriteTester.h"
+
+
+using namespace testing::internal;
+
+class DoubleTest : public ::testing::Test
+{
+protected:
+	FilePath testDataDir;
+	std::string filePath;
+
+	virtual void SetUp()
+	{
+		filePath = GetFilePath("double.fst");
+	}
+};
+
+
+TEST_F(DoubleTest, DecimalBlocks)
+{
+	int nrOfRows = 50000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Price" };
+	fstTable.SetColumnNames(colNames);
+
+	DoubleVectorAdapter doubleVec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	double* doubleP = doubleVec.Data();
+
+	const unsigned long long naBits = 0x7ff00000000007a2ULL;  // R's NA_real_
+	double naReal;
+	std::memcpy(&naReal, &naBits, 8);
+
+	// price series with 2 decimals and NA's
+	std::mt19937 rng(1234);
+	long long cents = 1000000;
+	for (int pos = 0; pos < nrOfRows; ++pos)
+	{
+		cents += static_cast<long long>(rng() % 21) - 10;
+		doubleP[pos] = cents / 100.0;
+	}
+	for (int pos = 3; pos < nrOfRows; pos += 101) doubleP[pos] = naReal;
+
+	// blocks without a fixed number of decimals
+	for (int pos = 10000; pos < 12000; ++pos) doubleP[pos] = pos / 3.0;
+	doubleP[20000] = -0.0;
+	doubleP[nrOfRows - 1] = 1e-300;
+
+	fstTable.SetDoubleColumn(&doubleVec, 0);
+
+	int compressionLevels[] = { 0, 30, 50, 75, 100 };
+	for (int compression : compressionLevels)
+	{
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, compression);
+	}
+}
+
+
+TEST_F(DoubleTest, IntegralBlocks)
+{
+	int nrOfRows = 50000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Count" };
+	fstTable.SetColumnNames(colNames);
+
+	DoubleVectorAdapter doubleVec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	double* doubleP = doubleVec.Data();
+
+	const unsigned long long naBits = 0x7ff00000000007a2ULL;  // R's NA_real_
+	double naReal;
+	std::memcpy(&naReal, &naBits, 8);
+
+	// counts with NA's
+	std::mt19937 rng(1234);
+	for (int pos = 0; pos < nrOfRows; ++pos) doubleP[pos] = static_cast<double>(rng() % 300);
+	for (int pos = 5; pos < nrOfRows; pos += 97) doubleP[pos] = naReal;
+
+	// identifiers that need 4 or 8 bytes, a fractional block and negative zero
+	for (int pos = 8000; pos < 10000; ++pos) doubleP[pos] = 2000000000.0 + pos;
+	for (int pos = 10000; pos < 12000; ++pos) doubleP[pos] = 4503599627370496.0 - pos;
+	for (int pos = 14000; pos < 16000; ++pos) doubleP[pos] = pos + 0.5;
+	doubleP[20000] = -0.0;
+
+	fstTable.SetDoubleColumn(&doubleVec, 0);
+
+	int compressionLevels[] = { 0, 30, 50, 75, 100 };
+	for (int compression : compressionLevels)
+	{
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, compression);
+	}
+}
+
+
+TEST_F(DoubleTest, WideIntegralBlocks)
+{
+	int nrOfRows = 300000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Id" };
+	fstTable.SetColumnNames(colNames);
+
+	DoubleVectorAdapter doubleVec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	double* doubleP = doubleVec.Data();
+
+	// compressible whole numbers and fixed-point values with a range of more than 2^32 in every block, stored as
+	// unpacked integer64 values by the decimal codecs
+	std::mt19937 rng(1234);
+	for (int pos = 0; pos < nrOfRows / 2; ++pos)
+	{
+		doubleP[pos] = static_cast<double>(rng() % 1000) * 8589934592.0 + pos % 7;
+	}
+
+	for (int pos = nrOfRows / 2; pos < nrOfRows; ++pos)
+	{
+		doubleP[pos] = static_cast<double>(static_cast<long long>(rng() % 1000) * 10000000000LL + pos % 100) / 100.0;
+	}
+
+	fstTable.SetDoubleColumn(&doubleVec, 0);
+
+	unsigned int blockSizes[] = { 0, 1048576 };
+	std::vector<FstColumnWriteOptions> options;
+	for (unsigned int blockSize : blockSizes)
+	{
+		options.push_back(FstColumnWriteOptions(FstColumnCodec::DEFAULT, 75, blockSize));
+		options.push_back(FstColumnWriteOptions(FstColumnCodec::DEFAULT, 100, blockSize));
+
+		FstColumnWriteOptions autotuneOptions(FstAutotune(0.001, 0.001));
+		autotuneOptions.blockSize = blockSize;
+		options.push_back(autotuneOptions);
+	}
+
+	int prevThreads = ThreadsFst(2);
+
+	int threads[] = { 2, 4 };
+	for (int nrOfThreads : threads)
+	{
+		ThreadsFst(nrOfThreads);
+
+		for (FstColumnWriteOptions& option : options)
+		{
+			ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 50, option);
+		}
+	}
+
+	ThreadsFst(prevThreads);
+}
+
+
+TEST_F(DoubleTest, SmoothBlocks)
+{
+	int nrOfRows = 500000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Signal" };
+	fstTable.SetColumnNames(colNames);
+
+	DoubleVectorAdapter doubleVec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	double* doubleP = doubleVec.Data();
+
+	// slowly varying sensor measurements with noise
+	std::mt19937 rng(1234);
+	std::normal_distribution<double> noise(0.0, 1.0);
+	for (int pos = 0; pos < nrOfRows; ++pos) doubleP[pos] = 20.0 + 5.0 * std::sin(pos / 500.0) + 0.01 * noise(rng);
+
+	fstTable.SetDoubleColumn(&doubleVec, 0);
+
+	int compressionLevels[] = { 75, 100 };
+	for (int compression : compressionLevels)
+	{
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, compression);
+	}
+
+	ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 50, FstColumnWriteOptions(FstAutotune(0.001, 0.001)));
+
+	// XOR-ing successive values drops the shared sign, exponent and leading mantissa bits
+	FstStore fstStore(filePath);
+	fstStore.fstWrite(fstTable, 100);
+
+	std::ifstream fstFile(filePath, std::ios::binary | std::ios::ate);
+	EXPECT_LT(static_cast<long long>(fstFile.tellg()), 8LL * nrOfRows * 3 / 4);
+}
+
+
+TEST_F(DoubleTest, NaNPayloads)
+{
+	int nrOfRows = 200000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Price" };
+	fstTable.SetColumnNames(colNames);
+
+	DoubleVectorAdapter doubleVec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	double* doubleP = doubleVec.Data();
+
+	const unsigned long long naBits = 0x7ff00000000007a2ULL;  // R's NA_real_
+	const unsigned long long nanBits = 0x7ff8000000000000ULL;  // R's NaN
+	double naReal, nanReal;
+	std::memcpy(&naReal, &naBits, 8);
+	std::memcpy(&nanReal, &nanBits, 8);
+
+	// decimal and whole number blocks with both NA and NaN values
+	std::mt19937 rng(1234);
+	long long cents = 1000000;
+	for (int pos = 0; pos < nrOfRows; ++pos)
+	{
+		cents += static_cast<long long>(rng() % 21) - 10;
+		doubleP[pos] = pos < nrOfRows / 2 ? cents / 100.0 : static_cast<double>(cents);
+	}
+	for (int pos = 3; pos < nrOfRows; pos += 101) doubleP[pos] = naReal;
+	for (int pos = 7; pos < nrOfRows; pos += 103) doubleP[pos] = nanReal;
+
+	fstTable.SetDoubleColumn(&doubleVec, 0);
+
+	FstStore fstStore(filePath);
+
+	int compressionLevels[] = { 30, 50, 75, 100 };
+	for (int compression : compressionLevels)
+	{
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, compression);
+
+		// such blocks are compressed with the wrapped codec instead of stored as-is
+		fstStore.fstWrite(fstTable, compression);
+		std::ifstream fstFile(filePath, std::ios::binary | std::ios::ate);
+		EXPECT_LT(static_cast<long long>(fstFile.tellg()), 8LL * nrOfRows * 3 / 4);
+	}
+}
@@ -110,3 +110,31 @@ TEST_F(FactorTest, FactorRead)
   std::unique_ptr<StringColumn> col_names(new StringColumn());
   fstStore.fstRead(*tableReader, columnSelection, 1, -1, columnFactory, keyIndex, selectedCols, &*col_names);
 }
+
+
+TEST_F(FactorTest, SortedLevels)
+{
+	const int nrOfRows = 50000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Factor" };
+	fstTable.SetColumnNames(colNames);
+
+	// sorted categories are stored as runs
+	int nrOfLevels = 200;
+	FactorVectorAdapter factorVec(nrOfRows, nrOfLevels, FstColumnAttribute::FACTOR_BASE);
+	int* levelData = factorVec.LevelData();
+	for (int pos = 0; pos < nrOfRows; ++pos) levelData[pos] = 1 + pos / 250;
+
+	std::vector<std::string>* levelVec = factorVec.DataPtr()->Levels()->StrVector()->StrVec();
+	for (int pos = 0; pos < nrOfLevels; pos++) (*levelVec)[pos] = to_string(pos);
+
+	fstTable.SetFactorColumn(&factorVec, 0);
+
+	int compressionLevels[] = { 0, 40, 70 };
+	for (int compression : compressionLevels)
+	{
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, compression);
+	}
+}
@@ -0,0 +1,105 @@
+
+#include <fstream>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-filepath.h"
+
+#include <interface/fststore.h>
+
+#include <fsttable.h>
+#include <IntegerMethods.h>
+
+#include "testhelpers.h"
+#include "ReadWriteTester.h"
+
+
+using namespace testing::internal;
+
+class IntegerTest : public ::testing::Test
+{
+protected:
+	std::string filePath;
+
+	virtual void SetUp()
+	{
+		filePath = GetFilePath("integer.fst");
+	}
+
+	long long FileSize() const
+	{
+		std::ifstream fstFile(filePath, std::ios::binary | std::ios::ate);
+		return static_cast<long long>(fstFile.tellg());
+	}
+};
+
+
+TEST_F(IntegerTest, SmallRange)
+{
+	int nrOfRows = 1000000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Integer" };
+	fstTable.SetColumnNames(colNames);
+
+	// random values with a 10 bit range and a large offset
+	std::mt19937 rng(1234);
+	IntVectorAdapter intVec(nrOfRows, FstColumnAttribute::INT_32_BASE, 0);
+	int* intP = intVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) intP[pos] = 1000000 + static_cast<int>(rng() % 1000);
+	fstTable.SetIntegerColumn(&intVec, 0);
+
+	FstStore fstStore(filePath);
+
+	// per block codec selection only runs above compression level 50
+	int levels[] = { 60, 80, 100 };
+	for (int level : levels)
+	{
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, level);
+
+		// frame of reference codecs store close to 10 bits per value
+		fstStore.fstWrite(fstTable, level);
+		EXPECT_LT(FileSize(), 4LL * nrOfRows * 12 / 32);
+	}
+}
+
+
+TEST_F(IntegerTest, SortedValues)
+{
+	int nrOfRows = 1000000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Integer" };
+	fstTable.SetColumnNames(colNames);
+
+	// sorted values with an average run length of 100
+	std::mt19937 rng(1234);
+	IntVectorAdapter intVec(nrOfRows, FstColumnAttribute::INT_32_BASE, 0);
+	int* intP = intVec.Data();
+	int value = 0;
+	for (int pos = 0; pos < nrOfRows; ++pos)
+	{
+		if (rng() % 100 == 0) ++value;
+		intP[pos] = value;
+	}
+	fstTable.SetIntegerColumn(&intVec, 0);
+
+	FstStore fstStore(filePath);
+
+	// run-length encoded blocks are never larger than blocks of the shuffle codec at the same level
+	int levels[] = { 50, 100 };
+	FstColumnWriteOptions codecs[] = { FstColumnWriteOptions(FstColumnCodec::LZ4, 0), FstColumnWriteOptions(FstColumnCodec::ZSTD, 100) };
+
+	for (int option = 0; option < 2; ++option)
+	{
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, levels[option]);
+
+		fstStore.fstWrite(fstTable, levels[option]);
+		long long defaultSize = FileSize();
+
+		fstStore.fstWrite(fstTable, levels[option], std::vector<FstColumnWriteOptions>(1, codecs[option]));
+		EXPECT_LE(defaultSize, FileSize());
+	}
+}
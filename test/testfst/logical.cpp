@@ -50,3 +50,28 @@ TEST_F(LogicalTest, SmallVec)
 
 //	ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 0);
 }
+
+
+TEST_F(LogicalTest, LongRuns)
+{
+	int nrOfRows = 100000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Logical" };
+	fstTable.SetColumnNames(colNames);
+
+	// status flags with long runs and a single block of short runs
+	LogicalVectorAdapter logicalVec(nrOfRows);
+	int* logicalP = logicalVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) logicalP[pos] = (pos / 1000) % 2;
+	for (int pos = 30000; pos < 30500; ++pos) logicalP[pos] = pos % 3 == 0 ? FST_NA_INT : pos % 2;
+
+	fstTable.SetLogicalColumn(&logicalVec, 0);
+
+	int compressionLevels[] = { 0, 30, 80 };
+	for (int compression : compressionLevels)
+	{
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, compression);
+	}
+}
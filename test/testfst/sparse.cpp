@@ -0,0 +1,126 @@
+
+#include <cstring>
+#include <fstream>
+
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-filepath.h"
+
+#include <interface/fststore.h>
+#include <interface/fstdefines.h>
+#include <interface/fstwriteoptions.h>
+
+#include <fsttable.h>
+
+#include "testhelpers.h"
+#include "ReadWriteTester.h"
+
+
+using namespace testing::internal;
+
+class SparseTest : public ::testing::Test
+{
+protected:
+	FilePath testDataDir;
+	std::string filePath;
+	double naReal;
+
+	virtual void SetUp()
+	{
+		filePath = GetFilePath("sparse.fst");
+
+		const unsigned long long naBits = 0x7ff00000000007a2ULL;  // R's NA_real_
+		std::memcpy(&naReal, &naBits, 8);
+	}
+};
+
+
+TEST_F(SparseTest, ConstantColumns)
+{
+	int nrOfRows = 200000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(2, nrOfRows);
+
+	vector<std::string> colNames{ "AllNA", "Constant" };
+	fstTable.SetColumnNames(colNames);
+
+	IntVectorAdapter intVec(nrOfRows, FstColumnAttribute::INT_32_BASE, 0);
+	int* intP = intVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) intP[pos] = FST_NA_INT;
+	fstTable.SetIntegerColumn(&intVec, 0);
+
+	DoubleVectorAdapter doubleVec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	double* doubleP = doubleVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) doubleP[pos] = 3.14;
+	fstTable.SetDoubleColumn(&doubleVec, 1);
+
+	ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 50);
+
+	// both columns are stored as a single element
+	FstStore fstStore(filePath);
+	fstStore.fstWrite(fstTable, 50);
+
+	std::ifstream fstFile(filePath, std::ios::binary | std::ios::ate);
+	EXPECT_LT(static_cast<long long>(fstFile.tellg()), 1000);
+}
+
+
+TEST_F(SparseTest, SparseBlocks)
+{
+	int nrOfRows = 100000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(3, nrOfRows);
+
+	vector<std::string> colNames{ "Integer", "Double", "Integer64" };
+	fstTable.SetColumnNames(colNames);
+
+	// mostly NA with a few values and a dense range
+	IntVectorAdapter intVec(nrOfRows, FstColumnAttribute::INT_32_BASE, 0);
+	int* intP = intVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) intP[pos] = pos % 997 == 0 ? pos : FST_NA_INT;
+	for (int pos = 50000; pos < 52000; ++pos) intP[pos] = pos;
+	intP[0] = 7;  // background value found at the end of the block
+	fstTable.SetIntegerColumn(&intVec, 0);
+
+	DoubleVectorAdapter doubleVec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	double* doubleP = doubleVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) doubleP[pos] = pos % 1009 == 0 ? pos / 3.0 : naReal;
+	fstTable.SetDoubleColumn(&doubleVec, 1);
+
+	Int64VectorAdapter int64Vec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	long long* int64P = int64Vec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) int64P[pos] = pos < 90000 ? 0 : pos;
+	fstTable.SetInt64Column(&int64Vec, 2);
+
+	int compressionLevels[] = { 0, 30, 80 };
+	for (int compression : compressionLevels)
+	{
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, compression);
+	}
+}
+
+
+TEST_F(SparseTest, LargeSparseBlocks)
+{
+	int nrOfRows = 1000000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Integer" };
+	fstTable.SetColumnNames(colNames);
+
+	// mostly NA, blocks hold more elements than a sparse block can address
+	IntVectorAdapter intVec(nrOfRows, FstColumnAttribute::INT_32_BASE, 0);
+	int* intP = intVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) intP[pos] = pos % 997 == 0 ? pos : FST_NA_INT;
+	fstTable.SetIntegerColumn(&intVec, 0);
+
+	FstColumnWriteOptions options(FstColumnCodec::DEFAULT, -1, 4 * 1048576);
+	ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 50, options);
+
+	// blocks are compressed by the wrapped compressor instead of stored as-is
+	FstStore fstStore(filePath);
+	fstStore.fstWrite(fstTable, 50, std::vector<FstColumnWriteOptions>(1, options));
+
+	std::ifstream fstFile(filePath, std::ios::binary | std::ios::ate);
+	EXPECT_LT(static_cast<long long>(fstFile.tellg()), nrOfRows);
+}
@@ -0,0 +1,279 @@
+
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "gtest/internal/gtest-filepath.h"
+
+#include <interface/fststore.h>
+#include <interface/fstwriteoptions.h>
+
+#include <fsttable.h>
+
+#include "testhelpers.h"
+#include "ReadWriteTester.h"
+
+
+using namespace testing::internal;
+
+class WriteOptionsTest : public ::testing::Test
+{
+protected:
+	std::string filePath;
+
+	virtual void SetUp()
+	{
+		filePath = GetFilePath("writeoptions.fst");
+	}
+
+	long long FileSize() const
+	{
+		std::ifstream fstFile(filePath, std::ios::binary | std::ios::ate);
+		return static_cast<long long>(fstFile.tellg());
+	}
+};
+
+
+TEST_F(WriteOptionsTest, ColumnCodecs)
+{
+	int nrOfRows = 50000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(4, nrOfRows);
+
+	vector<std::string> colNames{ "Character", "Integer", "Double", "Integer64" };
+	fstTable.SetColumnNames(colNames);
+
+	std::mt19937 rng(1234);
+
+	StringColumn strColumn{};
+	strColumn.AllocateVec(nrOfRows);
+	strColumn.SetEncoding(StringEncoding::UTF8);
+	std::vector<std::string>* strVec = strColumn.StrVector()->StrVec();
+	for (int pos = 0; pos < nrOfRows; ++pos) (*strVec)[pos] = "item_" + std::to_string(rng() % 100000);
+	fstTable.SetStringColumn(static_cast<IStringColumn*>(&strColumn), 0);
+
+	IntVectorAdapter intVec(nrOfRows, FstColumnAttribute::INT_32_BASE, 0);
+	int* intP = intVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) intP[pos] = static_cast<int>(rng() % 1000);
+	fstTable.SetIntegerColumn(&intVec, 1);
+
+	DoubleVectorAdapter doubleVec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	double* doubleP = doubleVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) doubleP[pos] = (rng() % 100000) / 7.0;
+	fstTable.SetDoubleColumn(&doubleVec, 2);
+
+	Int64VectorAdapter int64Vec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	long long* int64P = int64Vec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) int64P[pos] = static_cast<long long>(rng() % 1000000) << 10;
+	fstTable.SetInt64Column(&int64Vec, 3);
+
+	FstColumnCodec codecs[] = { FstColumnCodec::NONE, FstColumnCodec::LZ4, FstColumnCodec::ZSTD };
+	int levels[] = { 0, 50, 100 };
+
+	for (FstColumnCodec codec : codecs)
+	{
+		for (int level : levels)
+		{
+			ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 50, FstColumnWriteOptions(codec, level));
+		}
+	}
+
+	// compression level override only
+	ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 0, FstColumnWriteOptions(FstColumnCodec::DEFAULT, 80));
+}
+
+
+TEST_F(WriteOptionsTest, DictionaryCodecs)
+{
+	int nrOfRows = 100000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Category" };
+	fstTable.SetColumnNames(colNames);
+
+	// low cardinality column with a repeating pattern of level codes
+	StringColumn strColumn{};
+	strColumn.AllocateVec(nrOfRows);
+	strColumn.SetEncoding(StringEncoding::UTF8);
+	std::vector<std::string>* strVec = strColumn.StrVector()->StrVec();
+	for (int pos = 0; pos < nrOfRows; ++pos) (*strVec)[pos] = "category_" + std::to_string(pos % 50);
+	fstTable.SetStringColumn(static_cast<IStringColumn*>(&strColumn), 0);
+
+	FstStore fstStore(filePath);
+
+	// at low compression levels, the default codes are bit-packed only
+	fstStore.fstWrite(fstTable, 20);
+	long long defaultSize = FileSize();
+
+	FstColumnCodec codecs[] = { FstColumnCodec::LZ4, FstColumnCodec::ZSTD };
+	for (FstColumnCodec codec : codecs)
+	{
+		FstColumnWriteOptions options(codec, 20);
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 20, options);
+
+		// explicit codecs compress the bit-packed codes
+		fstStore.fstWrite(fstTable, 20, std::vector<FstColumnWriteOptions>(1, options));
+		EXPECT_LT(FileSize(), defaultSize / 2);
+	}
+}
+
+
+TEST_F(WriteOptionsTest, MixedColumns)
+{
+	int nrOfRows = 50000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(2, nrOfRows);
+
+	vector<std::string> colNames{ "Archive", "Hot" };
+	fstTable.SetColumnNames(colNames);
+
+	StringColumn strColumn{};
+	strColumn.AllocateVec(nrOfRows);
+	strColumn.SetEncoding(StringEncoding::UTF8);
+	std::vector<std::string>* strVec = strColumn.StrVector()->StrVec();
+	for (int pos = 0; pos < nrOfRows; ++pos) (*strVec)[pos] = "record " + std::to_string(pos);
+	fstTable.SetStringColumn(static_cast<IStringColumn*>(&strColumn), 0);
+
+	IntVectorAdapter intVec(nrOfRows, FstColumnAttribute::INT_32_BASE, 0);
+	int* intP = intVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) intP[pos] = pos;
+	fstTable.SetIntegerColumn(&intVec, 1);
+
+	FstStore fstStore(filePath);
+
+	// both columns uncompressed
+	std::vector<FstColumnWriteOptions> uncompressed(2, FstColumnWriteOptions(FstColumnCodec::NONE, 0));
+	fstStore.fstWrite(fstTable, 100, uncompressed);
+	long long uncompressedSize = FileSize();
+
+	// maximum ZSTD text column and uncompressed numeric column
+	std::vector<FstColumnWriteOptions> mixed{ FstColumnWriteOptions(FstColumnCodec::ZSTD, 100), FstColumnWriteOptions(FstColumnCodec::NONE, 0) };
+	fstStore.fstWrite(fstTable, 0, mixed);
+	long long mixedSize = FileSize();
+
+	EXPECT_LT(mixedSize, uncompressedSize - 4 * nrOfRows);  // text column is compressed
+	EXPECT_GT(mixedSize, 4LL * nrOfRows);  // integer column is not compressed
+
+	FstTable tableRead;
+	ColumnFactory columnFactory;
+	std::vector<int> keyIndex;
+	StringArray selectedCols;
+	std::unique_ptr<StringColumn> col_names(new StringColumn());
+	fstStore.fstRead(tableRead, nullptr, 1, -1, &columnFactory, keyIndex, &selectedCols, &*col_names);
+
+	std::shared_ptr<DestructableObject> column;
+	FstColumnType type;
+	std::string colName;
+	std::string annotation;
+	short int scale;
+
+	tableRead.GetColumn(0, column, type, colName, scale, annotation);
+	EXPECT_EQ(*static_cast<StringVector*>(&(*column))->StrVec(), *strVec);
+
+	tableRead.GetColumn(1, column, type, colName, scale, annotation);
+	EXPECT_EQ(std::memcmp(static_cast<IntVector*>(&(*column))->Data(), intP, 4 * nrOfRows), 0);
+}
+
+
+TEST_F(WriteOptionsTest, BlockSizes)
+{
+	int nrOfRows = 300000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(3, nrOfRows);
+
+	vector<std::string> colNames{ "Integer", "Double", "Integer64" };
+	fstTable.SetColumnNames(colNames);
+
+	std::mt19937 rng(4321);
+
+	IntVectorAdapter intVec(nrOfRows, FstColumnAttribute::INT_32_BASE, 0);
+	int* intP = intVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) intP[pos] = static_cast<int>(rng() % 5000);
+	fstTable.SetIntegerColumn(&intVec, 0);
+
+	DoubleVectorAdapter doubleVec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	double* doubleP = doubleVec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) doubleP[pos] = (rng() % 100000) / 100.0;
+	fstTable.SetDoubleColumn(&doubleVec, 1);
+
+	Int64VectorAdapter int64Vec(nrOfRows, FstColumnAttribute::NONE, FstScale::UNIT);
+	long long* int64P = int64Vec.Data();
+	for (int pos = 0; pos < nrOfRows; ++pos) int64P[pos] = 1000000000000LL + static_cast<long long>(rng() % 1000000);
+	fstTable.SetInt64Column(&int64Vec, 2);
+
+	unsigned int blockSizes[] = { 1024, 4096, 262144, 1048576 };
+	int levels[] = { 0, 40, 100 };
+
+	for (unsigned int blockSize : blockSizes)
+	{
+		for (int level : levels)
+		{
+			ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, level, FstColumnWriteOptions(FstColumnCodec::DEFAULT, -1, blockSize));
+		}
+
+		ReadWriteTester::WriteReadSingleColumns(fstTable, filePath, 50, FstColumnWriteOptions(FstColumnCodec::LZ4, 50, blockSize));
+	}
+
+	// range spanning partial first and last blocks and several full blocks
+	FstStore fstStore(filePath);
+	fstStore.fstWrite(fstTable, 80, std::vector<FstColumnWriteOptions>(3, FstColumnWriteOptions(FstColumnCodec::DEFAULT, -1, 262144)));
+
+	// an odd start row puts the integer blocks at a misaligned output position
+	for (int fromRow : { 1001, 1002 })
+	{
+		FstTable tableRead;
+		ColumnFactory columnFactory;
+		std::vector<int> keyIndex;
+		StringArray selectedCols;
+		std::unique_ptr<StringColumn> col_names(new StringColumn());
+		fstStore.fstRead(tableRead, nullptr, fromRow, 250000, &columnFactory, keyIndex, &selectedCols, &*col_names);
+
+		std::shared_ptr<DestructableObject> column;
+		FstColumnType type;
+		std::string colName;
+		std::string annotation;
+		short int scale;
+		int nrOfRead = 250001 - fromRow;
+
+		tableRead.GetColumn(0, column, type, colName, scale, annotation);
+		EXPECT_EQ(std::memcmp(static_cast<IntVector*>(&(*column))->Data(), &intP[fromRow - 1], 4 * nrOfRead), 0);
+
+		tableRead.GetColumn(1, column, type, colName, scale, annotation);
+		EXPECT_EQ(std::memcmp(static_cast<DoubleVector*>(&(*column))->Data(), &doubleP[fromRow - 1], 8 * nrOfRead), 0);
+
+		tableRead.GetColumn(2, column, type, colName, scale, annotation);
+		EXPECT_EQ(std::memcmp(static_cast<LongVector*>(&(*column))->Data(), &int64P[fromRow - 1], 8 * nrOfRead), 0);
+	}
+}
+
+
+TEST_F(WriteOptionsTest, LargeBlockRatio)
+{
+	int nrOfRows = 600000;
+	FstTable fstTable(nrOfRows);
+	fstTable.InitTable(1, nrOfRows);
+
+	vector<std::string> colNames{ "Integer" };
+	fstTable.SetColumnNames(colNames);
+
+	// random pattern that repeats at a larger distance than the default block size
+	std::mt19937 rng(5678);
+	IntVectorAdapter intVec(nrOfRows, FstColumnAttribute::INT_32_BASE, 0);
+	int* intP = intVec.Data();
+	for (int pos = 0; pos < 10000; ++pos) intP[pos] = static_cast<int>(rng());
+	for (int pos = 10000; pos < nrOfRows; ++pos) intP[pos] = intP[pos - 10000];
+	fstTable.SetIntegerColumn(&intVec, 0);
+
+	FstStore fstStore(filePath);
+
+	fstStore.fstWrite(fstTable, 0, std::vector<FstColumnWriteOptions>(1, FstColumnWriteOptions(FstColumnCodec::ZSTD, 50, 4096)));
+	long long smallBlockSize = FileSize();
+
+	fstStore.fstWrite(fstTable, 0, std::vector<FstColumnWriteOptions>(1, FstColumnWriteOptions(FstColumnCodec::ZSTD, 50, 1048576)));
+	long long largeBlockSize = FileSize();
+
+	EXPECT_LT(4 * largeBlockSize, smallBlockSize);
+}